@@ -113,7 +113,9 @@ extern volatile BOOL comms_main_mcu_fido_blectrl_rng_msg_answered_using_first_by
 #define AUX_MCU_FIDO2_GA_REQ         0x0005
 #define AUX_MCU_FIDO2_GA_RSP         0x0006
 #define AUX_MCU_FIDO2_RETRY          0x0007
-#define AUX_MCU_MSG_TYPE_FIDO2_END   AUX_MCU_FIDO2_RETRY
+//EXCL LIST = EXCLUDE LIST, BATCHED AUTH CRED REQ answered by AUTH CRED RSP
+#define AUX_MCU_FIDO2_EXCL_LIST_REQ  0x0008
+#define AUX_MCU_MSG_TYPE_FIDO2_END   AUX_MCU_FIDO2_EXCL_LIST_REQ
 /* FIDO2 messages end */
 
 /*
@@ -243,6 +245,12 @@ typedef struct fido2_allow_list_s
     uint8_t tag[FIDO2_ALLOW_LIST_MAX_SIZE][FIDO2_CREDENTIAL_ID_LENGTH]; //160 bytes
 } fido2_allow_list_t;
 
+typedef struct fido2_excl_list_req_message_s
+{
+    uint8_t rpID[FIDO2_RPID_LEN];
+    fido2_allow_list_t excl_list;
+} fido2_excl_list_req_message_t;
+
 typedef struct fido2_make_credential_req_message_s
 {
     uint8_t rpID[FIDO2_RPID_LEN];
@@ -299,6 +307,7 @@ typedef struct fido2_message_s
     {
         fido2_auth_cred_req_message_t fido2_auth_cred_req_message;
         fido2_auth_cred_rsp_message_t fido2_auth_cred_rsp_message;
+        fido2_excl_list_req_message_t fido2_excl_list_req_message;
         fido2_make_credential_req_message_t fido2_make_credential_req_message;
         fido2_make_credential_rsp_message_t fido2_make_credential_rsp_message;
         fido2_get_assertion_req_message_t fido2_get_assertion_req_message;
@@ -30,7 +30,19 @@ uint16_t comms_raw_hid_total_expected_packets[NB_HID_INTERFACES];
 uint16_t comms_raw_hid_temp_mcu_message_fill_index[NB_HID_INTERFACES] = {0,0,0};
 /* Expected flip bit state */
 BOOL comms_raw_hid_expect_flip_bit_state_set[NB_HID_INTERFACES] = {FALSE, FALSE, FALSE};
-/* Set when we received/send a USB message */
+/* Queues of packets to be sent, one after the other in a common buffer: first slot & number of slots for each interface */
+static hid_packet_t raw_hid_send_queue[RAW_HID_USB_TX_QUEUE_DEPTH + RAW_HID_BLE_TX_QUEUE_DEPTH + RAW_HID_CTAP_TX_QUEUE_DEPTH];
+uint16_t comms_raw_hid_send_queue_sizes[RAW_HID_USB_TX_QUEUE_DEPTH + RAW_HID_BLE_TX_QUEUE_DEPTH + RAW_HID_CTAP_TX_QUEUE_DEPTH];
+const uint16_t comms_raw_hid_send_queue_first_slot[NB_HID_INTERFACES] = {0, RAW_HID_USB_TX_QUEUE_DEPTH, RAW_HID_USB_TX_QUEUE_DEPTH + RAW_HID_BLE_TX_QUEUE_DEPTH};
+const uint16_t comms_raw_hid_send_queue_depth[NB_HID_INTERFACES] = {RAW_HID_USB_TX_QUEUE_DEPTH, RAW_HID_BLE_TX_QUEUE_DEPTH, RAW_HID_CTAP_TX_QUEUE_DEPTH};
+/* Slot of the oldest packet, slot at which to queue, number of queued packets */
+volatile uint16_t comms_raw_hid_send_queue_read_index[NB_HID_INTERFACES] = {0, RAW_HID_USB_TX_QUEUE_DEPTH, RAW_HID_USB_TX_QUEUE_DEPTH + RAW_HID_BLE_TX_QUEUE_DEPTH};
+uint16_t comms_raw_hid_send_queue_write_index[NB_HID_INTERFACES] = {0, RAW_HID_USB_TX_QUEUE_DEPTH, RAW_HID_USB_TX_QUEUE_DEPTH + RAW_HID_BLE_TX_QUEUE_DEPTH};
+volatile uint16_t comms_raw_hid_send_queue_nb_packets[NB_HID_INTERFACES] = {0, 0, 0};
+/* Incremented when a queue is cleared, and generation the packet being sent was queued in */
+volatile uint16_t comms_raw_hid_send_queue_generation[NB_HID_INTERFACES] = {0, 0, 0};
+volatile uint16_t comms_raw_hid_packet_being_sent_generation[NB_HID_INTERFACES] = {0, 0, 0};
+/* Set when the oldest queued packet is being sent / when we received a USB message */
 volatile BOOL comms_raw_hid_packet_being_sent[NB_HID_INTERFACES] = {FALSE, FALSE, FALSE};
 volatile BOOL comms_raw_hid_packet_received[NB_HID_INTERFACES] = {FALSE, FALSE, FALSE};
 volatile BOOL comms_raw_hid_packet_receive_length[NB_HID_INTERFACES] = {0, 0, 0};
@@ -151,14 +163,114 @@ void comms_raw_hid_recv_callback(hid_interface_te hid_interface, uint16_t recv_b
     comms_raw_hid_packet_received[hid_interface] = TRUE;
 }
 
+/*! \fn     comms_raw_hid_get_next_queue_slot(hid_interface_te hid_interface, uint16_t slot)
+*   \brief  Get the slot following a given one in an interface send queue
+*   \param  hid_interface   HID interface
+*   \param  slot            Current slot
+*   \return The next slot, wrapping around to the first slot of the interface
+*/
+static uint16_t comms_raw_hid_get_next_queue_slot(hid_interface_te hid_interface, uint16_t slot)
+{
+    if (++slot == comms_raw_hid_send_queue_first_slot[hid_interface] + comms_raw_hid_send_queue_depth[hid_interface])
+    {
+        slot = comms_raw_hid_send_queue_first_slot[hid_interface];
+    }
+    return slot;
+}
+
+/*! \fn     comms_raw_hid_send_next_queued_packet(hid_interface_te hid_interface)
+*   \brief  Start sending the oldest queued packet if the interface is idle
+*   \param  hid_interface   HID interface on which to send the packet
+*   \note   Also called from the USB interrupt for USB & CTAP, from the BLE event task for BLE
+*/
+static void comms_raw_hid_send_next_queued_packet(hid_interface_te hid_interface)
+{
+    if (hid_interface == BLE_INTERFACE)
+    {
+        /* Notifications are sent from the BLE event task context only: no need for a critical section */
+        if ((comms_raw_hid_send_queue_nb_packets[hid_interface] != 0) && (comms_raw_hid_packet_being_sent[hid_interface] == FALSE))
+        {
+            uint16_t read_index = comms_raw_hid_send_queue_read_index[hid_interface];
+            comms_raw_hid_packet_being_sent[hid_interface] = TRUE;
+            comms_raw_hid_packet_being_sent_generation[hid_interface] = comms_raw_hid_send_queue_generation[hid_interface];
+            
+            /* Packet is copied by the function below, may call our send callback straight away if not connected */
+            logic_bluetooth_raw_send((uint8_t*)&raw_hid_send_queue[read_index], comms_raw_hid_send_queue_sizes[read_index]);
+        }
+    }
+    else
+    {
+        cpu_irq_enter_critical();
+        if ((comms_raw_hid_send_queue_nb_packets[hid_interface] != 0) && (comms_raw_hid_packet_being_sent[hid_interface] == FALSE))
+        {
+            uint16_t read_index = comms_raw_hid_send_queue_read_index[hid_interface];
+            comms_raw_hid_packet_being_sent[hid_interface] = TRUE;
+            comms_raw_hid_packet_being_sent_generation[hid_interface] = comms_raw_hid_send_queue_generation[hid_interface];
+            
+            /* Endpoint reads the packet from our queue */
+            if (hid_interface == USB_INTERFACE)
+            {
+                usb_send(USB_RAWHID_RX_ENDPOINT, (uint8_t*)&raw_hid_send_queue[read_index], comms_raw_hid_send_queue_sizes[read_index]);
+            }
+            else
+            {
+                //comms_usb_debug_printf("Send CTAP response: IF: %d size: %d\n", CTAP_INTERFACE, comms_raw_hid_send_queue_sizes[read_index]);
+                usb_send(USB_CTAP_RX_ENDPOINT, (uint8_t*)&raw_hid_send_queue[read_index], comms_raw_hid_send_queue_sizes[read_index]);
+            }
+        }
+        cpu_irq_leave_critical();
+    }
+}
+
+/*! \fn     comms_raw_hid_clear_send_queue(hid_interface_te hid_interface)
+*   \brief  Drop all packets queued for sending on a given interface
+*   \param  hid_interface   HID interface
+*   \note   A USB transfer still in progress keeps the endpoint and its slot: its completion belongs to the previous generation and won't remove a newer packet
+*/
+void comms_raw_hid_clear_send_queue(hid_interface_te hid_interface)
+{
+    cpu_irq_enter_critical();
+    
+    /* Notifications pending on a lost BLE connection never complete */
+    if (hid_interface == BLE_INTERFACE)
+    {
+        comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
+    }
+    
+    /* Restart after the slot still read by the endpoint, if any */
+    if (comms_raw_hid_packet_being_sent[hid_interface] != FALSE)
+    {
+        comms_raw_hid_send_queue_read_index[hid_interface] = comms_raw_hid_get_next_queue_slot(hid_interface, comms_raw_hid_send_queue_read_index[hid_interface]);
+    }
+    else
+    {
+        comms_raw_hid_send_queue_read_index[hid_interface] = comms_raw_hid_send_queue_first_slot[hid_interface];
+    }
+    comms_raw_hid_send_queue_write_index[hid_interface] = comms_raw_hid_send_queue_read_index[hid_interface];
+    comms_raw_hid_send_queue_nb_packets[hid_interface] = 0;
+    comms_raw_hid_send_queue_generation[hid_interface]++;
+    cpu_irq_leave_critical();
+}
+
 /*! \fn     comms_raw_hid_send_callback(hid_interface_te hid_interface)
 *   \brief  Function called when a HID packet is sent
 *   \param  hid_interface   interface from which we received the packet
+*   \note   Feeds the interface with the next queued packet
 */
 void comms_raw_hid_send_callback(hid_interface_te hid_interface)
 {
+    /* Remove the sent packet from our queue, unless it was sent before the queue got cleared */
+    if ((comms_raw_hid_packet_being_sent[hid_interface] != FALSE) && (comms_raw_hid_packet_being_sent_generation[hid_interface] == comms_raw_hid_send_queue_generation[hid_interface]) && (comms_raw_hid_send_queue_nb_packets[hid_interface] != 0))
+    {
+        comms_raw_hid_send_queue_read_index[hid_interface] = comms_raw_hid_get_next_queue_slot(hid_interface, comms_raw_hid_send_queue_read_index[hid_interface]);
+        comms_raw_hid_send_queue_nb_packets[hid_interface]--;
+    }
+    
     /* Set flag */
     comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
+    
+    /* Send the next one */
+    comms_raw_hid_send_next_queued_packet(hid_interface);
 }
 
 /*! \fn     comms_raw_hid_arm_packet_receive(hid_interface_te hid_interface)
@@ -179,27 +291,38 @@ void comms_raw_hid_arm_packet_receive(hid_interface_te hid_interface)
     }
 }
 
-/*! \fn     comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* packet, BOOL wait_send, uint16_t payload_size)
-*   \brief  send raw hid packet
-*   \param  hid_interface   HID interface on which to send the packet
-*   \param  packet          Packet to send (must be 4 bytes aligned!)
-*   \param  wait_send       Set to wait for end of packet transmission
-*   \param  payload_size    Payload size
+/*! \fn     comms_raw_hid_wait_for_send_queue(hid_interface_te hid_interface, uint16_t max_nb_queued_packets)
+*   \brief  Wait for the number of packets queued on a given interface to go down to a given value
+*   \param  hid_interface           HID interface
+*   \param  max_nb_queued_packets   Number of queued packets we want to wait for
+*   \return RETURN_OK or RETURN_NOK if the interface stopped taking packets, in which case the queue is cleared
+*   \note   Timeouts are restarted each time a packet is sent
 */
-void comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* packet, BOOL wait_send, uint16_t payload_size)
+static RET_TYPE comms_raw_hid_wait_for_send_queue(hid_interface_te hid_interface, uint16_t max_nb_queued_packets)
 {
-    /* Wait for possible previous packet to be sent */
-    if (hid_interface == USB_INTERFACE)
-    {
-        timer_start_timer(TIMER_USB_SEND_TIMEOUT, 500);
-    }
-    else if (hid_interface == CTAP_INTERFACE)
-    {
-        timer_start_timer(TIMER_USB_SEND_TIMEOUT, 100);
-    }
-    timer_start_timer(TIMER_BT_TYPING_TIMEOUT, 3000);
-    while(comms_raw_hid_packet_being_sent[hid_interface] == TRUE)
+    uint16_t nb_queued_packets = UINT16_MAX;
+    
+    while (comms_raw_hid_send_queue_nb_packets[hid_interface] > max_nb_queued_packets)
     {
+        /* Progress made? restart timeouts */
+        if (comms_raw_hid_send_queue_nb_packets[hid_interface] != nb_queued_packets)
+        {
+            nb_queued_packets = comms_raw_hid_send_queue_nb_packets[hid_interface];
+            if (hid_interface == USB_INTERFACE)
+            {
+                timer_start_timer(TIMER_USB_SEND_TIMEOUT, 500);
+            }
+            else if (hid_interface == CTAP_INTERFACE)
+            {
+                timer_start_timer(TIMER_USB_SEND_TIMEOUT, 100);
+            }
+            else
+            {
+                timer_start_timer(TIMER_BT_TYPING_TIMEOUT, 3000);
+            }
+        }
+        
+        /* Bluetooth busy sending previous packets... */
         if (hid_interface == BLE_INTERFACE)
         {
             ble_event_task();
@@ -208,26 +331,41 @@ void comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* pac
         /* Check for BLE timeout */
         if ((hid_interface == BLE_INTERFACE) && (timer_has_timer_expired(TIMER_BT_TYPING_TIMEOUT, FALSE) == TIMER_EXPIRED))
         {
-            comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
-            return;
+            comms_raw_hid_clear_send_queue(hid_interface);
+            return RETURN_NOK;
         }
         
         /* Check for usb disconnection, or in some cases a timeout due to the computer not wanting to read the OUT endpoint (wtf...) */
         if (((hid_interface == USB_INTERFACE) || (hid_interface == CTAP_INTERFACE)) && ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100) || (timer_has_timer_expired(TIMER_USB_SEND_TIMEOUT, TRUE) == TIMER_EXPIRED)))
         {
-            comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
-            return;
+            comms_raw_hid_clear_send_queue(hid_interface);
+            return RETURN_NOK;
         }
     }
     
-    /* Wait for possible unrelated notification to be sent */
-    if (hid_interface == BLE_INTERFACE)
+    return RETURN_OK;
+}
+
+/*! \fn     comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* packet, BOOL wait_send, uint16_t payload_size)
+*   \brief  Queue raw hid packet for sending
+*   \param  hid_interface   HID interface on which to send the packet
+*   \param  packet          Packet to send, copied in our queue
+*   \param  wait_send       Set to wait for end of transmission of all queued packets
+*   \param  payload_size    Payload size
+*   \note   Only waits when the queue is full, packets are then sent from the interface send callback
+*/
+void comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* packet, BOOL wait_send, uint16_t payload_size)
+{
+    /* Wait for a free slot in our queue, one less if the endpoint still reads a packet dropped by a queue clear */
+    uint16_t max_nb_queued_packets = comms_raw_hid_send_queue_depth[hid_interface]-1;
+    if ((comms_raw_hid_packet_being_sent[hid_interface] != FALSE) && (comms_raw_hid_packet_being_sent_generation[hid_interface] != comms_raw_hid_send_queue_generation[hid_interface]))
     {
-        logic_bluetooth_check_and_wait_for_notif_sent();
+        max_nb_queued_packets--;
+    }
+    if (comms_raw_hid_wait_for_send_queue(hid_interface, max_nb_queued_packets) != RETURN_OK)
+    {
+        return;
     }
-    
-    /* Reset flag */
-    comms_raw_hid_packet_being_sent[hid_interface] = TRUE;
     
     /* Check payload size parameter */
     if (payload_size > sizeof(hid_packet_t))
@@ -235,62 +373,30 @@ void comms_raw_hid_send_packet(hid_interface_te hid_interface, hid_packet_t* pac
         payload_size = sizeof(hid_packet_t);
     }
     
-    /* Send packet */
-    if (hid_interface == USB_INTERFACE)
-    {
-        usb_send(USB_RAWHID_RX_ENDPOINT, (uint8_t*)packet, payload_size);
-    }
-    else if (hid_interface == CTAP_INTERFACE)
-    {
-        //comms_usb_debug_printf("Send CTAP response: IF: %d size: %d\n", CTAP_INTERFACE, payload_size);
-        usb_send(USB_CTAP_RX_ENDPOINT, (uint8_t*)packet, payload_size);
-    }
-    else
-    {
-        logic_bluetooth_raw_send((uint8_t*)packet, payload_size);
-    }
+    /* Copy packet at the end of our queue: the slot isn't accessed by the send callback until counted in */
+    uint16_t write_index = comms_raw_hid_send_queue_write_index[hid_interface];
+    memcpy((void*)&raw_hid_send_queue[write_index], (void*)packet, payload_size);
+    comms_raw_hid_send_queue_sizes[write_index] = payload_size;
+    comms_raw_hid_send_queue_write_index[hid_interface] = comms_raw_hid_get_next_queue_slot(hid_interface, write_index);
+    cpu_irq_enter_critical();
+    comms_raw_hid_send_queue_nb_packets[hid_interface]++;
+    cpu_irq_leave_critical();
+    
+    /* Start sending if the interface is idle */
+    comms_raw_hid_send_next_queued_packet(hid_interface);
     
     /* If asked, wait */
     if (wait_send != FALSE)
     {
-        if (hid_interface == USB_INTERFACE)
-        {
-            timer_start_timer(TIMER_USB_SEND_TIMEOUT, 500);
-        }
-        else if (hid_interface == CTAP_INTERFACE)
-        {
-            timer_start_timer(TIMER_USB_SEND_TIMEOUT, 100);
-        }        
-        timer_start_timer(TIMER_BT_TYPING_TIMEOUT, 3000);    
-            
-        while(comms_raw_hid_packet_being_sent[hid_interface] == TRUE)
-        {
-            if (hid_interface == BLE_INTERFACE)
-            {
-                ble_event_task();
-            }
-            
-            /* Check for BLE timeout */
-            if ((hid_interface == BLE_INTERFACE) && (timer_has_timer_expired(TIMER_BT_TYPING_TIMEOUT, FALSE) == TIMER_EXPIRED))
-            {
-                comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
-                return;
-            }
-            
-            /* Check for usb disconnection, or in some cases a timeout due to the computer not wanting to read the OUT endpoint (wtf...) */
-            if (((hid_interface == USB_INTERFACE) || (hid_interface == CTAP_INTERFACE)) && ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100) || (timer_has_timer_expired(TIMER_USB_SEND_TIMEOUT, TRUE) == TIMER_EXPIRED)))
-            {
-                comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
-                return;
-            }
-        }
-    }    
+        comms_raw_hid_wait_for_send_queue(hid_interface, 0);
+    }
 }
 
 /*! \fn     comms_raw_hid_send_hid_message(hid_interface_te hid_interface, aux_mcu_message_t* message)
 *   \brief  send HID message to PC
 *   \param  hid_interface   interface from which we received the packet
 *   \param  message     Message to send
+*   \note   Packets are queued, the function only waits if the interface queue is full
 */
 void comms_raw_hid_send_hid_message(hid_interface_te hid_interface, aux_mcu_message_t* message)
 {
@@ -302,25 +408,7 @@ void comms_raw_hid_send_hid_message(hid_interface_te hid_interface, aux_mcu_mess
     /* Generate and send packets */
     while(remaining_payload_to_send > 0)
     {
-        timer_start_timer(TIMER_USB_SEND_TIMEOUT, 1000);
-        /* Wait for a possible previous packet to be sent as we do buffer re-use */
-        while(comms_raw_hid_packet_being_sent[hid_interface] == TRUE)
-        {
-            /* Bluetooth busy sending previous packet... */
-            if (hid_interface == BLE_INTERFACE)
-            {
-                ble_event_task();
-            }
-            
-            /* Check for usb disconnection, or in some cases a timeout due to the computer not wanting to read the OUT endpoint (wtf...) */
-            if (((hid_interface == USB_INTERFACE) || (hid_interface == CTAP_INTERFACE)) && ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100) || (timer_has_timer_expired(TIMER_USB_SEND_TIMEOUT, TRUE) == TIMER_EXPIRED)))
-            {
-                comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
-                return;
-            }
-        }
-        
-        /* Generate packet */
+        /* Generate packet: buffer can be re-used as packets are copied in our send queue */
         memset((void*)&raw_hid_send_buffer[hid_interface], 0, sizeof(raw_hid_send_buffer[0]));
         raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte1.total_packets = total_number_of_packets;
         raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte1.packet_id = packet_id;
@@ -350,9 +438,9 @@ void comms_raw_hid_send_hid_message(hid_interface_te hid_interface, aux_mcu_mess
         payload_offset += raw_hid_send_buffer[hid_interface].mtc_hid_packet.byte0.payload_len;
         packet_id += 1;
         
-        /* Send packet: always send 64B due to some strange windows receive trigger thingy */
+        /* Queue packet: always send 64B due to some strange windows receive trigger thingy */
         //comms_raw_hid_send_packet(&raw_hid_send_buffer, TRUE, sizeof(raw_hid_send_buffer.byte0) + sizeof(raw_hid_send_buffer.byte1) + raw_hid_send_buffer.byte0.payload_len);
-        comms_raw_hid_send_packet(hid_interface, &raw_hid_send_buffer[hid_interface], TRUE, USB_RAWHID_RX_SIZE);
+        comms_raw_hid_send_packet(hid_interface, &raw_hid_send_buffer[hid_interface], FALSE, USB_RAWHID_RX_SIZE);
     }
 }
 
@@ -395,7 +483,17 @@ void comms_raw_hid_connection_set_callback(hid_interface_te hid_interface)
     comms_raw_hid_expect_flip_bit_state_set[hid_interface] = FALSE;
     comms_raw_hid_temp_mcu_message_fill_index[hid_interface] = 0;
     comms_raw_hid_expected_packet_number[hid_interface] = 0;
+    comms_raw_hid_clear_send_queue(hid_interface);
+    
+    /* Endpoints were just configured: no transfer in progress */
     comms_raw_hid_packet_being_sent[hid_interface] = FALSE;
+    
+    /* CTAP interface is set together with our USB interface */
+    if (hid_interface == USB_INTERFACE)
+    {
+        comms_raw_hid_clear_send_queue(CTAP_INTERFACE);
+        comms_raw_hid_packet_being_sent[CTAP_INTERFACE] = FALSE;
+    }
 } 
 
 /*! \fn     comms_usb_communication_routine(void)
@@ -491,7 +589,7 @@ comms_usb_ret_te comms_usb_communication_routine(void)
                 
                 /* Inform host of the mistake: reuse the same buffer as status update as the computer will need to restart comms anyway */
                 memset(comms_raw_hid_shorter_aux_mcu_message_for_status_update, 0xFF, sizeof(comms_raw_hid_shorter_aux_mcu_message_for_status_update));
-                comms_raw_hid_send_packet(hid_interface, (hid_packet_t*)comms_raw_hid_shorter_aux_mcu_message_for_status_update, TRUE, USB_RAWHID_RX_SIZE);
+                comms_raw_hid_send_packet(hid_interface, (hid_packet_t*)comms_raw_hid_shorter_aux_mcu_message_for_status_update, FALSE, USB_RAWHID_RX_SIZE);
                 return ret_val;
             }
             
@@ -550,7 +648,7 @@ comms_usb_ret_te comms_usb_communication_routine(void)
                 {
                     /* Send the same message */
                     memcpy((void*)&raw_hid_send_buffer[hid_interface], (void*)&raw_hid_recv_buffer[hid_interface], sizeof(raw_hid_send_buffer[0]));
-                    comms_raw_hid_send_packet(hid_interface, &raw_hid_send_buffer[hid_interface], TRUE, comms_raw_hid_packet_receive_length[hid_interface]);
+                    comms_raw_hid_send_packet(hid_interface, &raw_hid_send_buffer[hid_interface], FALSE, comms_raw_hid_packet_receive_length[hid_interface]);
                 }
                 
                 /* Prepare and send message to main MCU */
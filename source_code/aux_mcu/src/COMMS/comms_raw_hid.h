@@ -49,6 +49,7 @@ uint8_t* comms_raw_hid_get_recv_buffer(hid_interface_te hid_interface);
 void comms_raw_hid_arm_packet_receive(hid_interface_te hid_interface);
 void comms_raw_hid_set_idle_config(uint8_t interface, uint8_t val);
 void comms_raw_hid_set_protocol(uint8_t interface, uint8_t val);
+void comms_raw_hid_clear_send_queue(hid_interface_te hid_interface);
 void comms_raw_hid_send_callback(hid_interface_te hid_interface);
 void comms_raw_hid_update_device_status_cache(uint8_t* buffer);
 uint8_t* comms_raw_hid_get_idle_config(uint8_t interface);
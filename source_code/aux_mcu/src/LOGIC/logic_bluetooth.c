@@ -258,8 +258,8 @@ static at_ble_status_t logic_bluetooth_hid_disconnected_callback(void *params)
 {
     DBG_LOG("Disconnected from device");
     
-    /* Callback in case we're waiting for a packet send */
-    comms_raw_hid_send_callback(BLE_INTERFACE);
+    /* Drop packets waiting to be sent */
+    comms_raw_hid_clear_send_queue(BLE_INTERFACE);
 
     /* From battery service */
     logic_bluetooth_battery_notification_flag = TRUE;
@@ -439,15 +439,19 @@ static at_ble_status_t logic_bluetooth_notification_confirmed_callback(void* par
         DBG_LOG("ERROR: failed sending notification to peer");
     }
     
-    if ((logic_bluetooth_notif_being_sent == RAW_HID_NOTIF_SENDING) || (logic_bluetooth_notif_being_sent == CUSTOM_COMMS_NOTIF_SENDING))
+    /* Reset flag before the raw hid callback as it may send the next notification */
+    notif_sending_te notif_sent = logic_bluetooth_notif_being_sent;
+    logic_bluetooth_notif_being_sent = NONE_NOTIF_SENDING;
+    
+    if ((notif_sent == RAW_HID_NOTIF_SENDING) || (notif_sent == CUSTOM_COMMS_NOTIF_SENDING))
     {
         comms_raw_hid_send_callback(BLE_INTERFACE);
     }
-    else if (logic_bluetooth_notif_being_sent == KEYBOARD_NOTIF_SENDING)
+    else if (notif_sent == KEYBOARD_NOTIF_SENDING)
     {
         logic_bluetooth_typed_report_sent = TRUE;
     }
-    else if (logic_bluetooth_notif_being_sent == BATTERY_NOTIF_SENDING)
+    else if (notif_sent == BATTERY_NOTIF_SENDING)
     {
         /* From battery service */
         if(notification_status->status == AT_BLE_SUCCESS)
@@ -455,9 +459,6 @@ static at_ble_status_t logic_bluetooth_notification_confirmed_callback(void* par
             logic_bluetooth_battery_notification_flag = TRUE;
         }
     }
-    
-    /* Reset flag */
-    logic_bluetooth_notif_being_sent = NONE_NOTIF_SENDING;
 
     return AT_BLE_SUCCESS;
 }
@@ -2019,6 +2020,43 @@ ret_type_te logic_bluetooth_send_modifier_and_key(uint8_t modifier, uint8_t key,
     }
 }
 
+/*! \fn     logic_bluetooth_send_keyboard_report(uint8_t* report)
+*   \brief  Send a full keyboard report (modifier, reserved, 6 keys) through keyboard link
+*   \param  report      8 bytes report
+*   \return If the report notification was sent
+*/
+ret_type_te logic_bluetooth_send_keyboard_report(uint8_t* report)
+{
+    if (logic_bluetooth_can_communicate_with_host == FALSE)
+    {
+        return RETURN_NOK;
+    }
+    
+    logic_bluetooth_check_and_wait_for_notif_sent();
+    logic_bluetooth_notif_being_sent = KEYBOARD_NOTIF_SENDING;
+    memcpy(logic_bluetooth_keyboard_in_report, report, sizeof(logic_bluetooth_keyboard_in_report));
+    logic_bluetooth_typed_report_sent = FALSE;
+    logic_bluetooth_update_report(logic_bluetooth_ble_connection_handle, BLE_KEYBOARD_HID_SERVICE_INSTANCE, BLE_KEYBOARD_HID_IN_REPORT_NB, logic_bluetooth_keyboard_in_report, sizeof(logic_bluetooth_keyboard_in_report), TRUE);
+    
+    /* Wait for the notification to be sent, see logic_bluetooth_send_modifier_and_key */
+    timer_start_timer(TIMER_BT_TYPING_TIMEOUT, 1000);
+    while ((timer_has_timer_expired(TIMER_BT_TYPING_TIMEOUT, FALSE) == TIMER_RUNNING) && (logic_bluetooth_typed_report_sent == FALSE))
+    {
+        ble_event_task();
+    }
+    
+    /* Report sent? */
+    if (logic_bluetooth_typed_report_sent == FALSE)
+    {
+        DBG_LOG("Couldn't send keyboard report as notification in time!");
+        return RETURN_NOK;
+    }
+    else
+    {
+        return RETURN_OK;
+    }
+}
+
 /*! \fn     logic_bluetooth_routine(void)
 *   \brief  Our bluetooth routine
 */
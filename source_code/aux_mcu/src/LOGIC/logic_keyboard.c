@@ -117,6 +117,46 @@ ret_type_te logic_keyboard_type_key_with_modifier(hid_interface_te interface, ui
     return RETURN_OK; 
 }
 
+/*! \fn     logic_keyboard_get_key_and_modifier_for_symbol(uint8_t symbol, uint8_t* key, uint8_t* modifier)
+*   \brief  Get the HID key and modifier for an encoded symbol
+*   \param  symbol      The symbol
+*   \param  key         Where to store the HID key
+*   \param  modifier    Where to store the HID modifier
+*/
+static void logic_keyboard_get_key_and_modifier_for_symbol(uint8_t symbol, uint8_t* key, uint8_t* modifier)
+{
+    uint8_t masked_key = symbol & (SHIFT_MASK|ALTGR_MASK);
+    
+    if (masked_key == (SHIFT_MASK|ALTGR_MASK))
+    {
+        *modifier = KEY_SHIFT|KEY_RIGHT_ALT;
+    }
+    else if (masked_key == SHIFT_MASK)
+    {
+        // If we need shift
+        *modifier = KEY_SHIFT;
+    }
+    else if (masked_key == ALTGR_MASK)
+    {
+        // We need altgr for the numbered keys, only possible because we don't use the numerical keypad
+        *modifier = KEY_RIGHT_ALT;
+    }
+    else
+    {
+        *modifier = 0;
+    }
+    
+    if ((symbol & 0x3F) == KEY_EUROPE_2)
+    {
+        // Because of a redefine of KEY_EUROPE_2 for storage purposes we need to do that
+        *key = KEY_EUROPE_2_REAL;
+    }
+    else
+    {
+        *key = symbol & ~(SHIFT_MASK|ALTGR_MASK);
+    }
+}
+
 /*! \fn     logic_keyboard_type_symbol(hid_interface_te interface, uint8_t symbol, BOOL is_dead_key, uint16_t delay_between_types)
 *   \brief  Type an encoded symbol through a given interface
 *   \param  interface           HID interface on which to type the symbol
@@ -127,54 +167,204 @@ ret_type_te logic_keyboard_type_key_with_modifier(hid_interface_te interface, ui
 */
 ret_type_te logic_keyboard_type_symbol(hid_interface_te interface, uint8_t symbol, BOOL is_dead_key, uint16_t delay_between_types)
 {
-    uint8_t masked_key = symbol & (SHIFT_MASK|ALTGR_MASK);
     ret_type_te return_val;
-        
-    if ((symbol & 0x3F) == KEY_EUROPE_2)
+    uint8_t modifier;
+    uint8_t key;
+    
+    logic_keyboard_get_key_and_modifier_for_symbol(symbol, &key, &modifier);
+    return_val = logic_keyboard_type_key_with_modifier(interface, key, modifier, delay_between_types);
+    
+    /* Add space if typed character is a dead key */
+    if ((is_dead_key != FALSE) && (return_val == RETURN_OK))
     {
-        // Because of a redefine of KEY_EUROPE_2 for storage purposes we need to do that
-        uint8_t mod_tbs = 0;
-            
-        if (masked_key == (SHIFT_MASK|ALTGR_MASK))
+        return_val = logic_keyboard_type_key_with_modifier(interface, KEY_SPACE, 0, delay_between_types);        
+    }
+    
+    return return_val;
+}
+
+/*! \fn     logic_keyboard_send_report(hid_interface_te interface, uint8_t* report, uint16_t delay_between_types)
+*   \brief  Send a keyboard report and wait for its transfer to complete
+*   \param  interface           HID interface on which to send the report
+*   \param  report              8 bytes keyboard report
+*   \param  delay_between_types Extra delay after the report was sent, for hosts that need it
+*   \return If the report was sent
+*/
+static ret_type_te logic_keyboard_send_report(hid_interface_te interface, uint8_t* report, uint16_t delay_between_types)
+{
+    if (interface == USB_INTERFACE)
+    {
+        /* Check for enumeration */
+        if ((usb_get_config() == 0) || (udc_get_nb_ms_before_last_usb_activity() > 100))
+        {
+            return RETURN_NOK;
+        }
+        
+        /* Our buffer is only reused once the host fetched the previous report */
+        memcpy(logic_keyboard_usb_hid_keys_buffer, report, sizeof(logic_keyboard_usb_hid_keys_buffer));
+        usb_send(USB_KEYBOARD_ENDPOINT, (uint8_t*)logic_keyboard_usb_hid_keys_buffer, sizeof(logic_keyboard_usb_hid_keys_buffer));
+        timer_start_timer(TIMER_USB_TYPING_TIMEOUT, 100);
+        while (udc_send_pending(USB_KEYBOARD_ENDPOINT) != false)
         {
-            mod_tbs = KEY_SHIFT|KEY_RIGHT_ALT;
+            if (timer_has_timer_expired(TIMER_USB_TYPING_TIMEOUT, FALSE) == TIMER_EXPIRED)
+            {
+                return RETURN_NOK;
+            }
         }
-        else if (masked_key == SHIFT_MASK)
+    }
+    else if (logic_bluetooth_send_keyboard_report(report) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    
+    if (delay_between_types != 0)
+    {
+        timer_delay_ms(delay_between_types);
+    }
+    
+    return RETURN_OK;
+}
+
+/*! \fn     logic_keyboard_press_key_in_report(hid_interface_te interface, uint8_t* report, uint8_t key, uint8_t modifier, BOOL isolated, uint16_t delay_between_types)
+*   \brief  Add a key press to the report stream being typed
+*   \param  interface           HID interface on which to type
+*   \param  report              Current keyboard report
+*   \param  key                 Key to press
+*   \param  modifier            Modifier for that key
+*   \param  isolated            Set to have the key pressed and released on its own (dead keys)
+*   \param  delay_between_types Delay between reports
+*   \return If we were able to send the reports
+*   \note   Keys are added one per report while previous keys are kept pressed, so the host sees a single new key per report and typing order is kept.
+*           Keys get released when the modifier changes, when a key repeats or when the 6 key slots are used.
+*           With a delay between reports every key is released before the next one, as keys held for several delays could trigger the host auto-repeat.
+*/
+static ret_type_te logic_keyboard_press_key_in_report(hid_interface_te interface, uint8_t* report, uint8_t key, uint8_t modifier, BOOL isolated, uint16_t delay_between_types)
+{
+    uint8_t* keys = &report[LOGIC_KEYBOARD_REPORT_KEYS_OFFSET];
+    uint16_t nb_keys = 0;
+    BOOL release_keys;
+    
+    /* Slow hosts: a key is only held for one delay, modifiers may stay held */
+    if (delay_between_types != 0)
+    {
+        isolated = TRUE;
+    }
+    release_keys = isolated;
+    
+    /* Count pressed keys, check if the key is already pressed */
+    while ((nb_keys < LOGIC_KEYBOARD_REPORT_NB_KEYS) && (keys[nb_keys] != 0))
+    {
+        if (keys[nb_keys] == key)
         {
-            mod_tbs = KEY_SHIFT;
+            release_keys = TRUE;
         }
-        else if (masked_key == ALTGR_MASK)
+        nb_keys++;
+    }
+    if ((nb_keys == LOGIC_KEYBOARD_REPORT_NB_KEYS) || (report[0] != modifier))
+    {
+        release_keys = TRUE;
+    }
+    
+    /* Release keys, keeping the modifier */
+    if ((release_keys != FALSE) && (nb_keys != 0))
+    {
+        memset(keys, 0, LOGIC_KEYBOARD_REPORT_NB_KEYS);
+        nb_keys = 0;
+        if (logic_keyboard_send_report(interface, report, delay_between_types) != RETURN_OK)
         {
-            mod_tbs = KEY_RIGHT_ALT;
+            return RETURN_NOK;
         }
-            
-        // Send the correct KEY_EUROPE_2 with the correct modifier
-        return_val = logic_keyboard_type_key_with_modifier(interface, KEY_EUROPE_2_REAL, mod_tbs, delay_between_types);
     }
-    else if (masked_key == (SHIFT_MASK|ALTGR_MASK))
+    
+    /* Modifier change is sent on its own */
+    if (report[0] != modifier)
     {
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol & ~(SHIFT_MASK|ALTGR_MASK), KEY_SHIFT|KEY_RIGHT_ALT, delay_between_types);
+        report[0] = modifier;
+        if (logic_keyboard_send_report(interface, report, delay_between_types) != RETURN_OK)
+        {
+            return RETURN_NOK;
+        }
     }
-    else if (masked_key == SHIFT_MASK)
+    
+    /* Press key */
+    keys[nb_keys] = key;
+    if (logic_keyboard_send_report(interface, report, delay_between_types) != RETURN_OK)
     {
-        // If we need shift
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol & ~SHIFT_MASK, KEY_SHIFT, delay_between_types);
+        return RETURN_NOK;
     }
-    else if (masked_key == ALTGR_MASK)
+    
+    /* Release it right away if needed */
+    if (isolated != FALSE)
     {
-        // We need altgr for the numbered keys, only possible because we don't use the numerical keypad
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol & ~ALTGR_MASK, KEY_RIGHT_ALT, delay_between_types);
+        keys[nb_keys] = 0;
+        return logic_keyboard_send_report(interface, report, delay_between_types);
     }
-    else
+    
+    return RETURN_OK;
+}
+
+/*! \fn     logic_keyboard_type_symbols(hid_interface_te interface, uint16_t* symbols, uint16_t max_nb_symbols, uint16_t delay_between_types)
+*   \brief  Type a string of encoded symbols as sent by the main MCU
+*   \param  interface           HID interface on which to type the symbols
+*   \param  symbols             0 terminated symbols array: 0xFFFF for a non typable symbol, bit 15 set for a dead key, or two symbols in one uint16_t
+*   \param  max_nb_symbols      Maximum number of symbols in the array
+*   \param  delay_between_types Delay between reports, 0 to pace by report completion only
+*   \return If we were able to type the symbols
+*/
+ret_type_te logic_keyboard_type_symbols(hid_interface_te interface, uint16_t* symbols, uint16_t max_nb_symbols, uint16_t delay_between_types)
+{
+    uint8_t report[LOGIC_KEYBOARD_REPORT_LENGTH];
+    ret_type_te return_val = RETURN_OK;
+    uint8_t modifier;
+    uint8_t key;
+    
+    /* Start from an all released report */
+    memset(report, 0, sizeof(report));
+    
+    for (uint16_t i = 0; (i < max_nb_symbols) && (symbols[i] != 0) && (return_val == RETURN_OK); i++)
     {
-        return_val = logic_keyboard_type_key_with_modifier(interface, symbol, 0, delay_between_types);
+        uint16_t symbol = symbols[i];
+        
+        if (symbol == 0xFFFF)
+        {
+            /* Original unicode point can't be typed */
+        }
+        else if ((symbol & 0x7F00) == 0)
+        {
+            /* One key to be typed, dead keys are followed by a space */
+            logic_keyboard_get_key_and_modifier_for_symbol((uint8_t)symbol, &key, &modifier);
+            if ((symbol & 0x8000) != 0)
+            {
+                return_val = logic_keyboard_press_key_in_report(interface, report, key, modifier, TRUE, delay_between_types);
+                if (return_val == RETURN_OK)
+                {
+                    return_val = logic_keyboard_press_key_in_report(interface, report, KEY_SPACE, 0, FALSE, delay_between_types);
+                }
+            }
+            else
+            {
+                return_val = logic_keyboard_press_key_in_report(interface, report, key, modifier, FALSE, delay_between_types);
+            }
+        }
+        else
+        {
+            /* Two keys to be typed: a dead key then the key it modifies */
+            logic_keyboard_get_key_and_modifier_for_symbol((uint8_t)(symbol >> 8), &key, &modifier);
+            return_val = logic_keyboard_press_key_in_report(interface, report, key, modifier, TRUE, delay_between_types);
+            if (return_val == RETURN_OK)
+            {
+                logic_keyboard_get_key_and_modifier_for_symbol((uint8_t)symbol, &key, &modifier);
+                return_val = logic_keyboard_press_key_in_report(interface, report, key, modifier, FALSE, delay_between_types);
+            }
+        }
     }
     
-    /* Add space if typed character is a dead key */
-    if ((is_dead_key != FALSE) && (return_val == RETURN_OK))
+    /* Release all */
+    if (return_val == RETURN_OK)
     {
-        return_val = logic_keyboard_type_key_with_modifier(interface, KEY_SPACE, 0, delay_between_types);        
+        memset(report, 0, sizeof(report));
+        return_val = logic_keyboard_send_report(interface, report, delay_between_types);
     }
     
     return return_val;
-}
\ No newline at end of file
+}
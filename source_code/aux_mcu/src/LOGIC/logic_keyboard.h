@@ -14,6 +14,9 @@
 /* Defines */
 #define SHIFT_MASK  0x80
 #define ALTGR_MASK  0x40
+#define LOGIC_KEYBOARD_REPORT_LENGTH        8
+#define LOGIC_KEYBOARD_REPORT_KEYS_OFFSET   2
+#define LOGIC_KEYBOARD_REPORT_NB_KEYS       6
 #define KEY_CTRL               0x01
 #define KEY_SHIFT              0x02
 #define KEY_EUROPE_2           0x03
@@ -134,6 +137,7 @@
 #define KEY_WIN_L              0xE3
 
 /* Prototypes */
+ret_type_te logic_keyboard_type_symbols(hid_interface_te interface, uint16_t* symbols, uint16_t max_nb_symbols, uint16_t delay_between_types);
 ret_type_te logic_keyboard_type_key_with_modifier(hid_interface_te interface, uint8_t key, uint8_t modifier, uint16_t delay_between_types);
 ret_type_te logic_keyboard_type_symbol(hid_interface_te interface, uint8_t symbol, BOOL is_dead_key, uint16_t delay_between_types);
 void logic_keyboard_type_lock_shortcut(hid_interface_te interface_id, uint8_t l_symbol);
@@ -309,6 +309,13 @@ void udc_send(int ep, uint8_t *data, int size)
   USB->DEVICE.DeviceEndpoint[ep].EPSTATUSSET.bit.BK1RDY = 1;
 }
 
+//-----------------------------------------------------------------------------
+bool udc_send_pending(int ep)
+{
+  // BK1RDY is cleared by the transfer complete interrupt
+  return (USB->DEVICE.DeviceEndpoint[ep].EPSTATUS.bit.BK1RDY != 0);
+}
+
 //-----------------------------------------------------------------------------
 void udc_recv(int ep, uint8_t *data, int size)
 {
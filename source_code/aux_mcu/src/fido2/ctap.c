@@ -528,6 +528,52 @@ int ctap_authenticate_credential(struct rpId * rp, CTAP_credentialDescriptor * d
     return rsp_msg->result;
 }
 
+// Return 1 if one of the credentials belongs to this token
+// MiniBLE:
+// Batched version of ctap_authenticate_credential, one main_mcu exchange for the whole list
+static int ctap_authenticate_credential_list(struct rpId * rp, fido2_allow_list_t * cred_list)
+{
+    aux_mcu_message_t* temp_rx_message_pt = comms_main_mcu_get_temp_rx_message_object_pt();
+    aux_mcu_message_t* temp_tx_message_pt;
+    fido2_excl_list_req_message_t* msg;
+    fido2_auth_cred_rsp_message_t* rsp_msg;
+    ret_type_te ret = RETURN_NOK;
+
+    /* Create message to authenticate a list of credentials */
+    comms_main_mcu_get_empty_packet_ready_to_be_sent(&temp_tx_message_pt, AUX_MCU_MSG_TYPE_FIDO2);
+
+    msg = &temp_tx_message_pt->fido2_message.fido2_excl_list_req_message;
+
+    /* Fill message */
+    memset(msg, 0, sizeof(*msg));
+    memcpy(msg->rpID, rp->id, FIDO2_RPID_LEN);
+    memcpy(&msg->excl_list, cred_list, sizeof(msg->excl_list));
+
+    /* Set length of message */
+    temp_tx_message_pt->payload_length1 = sizeof(fido2_message_t);
+
+    /* Set message subtype */
+    temp_tx_message_pt->fido2_message.message_type = AUX_MCU_FIDO2_EXCL_LIST_REQ;
+
+    /* Send packet */
+    comms_main_mcu_send_message((void*)temp_tx_message_pt, (uint16_t)sizeof(aux_mcu_message_t));
+
+    /* Wait for message from main MCU */
+    do
+    {
+        ctaphid_update_status(2);
+        timer_start_timer(TIMER_TIMEOUT_FUNCTS, 50);
+        while ((timer_has_timer_expired(TIMER_TIMEOUT_FUNCTS, TRUE) == TIMER_RUNNING) && (ret != RETURN_OK))
+        {
+            ret = comms_main_mcu_routine(TRUE, AUX_MCU_MSG_TYPE_FIDO2);
+        }
+    } while (ret != RETURN_OK);
+
+    /* Received message is in temporary buffer */
+    rsp_msg = &temp_rx_message_pt->fido2_message.fido2_auth_cred_rsp_message;
+    return rsp_msg->result;
+}
+
 /*
  * Delta from Solo implementation:
  * Signing with credential private key instead of attestation private key
@@ -541,6 +587,7 @@ uint8_t ctap_make_credential(CborEncoder * encoder, uint8_t * request, int lengt
     unsigned int i;
     uint8_t auth_data_buf[310];
     CTAP_credentialDescriptor * excl_cred = (CTAP_credentialDescriptor *) auth_data_buf;
+    fido2_allow_list_t excl_list;
     uint8_t sigbuf[FIDO2_ATTEST_SIG_LEN];// = auth_data_buf + 32;
     uint8_t sigder[72];// = auth_data_buf + 32 + 64;
 
@@ -586,6 +633,8 @@ uint8_t ctap_make_credential(CborEncoder * encoder, uint8_t * request, int lengt
     }
 
     // crypto_aes256_init(CRYPTO_TRANSPORT_KEY, NULL);
+    // Exclude list credential IDs are sent to main_mcu by batches of FIDO2_ALLOW_LIST_MAX_SIZE
+    excl_list.len = 0;
     for (i = 0; i < MC.excludeListSize; i++)
     {
         ret = parse_credential_descriptor(&MC.excludeList, excl_cred);
@@ -596,16 +645,26 @@ uint8_t ctap_make_credential(CborEncoder * encoder, uint8_t * request, int lengt
         check_retr(ret);
 
         printf1(TAG_GREEN, "checking credId: "); dump_hex1(TAG_GREEN, (uint8_t*) &excl_cred->id, sizeof(CredentialId));
+        memcpy(excl_list.tag[excl_list.len++], excl_cred->id.tag, FIDO2_CREDENTIAL_ID_LENGTH);
 
-        if (ctap_authenticate_credential(&MC.common.rp, excl_cred))
+        if (excl_list.len == FIDO2_ALLOW_LIST_MAX_SIZE)
         {
-            printf1(TAG_MC, "Cred %d failed!\r",i);
-            return CTAP2_ERR_CREDENTIAL_EXCLUDED;
+            if (ctap_authenticate_credential_list(&MC.common.rp, &excl_list))
+            {
+                printf1(TAG_MC, "Cred in batch ending at %d failed!\r",i);
+                return CTAP2_ERR_CREDENTIAL_EXCLUDED;
+            }
+            excl_list.len = 0;
         }
 
         ret = cbor_value_advance(&MC.excludeList);
         check_ret(ret);
     }
+    if ((excl_list.len > 0) && ctap_authenticate_credential_list(&MC.common.rp, &excl_list))
+    {
+        printf1(TAG_MC, "Cred in last batch failed!\r");
+        return CTAP2_ERR_CREDENTIAL_EXCLUDED;
+    }
 
 
     CborEncoder map;
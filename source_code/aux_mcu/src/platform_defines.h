@@ -185,6 +185,9 @@
 #define USB_CTAP_RX_ENDPOINT        4                   // CTAP RX endpoint
 #define USB_CTAP_TX_ENDPOINT        5                   // CTAP TX endpoint
 #define USB_NUMBER_OF_INTERFACES    3                   // Number of USB interfaces (RAW / KEYBOARD / CTAP)
+#define RAW_HID_USB_TX_QUEUE_DEPTH  4                   // Number of 64B packets queued for sending on USB, host polls every ms
+#define RAW_HID_BLE_TX_QUEUE_DEPTH  10                  // Same for BLE: a full aux MCU message, one notification per connection interval
+#define RAW_HID_CTAP_TX_QUEUE_DEPTH 4                   // Same for CTAP
 
 /* Bluetooth defies */
 #define BLE_PLATFORM_NAME           "Mooltipass Mini"
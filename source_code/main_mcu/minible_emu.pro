@@ -108,6 +108,7 @@ SOURCES += src/EMU/lis2hh12.c \
     src/EMU/emu_aux_mcu.c \
     src/EMU/emulator.cpp \
     src/EMU/emu_oled.cpp \
+    src/EMU/emu_scenario.cpp \
     src/EMU/emu_smartcard.cpp \
     src/EMU/emu_storage.cpp \
     src/EMU/emulator_ui.cpp
@@ -163,6 +164,7 @@ HEADERS  += src/MainWindow.h \ \
     src/EMU/asf.h \
     src/EMU/emu_aux_mcu.h \
     src/EMU/emu_oled.h \
+    src/EMU/emu_scenario.h \
     src/EMU/emu_smartcard.h \
     src/EMU/emu_storage.h \
     src/EMU/emulator.h \
@@ -42,12 +42,14 @@
 #include "main.h"
 #include "dma.h"
 #include "rng.h"
-/* Received and sent MCU messages */
-aux_mcu_message_t aux_mcu_receive_message;
-aux_mcu_message_t aux_mcu_send_message_2;
-aux_mcu_message_t aux_mcu_send_message_1;
-BOOL aux_mcu_message_1_reserved = FALSE;
-BOOL aux_mcu_message_2_reserved = FALSE;
+/* Ring of messages to be sent: reserved flags, transfer IDs after which they're sent, last reserved slot */
+aux_mcu_message_t aux_mcu_send_messages[AUX_MCU_TX_QUEUE_DEPTH];
+BOOL aux_mcu_send_messages_reserved[AUX_MCU_TX_QUEUE_DEPTH];
+uint32_t aux_mcu_send_messages_transfer_ids[AUX_MCU_TX_QUEUE_DEPTH];
+uint16_t aux_mcu_send_messages_last_slot = 0;
+/* TX queue diagnostics: max number of slots reserved or being sent, number of times we waited for a free slot */
+uint32_t aux_mcu_send_messages_max_used_slots = 0;
+uint32_t aux_mcu_send_messages_nb_stalls = 0;
 /* Flag set if comms are disabled */
 BOOL aux_mcu_comms_disabled = FALSE;
 /* Flag set if we have treated a message by only looking at its first bytes */
@@ -60,8 +62,8 @@ BOOL aux_mcu_comms_prev_aux_mcu_routine_wants_to_arm_rx = FALSE;
 BOOL aux_mcu_comms_invalid_message_received = FALSE;
 /* Flag set when rx transfer is already armed */
 BOOL aux_mcu_comms_rx_already_armed = FALSE;
-/* Flag set when the second tx buffer is requested */
-BOOL aux_mcu_comms_second_buffer_rerequested = FALSE;
+/* Flag set when a tx buffer is requested while all of them are reserved */
+BOOL aux_mcu_comms_tx_slots_exhausted = FALSE;
 /* Timeout delay for aux MCU communications */
 BOOL aux_mcu_comms_timeout_delay = AUX_MCU_MESSAGE_REPLY_TIMEOUT_MS;
 
@@ -103,31 +105,48 @@ BOOL comms_aux_mcu_get_and_clear_rx_transfer_already_armed(void)
     return ret_val;
 }
 
-/*! \fn     comms_aux_mcu_get_and_clear_second_tx_buffer_rerequested(void)
-*   \brief  Get and clear the tx buffer 2 re requested flag
+/*! \fn     comms_aux_mcu_get_and_clear_tx_slots_exhausted(void)
+*   \brief  Get and clear the tx buffer requested while all of them are reserved flag
 */
-BOOL comms_aux_mcu_get_and_clear_second_tx_buffer_rerequested(void)
+BOOL comms_aux_mcu_get_and_clear_tx_slots_exhausted(void)
 {
-    BOOL ret_val = aux_mcu_comms_second_buffer_rerequested;
-    aux_mcu_comms_second_buffer_rerequested = FALSE;
+    BOOL ret_val = aux_mcu_comms_tx_slots_exhausted;
+    aux_mcu_comms_tx_slots_exhausted = FALSE;
     return ret_val;
 }
 
+/*! \fn     comms_aux_mcu_get_queue_stats(uint32_t* tx_max_used_slots, uint32_t* tx_nb_stalls, uint32_t* rx_max_used_slots, uint32_t* rx_nb_stalls)
+*   \brief  Get the aux MCU TX & RX queues diagnostics
+*   \param  tx_max_used_slots   Where to store the max number of TX slots reserved or being sent at the same time
+*   \param  tx_nb_stalls        Where to store the number of times we had to wait for a TX slot to be sent
+*   \param  rx_max_used_slots   Where to store the max number of RX slots used at the same time
+*   \param  rx_nb_stalls        Where to store the number of times the aux MCU was held because all RX slots were used
+*/
+void comms_aux_mcu_get_queue_stats(uint32_t* tx_max_used_slots, uint32_t* tx_nb_stalls, uint32_t* rx_max_used_slots, uint32_t* rx_nb_stalls)
+{
+    *tx_max_used_slots = aux_mcu_send_messages_max_used_slots;
+    *tx_nb_stalls = aux_mcu_send_messages_nb_stalls;
+    dma_aux_mcu_get_rx_ring_stats(rx_max_used_slots, rx_nb_stalls);
+}
+
 /*! \fn     comms_aux_arm_rx_and_clear_no_comms(void)
 *   \brief  Init RX communications with aux MCU
 */
 void comms_aux_arm_rx_and_clear_no_comms(void)
 {
+    /* Release the RX slot of the message we dealt with */
+    BOOL rx_slot_released = dma_aux_mcu_release_rx_slot();
+    
     if (dma_aux_mcu_is_rx_transfer_already_init() == FALSE)
     {
         /* Arm USART RX interrupt to assert no comms signal, arm DMA transfer */
-        dma_aux_mcu_init_rx_transfer(AUXMCU_SERCOM, (void*)&aux_mcu_receive_message, sizeof(aux_mcu_receive_message));
+        dma_aux_mcu_init_rx_transfer(AUXMCU_SERCOM);
         
         /* While this sounded like a good idea, this isn't really one as this interrupt will only fire if the DMA fires after the second USART bytes is received (as one byte was received before the DMA could fetch it */
         /* It is however left here (because, why not?) but the no comms signal is asserted at the DMA end of transfer interrupt. Delay between interrupt firing and no comms assertion was measured at 4us */
         platform_io_arm_rx_usart_rx_interrupt();
     }
-    else
+    else if (rx_slot_released == FALSE)
     {
         /* Should never happen! */
         aux_mcu_comms_rx_already_armed = TRUE;
@@ -170,18 +189,12 @@ void comms_aux_mcu_wait_for_message_sent(void)
 }
 
 /*! \fn     comms_aux_mcu_get_free_tx_message_object_pt(void)
-*   \brief  Get a pointer to our temporary tx message object
+*   \brief  Get a pointer to a free slot of our tx messages ring
+*   \note   Only waits if all slots are reserved or still being sent
 */
 aux_mcu_message_t* comms_aux_mcu_get_free_tx_message_object_pt(void)
-{    
-    /* Wait for possible ongoing message to be sent */
-    comms_aux_mcu_wait_for_message_sent();
-    
-    /* Check for error */
-    if (aux_mcu_message_2_reserved != FALSE)
-    {
-        aux_mcu_comms_second_buffer_rerequested = TRUE;
-    }
+{
+    BOOL stall_counted = FALSE;
     
     /* A bit of background: the code is structured in such a way that every time a
     pointer is asked, the message is shortly sent after. There are a few cases where 
@@ -189,16 +202,60 @@ aux_mcu_message_t* comms_aux_mcu_get_free_tx_message_object_pt(void)
     through this new message to complete the first message.
     TLDR: for every pointer requested only one message is sent */
     
-    /* Check for message 1 reserved */
-    if (aux_mcu_message_1_reserved == FALSE)
+    /* Check for error: all slots reserved, none will ever be freed */
+    uint16_t nb_reserved_slots = 0;
+    for (uint16_t i = 0; i < AUX_MCU_TX_QUEUE_DEPTH; i++)
     {
-        aux_mcu_message_1_reserved = TRUE;
-        return &aux_mcu_send_message_1;
+        if (aux_mcu_send_messages_reserved[i] != FALSE)
+        {
+            nb_reserved_slots++;
+        }
     }
-    else
+    if (nb_reserved_slots == AUX_MCU_TX_QUEUE_DEPTH)
     {
-        aux_mcu_message_2_reserved = TRUE;
-        return &aux_mcu_send_message_2;        
+        aux_mcu_comms_tx_slots_exhausted = TRUE;
+        return &aux_mcu_send_messages[aux_mcu_send_messages_last_slot];
+    }
+    
+    while (TRUE)
+    {
+        /* Look for a slot neither reserved nor being sent, starting after the last one we gave so recently sent messages stay untouched */
+        uint32_t nb_used_slots = 1;
+        int16_t free_slot = -1;
+        for (uint16_t i = 1; i <= AUX_MCU_TX_QUEUE_DEPTH; i++)
+        {
+            uint16_t slot = (aux_mcu_send_messages_last_slot + i) % AUX_MCU_TX_QUEUE_DEPTH;
+            
+            if ((aux_mcu_send_messages_reserved[slot] != FALSE) || (dma_aux_mcu_is_tx_transfer_done(aux_mcu_send_messages_transfer_ids[slot]) == FALSE))
+            {
+                nb_used_slots++;
+            }
+            else if (free_slot < 0)
+            {
+                free_slot = slot;
+            }
+        }
+        
+        /* Found one? */
+        if (free_slot >= 0)
+        {
+            /* Diagnostics: the slot we're about to reserve is counted in */
+            if (nb_used_slots > aux_mcu_send_messages_max_used_slots)
+            {
+                aux_mcu_send_messages_max_used_slots = nb_used_slots;
+            }
+            
+            aux_mcu_send_messages_last_slot = (uint16_t)free_slot;
+            aux_mcu_send_messages_reserved[free_slot] = TRUE;
+            return &aux_mcu_send_messages[free_slot];
+        }
+        
+        /* All slots are queued for sending: wait */
+        if (stall_counted == FALSE)
+        {
+            aux_mcu_send_messages_nb_stalls++;
+            stall_counted = TRUE;
+        }
     }
 }
 
@@ -224,8 +281,8 @@ aux_mcu_message_t* comms_aux_mcu_get_empty_packet_ready_to_be_sent(uint16_t mess
 
 /*! \fn     comms_aux_mcu_send_message(aux_mcu_message_t* message_to_send)
 *   \brief  Send a message to the AUX MCU
-*   \param  message_to_send Pointer to the message to send (should be equal to &aux_mcu_send_message !)
-*   \note   Transfer is done through DMA so aux_mcu_send_message will be accessed after this function returns if boolean is set to false
+*   \param  message_to_send Pointer to the message to send (should be one of our tx messages ring slots !)
+*   \note   Transfer is queued and done through DMA so the message will be accessed after this function returns
 */
 void comms_aux_mcu_send_message(aux_mcu_message_t* message_to_send)
 {
@@ -239,26 +296,35 @@ void comms_aux_mcu_send_message(aux_mcu_message_t* message_to_send)
         timer_delay_ms(200);
     }        
         
-    /* Check that we're indeed sending the aux_mcu_send_message.... */
-    if ((message_to_send != &aux_mcu_send_message_1) && (message_to_send != &aux_mcu_send_message_2))
+    /* Check that we're indeed sending one of our tx messages.... */
+    if ((message_to_send < &aux_mcu_send_messages[0]) || (message_to_send > &aux_mcu_send_messages[AUX_MCU_TX_QUEUE_DEPTH-1]))
     {
         main_reboot();
     }
+    uint16_t slot = (uint16_t)(message_to_send - &aux_mcu_send_messages[0]);
     
-    /* Is reserved message 1 freed? */
-    if ((aux_mcu_message_1_reserved != FALSE) && (message_to_send == &aux_mcu_send_message_1))
-    {
-        aux_mcu_message_1_reserved = FALSE;
-    }
+    /* The function below queues the transfer, started once the previous ones are done */
+    aux_mcu_send_messages_transfer_ids[slot] = dma_aux_mcu_init_tx_transfer(AUXMCU_SERCOM, (void*)message_to_send, sizeof(*message_to_send));
     
-    /* Is reserved message 2 freed? */
-    if ((aux_mcu_message_2_reserved != FALSE) && (message_to_send == &aux_mcu_send_message_2))
+    /* Slot is free again once sent */
+    aux_mcu_send_messages_reserved[slot] = FALSE;
+}
+
+/*! \fn     comms_aux_mcu_discard_message(aux_mcu_message_t* message_to_discard)
+*   \brief  Give back a tx message slot whose message won't be sent after all
+*   \param  message_to_discard  Pointer to the message (should be one of our tx messages ring slots !)
+*   \note   Message contents are cleared as they may be sensitive
+*/
+void comms_aux_mcu_discard_message(aux_mcu_message_t* message_to_discard)
+{
+    /* Check that we're indeed discarding one of our tx messages.... */
+    if ((message_to_discard < &aux_mcu_send_messages[0]) || (message_to_discard > &aux_mcu_send_messages[AUX_MCU_TX_QUEUE_DEPTH-1]))
     {
-        aux_mcu_message_2_reserved = FALSE;
+        main_reboot();
     }
     
-    /* The function below does wait for a previous transfer to finish */
-    dma_aux_mcu_init_tx_transfer(AUXMCU_SERCOM, (void*)message_to_send, sizeof(*message_to_send));
+    memset((void*)message_to_discard, 0, sizeof(*message_to_discard));
+    aux_mcu_send_messages_reserved[message_to_discard - &aux_mcu_send_messages[0]] = FALSE;
 }
 
 /*! \fn     comms_aux_mcu_send_simple_command_message(uint16_t command)
@@ -649,6 +715,18 @@ static comms_msg_rcvd_te comms_aux_mcu_handle_fido2_auth_cred_msg(fido2_message_
     return FIDO2_MSG_RCVD;
 }
 
+/*! \fn     comms_msg_rcvd_te comms_aux_mcu_handle_fido2_excl_list_msg(fido2_message_t* received_message)
+*   \brief  routine handling authenticating a list of credentials
+*   \param  received_message    The received message
+*   \return FIDO2_MSG_RCVD
+*/
+static comms_msg_rcvd_te comms_aux_mcu_handle_fido2_excl_list_msg(fido2_message_t* received_message)
+{
+    fido2_excl_list_req_message_t* incoming_message = &received_message->fido2_excl_list_req_message;
+    logic_fido2_process_exclude_list(incoming_message);
+    return FIDO2_MSG_RCVD;
+}
+
 /*! \fn     comms_aux_mcu_handle_fido2_make_credential_msg(fido2_message_t* received_message)
 *   \brief  routine handling making a new credential
 *   \param  received_message    The received message
@@ -704,6 +782,11 @@ static comms_msg_rcvd_te comms_aux_mcu_handle_fido2_message(fido2_message_t* rec
                 msg_rcvd = comms_aux_mcu_handle_fido2_auth_cred_msg(received_message);
                 break;
             }
+            case AUX_MCU_FIDO2_EXCL_LIST_REQ:
+            {
+                msg_rcvd = comms_aux_mcu_handle_fido2_excl_list_msg(received_message);
+                break;
+            }
             case AUX_MCU_FIDO2_MC_REQ:
             {
                 msg_rcvd = comms_aux_mcu_handle_fido2_make_credential_msg(received_message);
@@ -826,8 +909,16 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
         aux_mcu_comms_prev_aux_mcu_routine_wants_to_arm_rx = FALSE;
     }
 
-    /* Ongoing RX transfer received bytes */
-    uint16_t nb_received_bytes_for_ongoing_transfer = sizeof(aux_mcu_receive_message) - dma_aux_mcu_get_remaining_bytes_for_rx_transfer();
+    /* Ongoing RX transfer message and received bytes: a full RX ring has no ongoing transfer */
+    aux_mcu_message_t* received_message_pt = (aux_mcu_message_t*)dma_aux_mcu_get_packet_being_received();
+    uint16_t nb_received_bytes_for_ongoing_transfer = 0;
+    if (dma_aux_mcu_is_rx_transfer_already_init() != FALSE)
+    {
+        nb_received_bytes_for_ongoing_transfer = sizeof(aux_mcu_message_t) - dma_aux_mcu_get_remaining_bytes_for_rx_transfer();
+    }
+    
+    /* Oldest completely received message, if any */
+    aux_mcu_message_t* complete_message_pt = (aux_mcu_message_t*)dma_aux_mcu_get_received_packet();
 
     /* For return: type of message received */
     comms_msg_rcvd_te msg_rcvd = NO_MSG_RCVD;
@@ -841,29 +932,30 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
     /* Received message payload length */
     uint16_t payload_length = 0;
     /* First part of message */
-    if ((nb_received_bytes_for_ongoing_transfer >= sizeof(aux_mcu_receive_message.message_type) + sizeof(aux_mcu_receive_message.payload_length1)) && (aux_mcu_message_answered_using_first_bytes == FALSE))
+    if ((nb_received_bytes_for_ongoing_transfer >= sizeof(received_message_pt->message_type) + sizeof(received_message_pt->payload_length1)) && (aux_mcu_message_answered_using_first_bytes == FALSE))
     {
         /* Issue no comms just in case */
         platform_io_set_no_comms();
         
-        /* Check if we were too slow to deal with the message before complete packet transfer */
-        if (dma_aux_mcu_check_and_clear_dma_transfer_flag() != FALSE)
+        /* Check if we were too slow to deal with the message before complete packet transfer (or if older messages are waiting) */
+        if (complete_message_pt != 0)
         {
             /* Complete packet receive, treat packet if valid flag is set or payload length #1 != 0 */
+            received_message_pt = complete_message_pt;
             aux_mcu_message_answered_using_first_bytes = FALSE;
 
-            if (aux_mcu_receive_message.payload_length1 != 0)
+            if (received_message_pt->payload_length1 != 0)
             {
                 arm_rx_transfer = TRUE;
                 should_deal_with_packet = TRUE;
-                payload_length = aux_mcu_receive_message.payload_length1;
+                payload_length = received_message_pt->payload_length1;
                 aux_mcu_comms_prev_aux_mcu_routine_wants_to_arm_rx = TRUE;
             }
-            else if (aux_mcu_receive_message.rx_payload_valid_flag != 0)
+            else if (received_message_pt->rx_payload_valid_flag != 0)
             {
                 arm_rx_transfer = TRUE;
                 should_deal_with_packet = TRUE;
-                payload_length = aux_mcu_receive_message.payload_length2;
+                payload_length = received_message_pt->payload_length2;
                 aux_mcu_comms_prev_aux_mcu_routine_wants_to_arm_rx = TRUE;
             }
             else
@@ -875,28 +967,29 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
                 comms_aux_mcu_set_invalid_message_received();
             }
         }
-        else if ((aux_mcu_receive_message.payload_length1 != 0) && (nb_received_bytes_for_ongoing_transfer >= sizeof(aux_mcu_receive_message.message_type) + sizeof(aux_mcu_receive_message.payload_length1) + aux_mcu_receive_message.payload_length1))
+        else if ((received_message_pt->payload_length1 != 0) && (nb_received_bytes_for_ongoing_transfer >= sizeof(received_message_pt->message_type) + sizeof(received_message_pt->payload_length1) + received_message_pt->payload_length1))
         {
             /* First part receive, payload is small enough so we can answer */
             should_deal_with_packet = TRUE;
             aux_mcu_message_answered_using_first_bytes = TRUE;
-            payload_length = aux_mcu_receive_message.payload_length1;
+            payload_length = received_message_pt->payload_length1;
         }
     }
-    else if (dma_aux_mcu_check_and_clear_dma_transfer_flag() != FALSE)
+    else if (complete_message_pt != 0)
     {
         /* Second part transfer, check if we have already dealt with this packet and if it is valid */
-        if ((aux_mcu_message_answered_using_first_bytes == FALSE) && ((aux_mcu_receive_message.payload_length1 != 0) || ((aux_mcu_receive_message.payload_length1 == 0) && (aux_mcu_receive_message.rx_payload_valid_flag != 0))))
+        received_message_pt = complete_message_pt;
+        if ((aux_mcu_message_answered_using_first_bytes == FALSE) && ((received_message_pt->payload_length1 != 0) || ((received_message_pt->payload_length1 == 0) && (received_message_pt->rx_payload_valid_flag != 0))))
         {
             arm_rx_transfer = TRUE;
             should_deal_with_packet = TRUE;
-            if (aux_mcu_receive_message.payload_length1 == 0)
+            if (received_message_pt->payload_length1 == 0)
             {
-                payload_length = aux_mcu_receive_message.payload_length2;
+                payload_length = received_message_pt->payload_length2;
             }
             else
             {
-                payload_length = aux_mcu_receive_message.payload_length1;
+                payload_length = received_message_pt->payload_length1;
             }
             aux_mcu_comms_prev_aux_mcu_routine_wants_to_arm_rx = TRUE;
         }
@@ -906,7 +999,7 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
             comms_aux_arm_rx_and_clear_no_comms();
         }
         
-        if ((aux_mcu_receive_message.payload_length1 == 0) && (aux_mcu_receive_message.rx_payload_valid_flag == 0))
+        if ((received_message_pt->payload_length1 == 0) && (received_message_pt->rx_payload_valid_flag == 0))
         {
             /* Flag invalid message */
             comms_aux_mcu_set_invalid_message_received();
@@ -945,21 +1038,21 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
     }
 
     /* USB / BLE Messages */
-    if ((aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_USB) || (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_BLE))
+    if ((received_message_pt->message_type == AUX_MCU_MSG_TYPE_USB) || (received_message_pt->message_type == AUX_MCU_MSG_TYPE_BLE))
     {        
         /* Store interface bool */
-        BOOL is_message_from_usb = (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_USB)?TRUE:FALSE;
+        BOOL is_message_from_usb = (received_message_pt->message_type == AUX_MCU_MSG_TYPE_USB)?TRUE:FALSE;
         
         /* Bool if parsing HID message required */
         BOOL hid_parsing_required = TRUE;
         
         /* Depending on command ID, prepare return */
-        if (aux_mcu_receive_message.hid_message.message_type == HID_CMD_ID_CANCEL_REQ)
+        if (received_message_pt->hid_message.message_type == HID_CMD_ID_CANCEL_REQ)
         {
             msg_rcvd = HID_CANCEL_MSG_RCVD;
             hid_parsing_required = FALSE;
         }
-        else if (aux_mcu_receive_message.hid_message.message_type == HID_CMD_ID_REINDEX_BUNDLE)
+        else if (received_message_pt->hid_message.message_type == HID_CMD_ID_REINDEX_BUNDLE)
         {
             msg_rcvd = HID_REINDEX_BUNDLE_RCVD;
         }
@@ -972,57 +1065,57 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
         #ifndef DEBUG_USB_COMMANDS_ENABLED
         if (hid_parsing_required != FALSE)
         {
-            comms_hid_msgs_parse(&aux_mcu_receive_message.hid_message, payload_length - sizeof(aux_mcu_receive_message.hid_message.message_type) - sizeof(aux_mcu_receive_message.hid_message.payload_length), answer_restrict_type, is_message_from_usb);
+            comms_hid_msgs_parse(&received_message_pt->hid_message, payload_length - sizeof(received_message_pt->hid_message.message_type) - sizeof(received_message_pt->hid_message.payload_length), answer_restrict_type, is_message_from_usb);
         }
         #else
         if (hid_parsing_required != FALSE)
         {
-            if (aux_mcu_receive_message.hid_message.message_type >= HID_MESSAGE_START_CMD_ID_DBG)
+            if (received_message_pt->hid_message.message_type >= HID_MESSAGE_START_CMD_ID_DBG)
             {
-                comms_hid_msgs_parse_debug(&aux_mcu_receive_message.hid_message, payload_length - sizeof(aux_mcu_receive_message.hid_message.message_type) - sizeof(aux_mcu_receive_message.hid_message.payload_length), answer_restrict_type, is_message_from_usb);
+                comms_hid_msgs_parse_debug(&received_message_pt->hid_message, payload_length - sizeof(received_message_pt->hid_message.message_type) - sizeof(received_message_pt->hid_message.payload_length), answer_restrict_type, is_message_from_usb);
                 msg_rcvd = HID_DBG_MSG_RCVD;
             }
             else
             {
-                comms_hid_msgs_parse(&aux_mcu_receive_message.hid_message, payload_length - sizeof(aux_mcu_receive_message.hid_message.message_type) - sizeof(aux_mcu_receive_message.hid_message.payload_length), answer_restrict_type, is_message_from_usb);
+                comms_hid_msgs_parse(&received_message_pt->hid_message, payload_length - sizeof(received_message_pt->hid_message.message_type) - sizeof(received_message_pt->hid_message.payload_length), answer_restrict_type, is_message_from_usb);
             }
         }        
         #endif
     }
-    else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_BOOTLOADER)
+    else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_BOOTLOADER)
     {
         msg_rcvd = BL_MSG_RCVD;
         asm("Nop");
     }
-    else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_MAIN_MCU_CMD)
+    else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_MAIN_MCU_CMD)
     {
         msg_rcvd = MAIN_MCU_MSG_RCVD;
         asm("Nop");
     }
-    else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_AUX_MCU_EVENT)
+    else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_AUX_MCU_EVENT)
     {
         msg_rcvd = EVENT_MSG_RCVD;
 
         /* Call dedicated function */
-        comms_aux_mcu_deal_with_received_event(&aux_mcu_receive_message);
+        comms_aux_mcu_deal_with_received_event(received_message_pt);
     }
-    else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_RNG_TRANSFER)
+    else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_RNG_TRANSFER)
     {
         msg_rcvd = RNG_MSG_RCVD;
 
         /* Set same message type and fill with random numbers */
-        aux_mcu_message_t* temp_send_message_pt = comms_aux_mcu_get_empty_packet_ready_to_be_sent(aux_mcu_receive_message.message_type);
+        aux_mcu_message_t* temp_send_message_pt = comms_aux_mcu_get_empty_packet_ready_to_be_sent(received_message_pt->message_type);
         rng_fill_array(temp_send_message_pt->payload, 32);
         temp_send_message_pt->payload_length1 = 32;
 
         /* Send message */
         comms_aux_mcu_send_message(temp_send_message_pt);
     }
-    else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_FIDO2)
+    else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_FIDO2)
     {
         if (answer_restrict_type == MSG_NO_RESTRICT)
         {
-            msg_rcvd = comms_aux_mcu_handle_fido2_message(&aux_mcu_receive_message.fido2_message);
+            msg_rcvd = comms_aux_mcu_handle_fido2_message(&received_message_pt->fido2_message);
         } 
         else
         {
@@ -1034,9 +1127,9 @@ comms_msg_rcvd_te comms_aux_mcu_routine(msg_restrict_type_te answer_restrict_typ
             msg_rcvd = FIDO2_MSG_RCVD;
         }
     }
-    else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_BLE_CMD)
+    else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_BLE_CMD)
     {
-        msg_rcvd = comms_aux_mcu_deal_with_ble_message(&aux_mcu_receive_message, answer_restrict_type);
+        msg_rcvd = comms_aux_mcu_deal_with_ble_message(received_message_pt, answer_restrict_type);
     }
     else
     {
@@ -1115,6 +1208,7 @@ aux_mcu_message_t* comms_aux_mcu_wait_for_aux_event(uint16_t aux_mcu_event)
 */
 RET_TYPE comms_aux_mcu_active_wait(aux_mcu_message_t** rx_message_pt_pt, uint16_t expected_packet, BOOL single_try, int16_t expected_event)
 {
+    aux_mcu_message_t* received_message_pt;
     uint16_t temp_timer_id;
     
     /* Bool for the do{} */
@@ -1145,16 +1239,16 @@ RET_TYPE comms_aux_mcu_active_wait(aux_mcu_message_t** rx_message_pt_pt, uint16_
         reloop = FALSE;
 
         /* Wait for complete message to be received */
-        BOOL dma_check_return = FALSE;
         timer_flag_te timer_flag_return = TIMER_RUNNING;
-        while((dma_check_return == FALSE) && (timer_flag_return == TIMER_RUNNING))
+        received_message_pt = 0;
+        while((received_message_pt == 0) && (timer_flag_return == TIMER_RUNNING))
         {
-            dma_check_return = dma_aux_mcu_check_and_clear_dma_transfer_flag();
+            received_message_pt = (aux_mcu_message_t*)dma_aux_mcu_get_received_packet();
             timer_flag_return = timer_has_allocated_timer_expired(temp_timer_id, FALSE);
         }
 
         /* Did the timer expire? */
-        if (dma_check_return == FALSE)
+        if (received_message_pt == 0)
         {
             /* Free timer */
             timer_deallocate_timer(temp_timer_id);
@@ -1163,67 +1257,65 @@ RET_TYPE comms_aux_mcu_active_wait(aux_mcu_message_t** rx_message_pt_pt, uint16_
 
         /* Get payload length */
         uint16_t payload_length;
-        if (aux_mcu_receive_message.payload_length1 != 0)
+        if (received_message_pt->payload_length1 != 0)
         {
-            payload_length = aux_mcu_receive_message.payload_length1;
+            payload_length = received_message_pt->payload_length1;
         }
         else
         {
-            payload_length = aux_mcu_receive_message.payload_length2;
+            payload_length = received_message_pt->payload_length2;
         }
 
         /* Check if message is invalid */
-        if ((payload_length > AUX_MCU_MSG_PAYLOAD_LENGTH) || ((aux_mcu_receive_message.payload_length1 == 0) && (aux_mcu_receive_message.rx_payload_valid_flag == 0)))
+        if ((payload_length > AUX_MCU_MSG_PAYLOAD_LENGTH) || ((received_message_pt->payload_length1 == 0) && (received_message_pt->rx_payload_valid_flag == 0)))
         {
             /* Reloop, rearm receive */
             reloop = TRUE;
-            dma_aux_mcu_check_and_clear_dma_transfer_flag();
             comms_aux_mcu_set_invalid_message_received();
             comms_aux_arm_rx_and_clear_no_comms();
         }
 
         /* Check if received message is the one we expected */
-        if ((aux_mcu_receive_message.message_type != expected_packet) || ((expected_event >= 0) && (aux_mcu_receive_message.aux_mcu_event_message.event_id != expected_event)))
+        if ((received_message_pt->message_type != expected_packet) || ((expected_event >= 0) && (received_message_pt->aux_mcu_event_message.event_id != expected_event)))
         {
-            /* Reloop, clear DMA flag */
+            /* Reloop */
             reloop = TRUE;
-            dma_aux_mcu_check_and_clear_dma_transfer_flag();
             
-            if ((aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_AUX_MCU_EVENT) && (aux_mcu_receive_message.aux_mcu_event_message.event_id != expected_event))
+            if ((received_message_pt->message_type == AUX_MCU_MSG_TYPE_AUX_MCU_EVENT) && (received_message_pt->aux_mcu_event_message.event_id != expected_event))
             {
                 /* Received another event... deal with it (doesn't generate answers */
-                comms_aux_mcu_deal_with_received_event(&aux_mcu_receive_message);
+                comms_aux_mcu_deal_with_received_event(received_message_pt);
             }
-            else if ((aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_USB) || (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_BLE))
+            else if ((received_message_pt->message_type == AUX_MCU_MSG_TYPE_USB) || (received_message_pt->message_type == AUX_MCU_MSG_TYPE_BLE))
             {                
                 /* Store interface bool */
-                BOOL is_message_from_usb = (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_USB)?TRUE:FALSE;
+                BOOL is_message_from_usb = (received_message_pt->message_type == AUX_MCU_MSG_TYPE_USB)?TRUE:FALSE;
                                 
                 /* Parse message */
                 #ifndef DEBUG_USB_COMMANDS_ENABLED
-                comms_hid_msgs_parse(&aux_mcu_receive_message.hid_message, payload_length - sizeof(aux_mcu_receive_message.hid_message.message_type) - sizeof(aux_mcu_receive_message.hid_message.payload_length), MSG_RESTRICT_ALL, is_message_from_usb);
+                comms_hid_msgs_parse(&received_message_pt->hid_message, payload_length - sizeof(received_message_pt->hid_message.message_type) - sizeof(received_message_pt->hid_message.payload_length), MSG_RESTRICT_ALL, is_message_from_usb);
                 #else
-                if (aux_mcu_receive_message.hid_message.message_type >= HID_MESSAGE_START_CMD_ID_DBG)
+                if (received_message_pt->hid_message.message_type >= HID_MESSAGE_START_CMD_ID_DBG)
                 {
-                    comms_hid_msgs_parse_debug(&aux_mcu_receive_message.hid_message, payload_length - sizeof(aux_mcu_receive_message.hid_message.message_type) - sizeof(aux_mcu_receive_message.hid_message.payload_length), MSG_RESTRICT_ALL, is_message_from_usb);
+                    comms_hid_msgs_parse_debug(&received_message_pt->hid_message, payload_length - sizeof(received_message_pt->hid_message.message_type) - sizeof(received_message_pt->hid_message.payload_length), MSG_RESTRICT_ALL, is_message_from_usb);
                 }
                 else
                 {
-                    comms_hid_msgs_parse(&aux_mcu_receive_message.hid_message, payload_length - sizeof(aux_mcu_receive_message.hid_message.message_type) - sizeof(aux_mcu_receive_message.hid_message.payload_length), MSG_RESTRICT_ALL, is_message_from_usb);
+                    comms_hid_msgs_parse(&received_message_pt->hid_message, payload_length - sizeof(received_message_pt->hid_message.message_type) - sizeof(received_message_pt->hid_message.payload_length), MSG_RESTRICT_ALL, is_message_from_usb);
                 }
                 #endif
             }
-            else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_RNG_TRANSFER)
+            else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_RNG_TRANSFER)
             {
                 /* Set same message type and fill with random numbers */
-                aux_mcu_message_t* temp_send_message_pt = comms_aux_mcu_get_empty_packet_ready_to_be_sent(aux_mcu_receive_message.message_type);
+                aux_mcu_message_t* temp_send_message_pt = comms_aux_mcu_get_empty_packet_ready_to_be_sent(received_message_pt->message_type);
                 rng_fill_array(temp_send_message_pt->payload, 32);
                 temp_send_message_pt->payload_length1 = 32;
                 
                 /* Send message */
                 comms_aux_mcu_send_message(temp_send_message_pt);
             }
-            else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_FIDO2)
+            else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_FIDO2)
             {
                 /* Send a please retry packet to aux MCU */
                 aux_mcu_message_t* temp_send_message_pt = comms_aux_mcu_get_empty_packet_ready_to_be_sent(AUX_MCU_MSG_TYPE_FIDO2);
@@ -1231,19 +1323,19 @@ RET_TYPE comms_aux_mcu_active_wait(aux_mcu_message_t** rx_message_pt_pt, uint16_
                 temp_send_message_pt->fido2_message.message_type = AUX_MCU_FIDO2_RETRY;
                 comms_aux_mcu_send_message(temp_send_message_pt);
             }
-            else if (aux_mcu_receive_message.message_type == AUX_MCU_MSG_TYPE_BLE_CMD)
+            else if (received_message_pt->message_type == AUX_MCU_MSG_TYPE_BLE_CMD)
             {
                 /* We can still tackle these requests as they do not generate prompts */
-                comms_aux_mcu_deal_with_ble_message(&aux_mcu_receive_message, MSG_RESTRICT_ALL);
+                comms_aux_mcu_deal_with_ble_message(received_message_pt, MSG_RESTRICT_ALL);
             }
             
             /* Rearm receive */
             comms_aux_arm_rx_and_clear_no_comms();
         }
     }while (reloop != FALSE);
-
+    
     /* Store pointer to message */
-    *rx_message_pt_pt = &aux_mcu_receive_message;
+    *rx_message_pt_pt = received_message_pt;
     
     /* Free timer */
     timer_deallocate_timer(temp_timer_id);
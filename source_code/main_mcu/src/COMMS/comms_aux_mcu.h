@@ -29,6 +29,7 @@
 #include "defines.h"
 
 /* Prototypes */
+void comms_aux_mcu_get_queue_stats(uint32_t* tx_max_used_slots, uint32_t* tx_nb_stalls, uint32_t* rx_max_used_slots, uint32_t* rx_nb_stalls);
 RET_TYPE comms_aux_mcu_active_wait(aux_mcu_message_t** rx_message_pt_pt, uint16_t expected_packet, BOOL single_try, int16_t expected_event);
 comms_msg_rcvd_te comms_aux_mcu_deal_with_ble_message(aux_mcu_message_t* received_message, msg_restrict_type_te answer_restrict_type);
 aux_mcu_message_t* comms_aux_mcu_get_empty_packet_ready_to_be_sent(uint16_t message_type);
@@ -37,9 +38,10 @@ void comms_aux_mcu_deal_with_received_event(aux_mcu_message_t* received_message)
 aux_mcu_message_t* comms_aux_mcu_wait_for_aux_event(uint16_t aux_mcu_event);
 aux_mcu_message_t* comms_aux_mcu_get_free_tx_message_object_pt(void);
 void comms_aux_mcu_send_message(aux_mcu_message_t* message_to_send);
-BOOL comms_aux_mcu_get_and_clear_second_tx_buffer_rerequested(void);
+void comms_aux_mcu_discard_message(aux_mcu_message_t* message_to_discard);
 void comms_aux_mcu_send_simple_command_message(uint16_t command);
 BOOL comms_aux_mcu_get_and_clear_rx_transfer_already_armed(void);
+BOOL comms_aux_mcu_get_and_clear_tx_slots_exhausted(void);
 void comms_aux_mcu_update_timeout_delay(uint16_t timeout_delay);
 BOOL comms_aux_mcu_get_and_clear_invalid_message_received(void);
 void comms_aux_mcu_hard_comms_reset_with_aux_mcu_reboot(void);
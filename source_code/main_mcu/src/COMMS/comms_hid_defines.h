@@ -27,6 +27,7 @@
 /* Includes */
 #include "custom_fs_defines.h"
 #include "platform_defines.h"
+#include "dataflash.h"
 #include "defines.h"
 
 /* Defines */
@@ -105,6 +106,9 @@
 #define HID_CMD_SET_CUST_BLE_NAME   0x0040
 #define HID_CMD_GET_TOTP_CODE       0x0041
 #define HID_CMD_GET_CUST_BLE_NAME   0x0042
+#define HID_CMD_START_BUNDLE_STREAM 0x0043
+#define HID_CMD_BUNDLE_STREAM_256B  0x0044
+#define HID_CMD_START_BUNDLE_DELTA  0x0045
 // Below: commands requiring MMM
 #define HID_CMD_GET_START_PARENTS   0x0100
 #define HID_CMD_END_MMM             0x0101
@@ -123,9 +127,25 @@
 #define HID_CMD_GET_CPZ_LUT_ENTRY   0x010E
 #define HID_CMD_GET_FAVORITES       0x010F
 #define HID_CMD_CHANGE_NODE_PWD     0x0110
+#define HID_CMD_READ_NODES_BATCH    0x0111
+#define HID_CMD_WRITE_NODES_BATCH   0x0112
+#define HID_CMD_EXPORT_DB           0x0113
+#define HID_CMD_IMPORT_DB           0x0114
 // Define used to identify commands
 #define HID_FIRST_CMD_FOR_MMM       HID_CMD_GET_START_PARENTS
 #define HID_LAST_CMD_FOR_MMM        0x0200
+// Batched node read / write
+#define HID_NODES_BATCH_FLAG_RANGE  0x0001      // Read request: addresses[0] is the start address, addresses[1] the number of node slots to scan
+#define HID_NODES_BATCH_FLAG_LAST   0x0001      // Answer: final status message of the batch
+#define HID_NODES_BATCH_MAX_NODES   512         // Max number of nodes / node slots per read request
+// Streamed DB export / import
+#define HID_DB_EXPORT_FLAG_PROFILE  0x0001      // Packet contains the start addresses & favorites
+#define HID_DB_EXPORT_FLAG_LAST     0x0002      // Last packet of the export
+#define HID_DB_EXPORT_PACKETS_PER_REQ   16      // Max number of packets sent per export request
+// Streamed bundle upload
+#define HID_BUNDLE_STREAM_WINDOW    8           // Max number of unacked chunks the host may send
+#define HID_BUNDLE_STREAM_ACK_INTERVAL  4       // Number of in-order chunks per cumulative ack
+#define HID_BUNDLE_STREAM_FLAG_RESYNC   0x0001  // Chunk out of sequence: host should resend from next_sequence_number
 
 /* Typedefs */
 typedef struct
@@ -238,6 +258,75 @@ typedef struct
     uint16_t last_chunk_flag;
 } hid_message_store_data_into_file_t;
 
+typedef struct
+{
+    uint16_t flags;
+    uint16_t addresses[0];
+} hid_message_read_nodes_batch_req_t;
+
+typedef struct
+{
+    uint16_t address;
+    uint16_t node_size;
+    uint8_t node_data[0];
+} hid_message_nodes_batch_entry_t;
+
+typedef struct
+{
+    uint16_t flags;
+    uint16_t nb_entries;
+    uint8_t entries[0];
+} hid_message_nodes_batch_t;
+
+typedef struct
+{
+    uint16_t flags;
+    uint16_t nb_entries;
+    uint16_t nb_nodes_ok;
+    uint16_t nb_nodes_denied;
+} hid_message_nodes_batch_status_t;
+
+typedef struct
+{
+    uint32_t cursor;
+} hid_message_db_export_req_t;
+
+typedef struct
+{
+    uint32_t cursor;
+    uint16_t flags;
+    uint16_t nb_entries;
+    uint8_t entries[0];
+} hid_message_db_export_t;
+
+typedef struct
+{
+    uint16_t nb_start_addresses;
+    uint16_t nb_favorites;
+    uint16_t addresses[0];
+} hid_message_db_export_profile_t;
+
+typedef struct
+{
+    uint32_t sequence_number;
+    uint8_t chunk[256];
+} hid_message_bundle_stream_chunk_t;
+
+typedef struct
+{
+    uint32_t next_sequence_number;
+    uint16_t window;
+    uint16_t flags;
+} hid_message_bundle_stream_ack_t;
+
+typedef struct
+{
+    uint8_t password[AES_BLOCK_SIZE/8];
+    uint32_t base_bundle_crc32;
+    uint32_t new_bundle_crc32;
+    uint8_t changed_sectors_bitmap[W25Q16_FLASH_SIZE/W25Q16_SECTOR_SIZE/8];
+} hid_message_bundle_delta_start_t;
+
 typedef struct
 {
     uint16_t message_type;
@@ -261,6 +350,14 @@ typedef struct
         hid_message_store_data_into_file_t store_data_in_file;
         hid_message_get_set_category_strings_t get_set_cat_strings;
         hid_message_setup_existing_user_req_t setup_existing_user_req;
+        hid_message_read_nodes_batch_req_t read_nodes_batch_req;
+        hid_message_nodes_batch_status_t nodes_batch_status;
+        hid_message_nodes_batch_t nodes_batch;
+        hid_message_db_export_req_t db_export_req;
+        hid_message_db_export_t db_export;
+        hid_message_bundle_stream_chunk_t bundle_stream_chunk;
+        hid_message_bundle_stream_ack_t bundle_stream_ack;
+        hid_message_bundle_delta_start_t bundle_delta_start;
     };
 } hid_message_t;
 
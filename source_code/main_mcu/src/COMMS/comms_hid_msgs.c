@@ -50,6 +50,21 @@
 #include "rng.h"
 /* Boolean to specify if bundle data upload is allowed */
 BOOL comms_hid_msgs_bundle_upload_allowed = FALSE;
+/* Tag of the current DB export cursors, 0 when no export was started */
+uint16_t comms_hid_msgs_db_export_tag = 0;
+/* User ID for which the current DB export was started */
+uint8_t comms_hid_msgs_db_export_user_id = 0;
+/* Streamed bundle upload: mode boolean, next expected chunk, end of the erased flash area */
+BOOL comms_hid_msgs_bundle_stream_mode = FALSE;
+uint32_t comms_hid_msgs_bundle_stream_next_seq = 0;
+uint32_t comms_hid_msgs_bundle_stream_erased_limit = 0;
+/* Set when a resync ack was sent, cleared when an in-order chunk is received */
+BOOL comms_hid_msgs_bundle_stream_resync_sent = FALSE;
+/* Delta bundle upload: mode boolean, expected crc32, 4KB sectors listed in the patch header and sectors erased so far */
+BOOL comms_hid_msgs_bundle_delta_mode = FALSE;
+uint32_t comms_hid_msgs_bundle_delta_new_crc32 = 0;
+uint8_t comms_hid_msgs_bundle_delta_changed_sectors[W25Q16_FLASH_SIZE/W25Q16_SECTOR_SIZE/8];
+uint8_t comms_hid_msgs_bundle_delta_erased_sectors[W25Q16_FLASH_SIZE/W25Q16_SECTOR_SIZE/8];
 
 
 /*! \fn     comms_hid_msgs_fill_get_status_message_answer(uint16_t* msg_array_uint16)
@@ -203,6 +218,149 @@ void comms_hid_msgs_send_ack_nack_message(BOOL usb_hid_message, uint16_t message
     comms_aux_mcu_send_message(temp_tx_message_pt);
 }
 
+/*! \fn     comms_hid_msgs_send_nodes_batch_status(BOOL usb_hid_message, uint16_t message_type, uint16_t nb_nodes_ok, uint16_t nb_nodes_denied)
+*   \brief  Send the final status message of a batched node read / write
+*   \param  usb_hid_message     TRUE for USB HID message
+*   \param  message_type        HID message type
+*   \param  nb_nodes_ok         Number of nodes read / written
+*   \param  nb_nodes_denied     Number of nodes the user couldn't access
+*/
+void comms_hid_msgs_send_nodes_batch_status(BOOL usb_hid_message, uint16_t message_type, uint16_t nb_nodes_ok, uint16_t nb_nodes_denied)
+{
+    aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(usb_hid_message, message_type, sizeof(hid_message_nodes_batch_status_t));
+    temp_tx_message_pt->hid_message.nodes_batch_status.flags = HID_NODES_BATCH_FLAG_LAST;
+    temp_tx_message_pt->hid_message.nodes_batch_status.nb_entries = 0;
+    temp_tx_message_pt->hid_message.nodes_batch_status.nb_nodes_ok = nb_nodes_ok;
+    temp_tx_message_pt->hid_message.nodes_batch_status.nb_nodes_denied = nb_nodes_denied;
+    comms_aux_mcu_send_message(temp_tx_message_pt);
+}
+
+/*! \fn     comms_hid_msgs_write_nodes_batch_entries(uint8_t* entries, uint16_t entries_length, uint16_t nb_entries, uint16_t* nb_nodes_written, uint16_t* nb_nodes_denied)
+*   \brief  Write packed (address, size, node) entries to the DB, in page order
+*   \param  entries             Pointer to the packed entries
+*   \param  entries_length      Total length of the packed entries
+*   \param  nb_entries          Number of entries
+*   \param  nb_nodes_written    Where to store the number of nodes written
+*   \param  nb_nodes_denied     Where to store the number of nodes the user couldn't access
+*   \return RETURN_NOK if the entries are malformed, in which case nothing is written
+*/
+RET_TYPE comms_hid_msgs_write_nodes_batch_entries(uint8_t* entries, uint16_t entries_length, uint16_t nb_entries, uint16_t* nb_nodes_written, uint16_t* nb_nodes_denied)
+{
+    uint16_t addresses[MEMBER_SIZE(hid_message_t, payload)/(sizeof(hid_message_nodes_batch_entry_t)+sizeof(parent_node_t))];
+    uint16_t node_sizes[MEMBER_SIZE(hid_message_t, payload)/(sizeof(hid_message_nodes_batch_entry_t)+sizeof(parent_node_t))];
+    uint8_t* nodes[MEMBER_SIZE(hid_message_t, payload)/(sizeof(hid_message_nodes_batch_entry_t)+sizeof(parent_node_t))];
+    uint16_t entries_index = 0;
+    *nb_nodes_written = 0;
+    *nb_nodes_denied = 0;
+    
+    /* Check format: all packed entries should be complete parent or child nodes */
+    if (nb_entries > ARRAY_SIZE(addresses))
+    {
+        return RETURN_NOK;
+    }
+    for (uint16_t i = 0; i < nb_entries; i++)
+    {
+        hid_message_nodes_batch_entry_t* entry_pt = (hid_message_nodes_batch_entry_t*)&entries[entries_index];
+        if ((entries_index + sizeof(hid_message_nodes_batch_entry_t) > entries_length) || ((entry_pt->node_size != sizeof(parent_node_t)) && (entry_pt->node_size != sizeof(child_node_t))) || (entries_index + sizeof(hid_message_nodes_batch_entry_t) + entry_pt->node_size > entries_length))
+        {
+            return RETURN_NOK;
+        }
+        entries_index += sizeof(hid_message_nodes_batch_entry_t) + entry_pt->node_size;
+    }
+    if (entries_index != entries_length)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Parent nodes may be modified: service index will be rebuilt on next search */
+    nodemgmt_invalidate_service_index();
+    
+    /* Keep the nodes the user has access to */
+    entries_index = 0;
+    for (uint16_t i = 0; i < nb_entries; i++)
+    {
+        hid_message_nodes_batch_entry_t* entry_pt = (hid_message_nodes_batch_entry_t*)&entries[entries_index];
+        node_type_te temp_node_type_te;
+        entries_index += sizeof(hid_message_nodes_batch_entry_t) + entry_pt->node_size;
+        
+        if ((nodemgmt_page_from_address(entry_pt->address) >= PAGE_COUNT) || (nodemgmt_check_user_permission(entry_pt->address, &temp_node_type_te) != RETURN_OK))
+        {
+            *nb_nodes_denied += 1;
+        }
+        else if ((entry_pt->node_size == sizeof(child_node_t)) && ((nodemgmt_page_from_address(nodemgmt_get_incremented_address(entry_pt->address)) >= PAGE_COUNT) || (nodemgmt_check_user_permission(nodemgmt_get_incremented_address(entry_pt->address), &temp_node_type_te) != RETURN_OK)))
+        {
+            *nb_nodes_denied += 1;
+        }
+        else
+        {
+            addresses[*nb_nodes_written] = entry_pt->address;
+            node_sizes[*nb_nodes_written] = entry_pt->node_size;
+            nodes[*nb_nodes_written] = entry_pt->node_data;
+            *nb_nodes_written += 1;
+        }
+    }
+    
+    /* Nodes sharing a page are written at once */
+    nodemgmt_write_node_blocks_to_flash_in_page_order(*nb_nodes_written, addresses, node_sizes, nodes);
+    return RETURN_OK;
+}
+
+/*! \fn     comms_hid_msgs_check_user_node_address(uint16_t address, node_type_te node_type)
+*   \brief  Check that an address received from the host is empty or points to a node of a given type owned by the current user
+*   \param  address     Node address
+*   \param  node_type   Expected node type
+*   \return RETURN_(N)OK
+*/
+static RET_TYPE comms_hid_msgs_check_user_node_address(uint16_t address, node_type_te node_type)
+{
+    node_type_te temp_node_type_te;
+    
+    if (address == NODE_ADDR_NULL)
+    {
+        return RETURN_OK;
+    }
+    
+    if ((nodemgmt_check_address_validity(address) != RETURN_OK) || (nodemgmt_check_user_permission(address, &temp_node_type_te) != RETURN_OK) || (temp_node_type_te != node_type))
+    {
+        return RETURN_NOK;
+    }
+    
+    return RETURN_OK;
+}
+
+/*! \fn     comms_hid_msgs_check_profile_addresses(uint16_t* addresses)
+*   \brief  Check the start addresses & favorites of an imported profile packet
+*   \param  addresses   Credential start addresses, data start addresses then favorites, as exported
+*   \return RETURN_(N)OK
+*   \note   Nodes should be imported before the profile packet, which is why it is exported last
+*/
+RET_TYPE comms_hid_msgs_check_profile_addresses(uint16_t* addresses)
+{
+    uint16_t nb_cred_start_addresses = MEMBER_ARRAY_SIZE(nodemgmt_profile_main_data_t, cred_start_addresses);
+    uint16_t nb_start_addresses = nb_cred_start_addresses + MEMBER_ARRAY_SIZE(nodemgmt_profile_main_data_t, data_start_addresses);
+    uint16_t nb_favorites = MEMBER_SIZE(nodemgmt_userprofile_t, category_favorites)/(sizeof(favorite_addr_t));
+    
+    /* Credential lists then data lists start with parent nodes */
+    for (uint16_t i = 0; i < nb_start_addresses; i++)
+    {
+        if (comms_hid_msgs_check_user_node_address(addresses[i], (i < nb_cred_start_addresses)? NODE_TYPE_PARENT : NODE_TYPE_PARENT_DATA) != RETURN_OK)
+        {
+            return RETURN_NOK;
+        }
+    }
+    
+    /* Favorites: (parent, child) credential pairs */
+    for (uint16_t i = 0; i < nb_favorites; i++)
+    {
+        if ((comms_hid_msgs_check_user_node_address(addresses[nb_start_addresses + 2*i], NODE_TYPE_PARENT) != RETURN_OK) || (comms_hid_msgs_check_user_node_address(addresses[nb_start_addresses + 2*i + 1], NODE_TYPE_CHILD) != RETURN_OK))
+        {
+            return RETURN_NOK;
+        }
+    }
+    
+    return RETURN_OK;
+}
+
 /*! \fn     comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_length, msg_restrict_type_te answer_restrict_type, BOOL is_message_from_usb)
 *   \brief  Parse an incoming message from USB or BLE
 *   \param  rcv_msg                 Received message
@@ -296,6 +454,9 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
     (rcv_msg->message_type != HID_CMD_START_BUNDLE_UL) &&
     (rcv_msg->message_type != HID_CMD_BUNDLE_WRITE_256B) &&
     (rcv_msg->message_type != HID_CMD_BUNDLE_UL_DONE) &&
+    (rcv_msg->message_type != HID_CMD_START_BUNDLE_STREAM) &&
+    (rcv_msg->message_type != HID_CMD_BUNDLE_STREAM_256B) &&
+    (rcv_msg->message_type != HID_CMD_START_BUNDLE_DELTA) &&
     (rcv_msg->message_type != HID_CMD_ID_CANCEL_REQ) &&
     (rcv_msg->message_type != HID_CMD_IM_LOCKED) &&
     (rcv_msg->message_type != HID_CMD_IM_UNLOCKED) &&
@@ -1032,6 +1193,9 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
         case HID_CMD_WRITE_NODE:
         {
             node_type_te temp_node_type_te;
+            
+            /* Parent nodes may be modified: service index will be rebuilt on next search */
+            nodemgmt_invalidate_service_index();
 
             /* Check for big or small node size */
             if ((rcv_msg->payload_length == sizeof(uint16_t) + sizeof(child_node_t)) \
@@ -1063,6 +1227,275 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             }
         }
 
+        case HID_CMD_READ_NODES_BATCH:
+        {
+            /* Check request format: flags followed by a list of addresses, or by a start address and a number of node slots */
+            if ((rcv_msg->payload_length < 2*sizeof(uint16_t)) || ((rcv_msg->payload_length % sizeof(uint16_t)) != 0))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            BOOL range_request = ((rcv_msg->read_nodes_batch_req.flags & HID_NODES_BATCH_FLAG_RANGE) != 0)? TRUE : FALSE;
+            uint16_t nb_addresses = rcv_msg->payload_length/sizeof(uint16_t) - 1;
+            uint16_t nb_slots_to_read = (range_request != FALSE)? rcv_msg->read_nodes_batch_req.addresses[1] : nb_addresses;
+            if (((range_request != FALSE) && (nb_addresses != 2)) || (nb_slots_to_read > HID_NODES_BATCH_MAX_NODES))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            aux_mcu_message_t* temp_tx_message_pt = 0;
+            uint16_t cur_address = rcv_msg->read_nodes_batch_req.addresses[0];
+            uint16_t nb_nodes_denied = 0;
+            uint16_t answer_length = 0;
+            uint16_t nb_nodes_read = 0;
+            uint16_t slot_index = 0;
+            
+            while (slot_index < nb_slots_to_read)
+            {
+                uint16_t node_address = (range_request != FALSE)? cur_address : rcv_msg->read_nodes_batch_req.addresses[slot_index];
+                node_type_te temp_node_type = NODE_TYPE_NULL;
+                uint16_t node_size = 0;
+                
+                /* Range requests stop at the end of the DB */
+                if ((range_request != FALSE) && (nodemgmt_page_from_address(node_address) >= PAGE_COUNT))
+                {
+                    break;
+                }
+                
+                /* Check user permission */
+                if ((nodemgmt_page_from_address(node_address) < PAGE_COUNT) && (nodemgmt_check_user_permission(node_address, &temp_node_type) == RETURN_OK))
+                {
+                    if ((temp_node_type == NODE_TYPE_PARENT) || (temp_node_type == NODE_TYPE_PARENT_DATA) || (temp_node_type == NODE_TYPE_NULL))
+                    {
+                        node_size = sizeof(parent_node_t);
+                    }
+                    else
+                    {
+                        node_size = sizeof(child_node_t);
+                    }
+                }
+                
+                /* Move on to next address / slot: child nodes take two slots, whoever they belong to */
+                slot_index++;
+                if (range_request != FALSE)
+                {
+                    cur_address = nodemgmt_get_incremented_address(cur_address);
+                    if ((temp_node_type == NODE_TYPE_CHILD) || (temp_node_type == NODE_TYPE_DATA))
+                    {
+                        cur_address = nodemgmt_get_incremented_address(cur_address);
+                        slot_index++;
+                    }
+                    
+                    /* Only report the user's nodes when scanning a range */
+                    if ((node_size == 0) || (temp_node_type == NODE_TYPE_NULL))
+                    {
+                        nb_nodes_denied += (node_size == 0)? 1 : 0;
+                        continue;
+                    }
+                }
+                else if (node_size == 0)
+                {
+                    nb_nodes_denied++;
+                }
+                
+                /* Send current answer if this node doesn't fit in it */
+                uint16_t entry_size = sizeof(hid_message_nodes_batch_entry_t) + node_size;
+                if ((temp_tx_message_pt != 0) && (answer_length + entry_size > max_payload_size))
+                {
+                    comms_hid_msgs_update_message_payload_length_fields(temp_tx_message_pt, answer_length);
+                    comms_aux_mcu_send_message(temp_tx_message_pt);
+                    temp_tx_message_pt = 0;
+                }
+                if (temp_tx_message_pt == 0)
+                {
+                    temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, 0);
+                    answer_length = sizeof(hid_message_nodes_batch_t);
+                }
+                
+                /* Append node */
+                hid_message_nodes_batch_entry_t* entry_pt = (hid_message_nodes_batch_entry_t*)&temp_tx_message_pt->hid_message.payload[answer_length];
+                entry_pt->address = node_address;
+                entry_pt->node_size = node_size;
+                if (node_size == sizeof(parent_node_t))
+                {
+                    nodemgmt_read_parent_node_data_block_from_flash(node_address, (parent_node_t*)entry_pt->node_data);
+                }
+                else if (node_size == sizeof(child_node_t))
+                {
+                    nodemgmt_read_child_node_data_block_from_flash(node_address, (child_node_t*)entry_pt->node_data);
+                }
+                nb_nodes_read += (node_size != 0)? 1 : 0;
+                temp_tx_message_pt->hid_message.nodes_batch.nb_entries++;
+                answer_length += entry_size;
+            }
+            
+            /* Send last nodes, then final status */
+            if (temp_tx_message_pt != 0)
+            {
+                comms_hid_msgs_update_message_payload_length_fields(temp_tx_message_pt, answer_length);
+                comms_aux_mcu_send_message(temp_tx_message_pt);
+            }
+            comms_hid_msgs_send_nodes_batch_status(is_message_from_usb, rcv_message_type, nb_nodes_read, nb_nodes_denied);
+            return;
+        }
+        
+        case HID_CMD_WRITE_NODES_BATCH:
+        {
+            uint16_t nb_nodes_written, nb_nodes_denied;
+            
+            /* Check message format then write nodes the user has access to */
+            if ((rcv_msg->payload_length < sizeof(hid_message_nodes_batch_t)) || (comms_hid_msgs_write_nodes_batch_entries(rcv_msg->nodes_batch.entries, rcv_msg->payload_length - sizeof(hid_message_nodes_batch_t), rcv_msg->nodes_batch.nb_entries, &nb_nodes_written, &nb_nodes_denied) != RETURN_OK))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            comms_hid_msgs_send_nodes_batch_status(is_message_from_usb, rcv_message_type, nb_nodes_written, nb_nodes_denied);
+            return;
+        }
+        
+        case HID_CMD_EXPORT_DB:
+        {
+            /* Check request: cursor token, 0 to start a new export */
+            if (rcv_msg->payload_length != sizeof(hid_message_db_export_req_t))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            uint32_t cursor = rcv_msg->db_export_req.cursor;
+            uint16_t next_address = (uint16_t)cursor;
+            BOOL export_done = FALSE;
+            node_type_te temp_node_type;
+            
+            if (cursor == 0)
+            {
+                /* New export: nodes in address order, then the profile packet so it can be checked against them on import */
+                comms_hid_msgs_db_export_tag = rng_get_random_uint16_t() | 0x0001;
+                comms_hid_msgs_db_export_user_id = logic_user_get_current_user_id();
+                next_address = nodemgmt_get_next_user_node_address(NODE_ADDR_NULL, &temp_node_type);
+            }
+            else if (((cursor >> 16) != comms_hid_msgs_db_export_tag) || (comms_hid_msgs_db_export_user_id != logic_user_get_current_user_id()))
+            {
+                /* Cursor from another export or another user */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            for (uint16_t nb_packets = 0; (nb_packets < HID_DB_EXPORT_PACKETS_PER_REQ) && (export_done == FALSE); nb_packets++)
+            {
+                aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, 0);
+                hid_message_db_export_t* export_pt = &temp_tx_message_pt->hid_message.db_export;
+                uint16_t answer_length = sizeof(hid_message_db_export_t);
+                export_pt->nb_entries = 0;
+                export_pt->flags = 0;
+                
+                if (next_address == NODE_ADDR_NULL)
+                {
+                    /* Profile packet: start addresses followed by favorites, ends the export */
+                    hid_message_db_export_profile_t* profile_pt = (hid_message_db_export_profile_t*)export_pt->entries;
+                    profile_pt->nb_start_addresses = nodemgmt_get_start_addresses(profile_pt->addresses);
+                    profile_pt->nb_favorites = nodemgmt_get_favorites(&profile_pt->addresses[profile_pt->nb_start_addresses]);
+                    answer_length += sizeof(hid_message_db_export_profile_t) + profile_pt->nb_start_addresses*sizeof(uint16_t) + profile_pt->nb_favorites*sizeof(favorite_addr_t);
+                    export_pt->flags = HID_DB_EXPORT_FLAG_PROFILE;
+                    export_done = TRUE;
+                }
+                else
+                {
+                    /* As many nodes as fit in the packet */
+                    while (TRUE)
+                    {
+                        uint16_t node_address = nodemgmt_get_next_user_node_address(next_address, &temp_node_type);
+                        uint16_t node_size = ((temp_node_type == NODE_TYPE_PARENT) || (temp_node_type == NODE_TYPE_PARENT_DATA))? sizeof(parent_node_t) : sizeof(child_node_t);
+                        
+                        /* All nodes sent: profile packet is next */
+                        if (node_address == NODE_ADDR_NULL)
+                        {
+                            next_address = NODE_ADDR_NULL;
+                            break;
+                        }
+                        next_address = node_address;
+                        if (answer_length + sizeof(hid_message_nodes_batch_entry_t) + node_size > max_payload_size)
+                        {
+                            break;
+                        }
+                        
+                        hid_message_nodes_batch_entry_t* entry_pt = (hid_message_nodes_batch_entry_t*)&temp_tx_message_pt->hid_message.payload[answer_length];
+                        entry_pt->address = node_address;
+                        entry_pt->node_size = node_size;
+                        if (node_size == sizeof(parent_node_t))
+                        {
+                            nodemgmt_read_parent_node_data_block_from_flash(node_address, (parent_node_t*)entry_pt->node_data);
+                            next_address = nodemgmt_get_incremented_address(node_address);
+                        }
+                        else
+                        {
+                            nodemgmt_read_child_node_data_block_from_flash(node_address, (child_node_t*)entry_pt->node_data);
+                            next_address = nodemgmt_get_incremented_address(nodemgmt_get_incremented_address(node_address));
+                        }
+                        answer_length += sizeof(hid_message_nodes_batch_entry_t) + node_size;
+                        export_pt->nb_entries++;
+                    }
+                }
+                
+                /* Cursor to resume the export after this packet */
+                export_pt->cursor = ((uint32_t)comms_hid_msgs_db_export_tag << 16) | next_address;
+                if (export_done != FALSE)
+                {
+                    export_pt->flags |= HID_DB_EXPORT_FLAG_LAST;
+                }
+                comms_hid_msgs_update_message_payload_length_fields(temp_tx_message_pt, answer_length);
+                comms_aux_mcu_send_message(temp_tx_message_pt);
+            }
+            return;
+        }
+        
+        case HID_CMD_IMPORT_DB:
+        {
+            uint16_t nb_nodes_written = 0;
+            uint16_t nb_nodes_denied = 0;
+            
+            /* Import packets are the export packets */
+            if (rcv_msg->payload_length < sizeof(hid_message_db_export_t))
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            if ((rcv_msg->db_export.flags & HID_DB_EXPORT_FLAG_PROFILE) != 0)
+            {
+                /* Profile packet: check the number of start addresses & favorites */
+                hid_message_db_export_profile_t* profile_pt = (hid_message_db_export_profile_t*)rcv_msg->db_export.entries;
+                uint16_t nb_start_addresses = MEMBER_ARRAY_SIZE(nodemgmt_profile_main_data_t, cred_start_addresses) + MEMBER_ARRAY_SIZE(nodemgmt_profile_main_data_t, data_start_addresses);
+                uint16_t nb_favorites = MEMBER_SIZE(nodemgmt_userprofile_t, category_favorites)/(sizeof(favorite_addr_t));
+                if ((rcv_msg->payload_length != sizeof(hid_message_db_export_t) + sizeof(hid_message_db_export_profile_t) + nb_start_addresses*sizeof(uint16_t) + nb_favorites*sizeof(favorite_addr_t)) || (profile_pt->nb_start_addresses != nb_start_addresses) || (profile_pt->nb_favorites != nb_favorites))
+                {
+                    comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                    return;
+                }
+                
+                /* Check they all point to nodes of the current user */
+                if (comms_hid_msgs_check_profile_addresses(profile_pt->addresses) != RETURN_OK)
+                {
+                    comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                    return;
+                }
+                
+                /* Store them */
+                nodemgmt_set_start_addresses(profile_pt->addresses);
+                nodemgmt_set_favorites(&profile_pt->addresses[nb_start_addresses]);
+            }
+            else if (comms_hid_msgs_write_nodes_batch_entries(rcv_msg->db_export.entries, rcv_msg->payload_length - sizeof(hid_message_db_export_t), rcv_msg->db_export.nb_entries, &nb_nodes_written, &nb_nodes_denied) != RETURN_OK)
+            {
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            comms_hid_msgs_send_nodes_batch_status(is_message_from_usb, rcv_message_type, nb_nodes_written, nb_nodes_denied);
+            return;
+        }
+
         case HID_CMD_GET_USER_CHANGE_NB :
         {
             /* Smartcard unlocked? */
@@ -2158,6 +2591,8 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             {
                 /* Set bundle upload allowed boolean */
                 comms_hid_msgs_bundle_upload_allowed = TRUE;
+                comms_hid_msgs_bundle_stream_mode = FALSE;
+                comms_hid_msgs_bundle_delta_mode = FALSE;
                 
                 /* Set state changed */
                 logic_device_set_state_changed();
@@ -2177,12 +2612,66 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             }
         }
         
+        case HID_CMD_START_BUNDLE_DELTA:
+        {
+            /* Read the header of the bundle currently stored in the external flash */
+            custom_file_flash_header_t base_bundle_header;
+            custom_fs_read_from_flash((uint8_t*)&base_bundle_header, CUSTOM_FS_FILES_ADDR_OFFSET, sizeof(base_bundle_header));
+            
+            /* Patch must have been generated against the intact bundle we have, then same checks as a standard bundle upload */
+            if ((is_message_from_usb != FALSE) && (rcv_msg->payload_length == sizeof(hid_message_bundle_delta_start_t)) && (base_bundle_header.magic_header == CUSTOM_FS_MAGIC_HEADER) && (base_bundle_header.crc32 == rcv_msg->bundle_delta_start.base_bundle_crc32) && (custom_fs_check_uploaded_bundle_crc32(W25Q16_FLASH_SIZE) == RETURN_OK) && (logic_device_bundle_update_start(FALSE, rcv_msg->bundle_delta_start.password) == RETURN_OK))
+            {
+                /* Store the patch header: listed sectors get erased on their first page write */
+                comms_hid_msgs_bundle_delta_new_crc32 = rcv_msg->bundle_delta_start.new_bundle_crc32;
+                memcpy(comms_hid_msgs_bundle_delta_changed_sectors, rcv_msg->bundle_delta_start.changed_sectors_bitmap, sizeof(comms_hid_msgs_bundle_delta_changed_sectors));
+                memset(comms_hid_msgs_bundle_delta_erased_sectors, 0, sizeof(comms_hid_msgs_bundle_delta_erased_sectors));
+                
+                /* Set bundle upload allowed boolean */
+                comms_hid_msgs_bundle_upload_allowed = TRUE;
+                comms_hid_msgs_bundle_stream_mode = FALSE;
+                comms_hid_msgs_bundle_delta_mode = TRUE;
+                
+                /* Set state changed */
+                logic_device_set_state_changed();
+                
+                /* Set ack, leave same command id */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, TRUE);
+                return;
+            }
+            else
+            {
+                /* Set nack, leave same command id */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+        }
+        
         case HID_CMD_BUNDLE_WRITE_256B:
         {
-            if (comms_hid_msgs_bundle_upload_allowed != FALSE)
+            /* First 4 bytes is the write address, remaining 256 bytes is the payload */
+            uint32_t* write_address = (uint32_t*)&rcv_msg->payload_as_uint32[0];
+            
+            /* Delta upload: only allow page writes inside the sectors listed in the patch header */
+            BOOL write_allowed = comms_hid_msgs_bundle_upload_allowed;
+            if (comms_hid_msgs_bundle_delta_mode != FALSE)
+            {
+                uint32_t sector_id = *write_address / W25Q16_SECTOR_SIZE;
+                uint8_t sector_mask = (uint8_t)(1 << (sector_id%8));
+                if (((*write_address % W25Q16_PAGE_SIZE) != 0) || (*write_address >= W25Q16_FLASH_SIZE) || ((comms_hid_msgs_bundle_delta_changed_sectors[sector_id/8] & sector_mask) == 0))
+                {
+                    write_allowed = FALSE;
+                }
+                else if ((comms_hid_msgs_bundle_delta_erased_sectors[sector_id/8] & sector_mask) == 0)
+                {
+                    /* First write to this sector: erase it, its unchanged pages are part of the patch */
+                    dataflash_erase_4kb_sector(&dataflash_descriptor, sector_id * W25Q16_SECTOR_SIZE);
+                    dataflash_wait_for_not_busy(&dataflash_descriptor);
+                    comms_hid_msgs_bundle_delta_erased_sectors[sector_id/8] |= sector_mask;
+                }
+            }
+            
+            if (write_allowed != FALSE)
             {
-                /* First 4 bytes is the write address, remaining 256 bytes is the payload */
-                uint32_t* write_address = (uint32_t*)&rcv_msg->payload_as_uint32[0];
                 dataflash_write_array_to_memory(&dataflash_descriptor, *write_address, &rcv_msg->payload[4], 256);
                 
                 /* Set ack, leave same command id */
@@ -2197,8 +2686,137 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
             }
         }
         
+        case HID_CMD_START_BUNDLE_STREAM:
+        {
+            /* Same checks as a standard bundle upload */
+            if ((is_message_from_usb != FALSE) && (rcv_msg->payload_length == (AES_BLOCK_SIZE/8)) && (logic_device_bundle_update_start(FALSE, rcv_msg->payload) == RETURN_OK))
+            {
+                /* Set bundle upload allowed boolean, start at chunk 0 */
+                comms_hid_msgs_bundle_upload_allowed = TRUE;
+                comms_hid_msgs_bundle_stream_mode = TRUE;
+                comms_hid_msgs_bundle_delta_mode = FALSE;
+                comms_hid_msgs_bundle_stream_next_seq = 0;
+                comms_hid_msgs_bundle_stream_resync_sent = FALSE;
+                
+                /* Set state changed */
+                logic_device_set_state_changed();
+                
+                /* No bulk erase: start erasing the first block, the next ones are erased ahead of the write cursor */
+                dataflash_wait_for_not_busy(&dataflash_descriptor);
+                dataflash_erase_64kb_block(&dataflash_descriptor, 0);
+                comms_hid_msgs_bundle_stream_erased_limit = W25Q16_BLOCK_SIZE;
+                
+                /* Send first ack with our window size */
+                aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, sizeof(hid_message_bundle_stream_ack_t));
+                temp_tx_message_pt->hid_message.bundle_stream_ack.next_sequence_number = 0;
+                temp_tx_message_pt->hid_message.bundle_stream_ack.window = HID_BUNDLE_STREAM_WINDOW;
+                temp_tx_message_pt->hid_message.bundle_stream_ack.flags = 0;
+                comms_aux_mcu_send_message(temp_tx_message_pt);
+                return;
+            }
+            else
+            {
+                /* Set nack, leave same command id */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+        }
+        
+        case HID_CMD_BUNDLE_STREAM_256B:
+        {
+            /* Sequence number followed by a 256B chunk, written at sequence number * 256 */
+            uint32_t sequence_number = rcv_msg->bundle_stream_chunk.sequence_number;
+            uint32_t write_address = sequence_number * W25Q16_PAGE_SIZE;
+            
+            if ((comms_hid_msgs_bundle_upload_allowed == FALSE) || (comms_hid_msgs_bundle_stream_mode == FALSE) || (rcv_msg->payload_length != sizeof(hid_message_bundle_stream_chunk_t)) || (sequence_number >= W25Q16_FLASH_SIZE/W25Q16_PAGE_SIZE))
+            {
+                /* Set nack, leave same command id */
+                comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                return;
+            }
+            
+            /* Duplicate or gap: ask the host once to resend from the next expected chunk, silently drop the chunks already in flight */
+            if (sequence_number != comms_hid_msgs_bundle_stream_next_seq)
+            {
+                if (comms_hid_msgs_bundle_stream_resync_sent == FALSE)
+                {
+                    aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, sizeof(hid_message_bundle_stream_ack_t));
+                    temp_tx_message_pt->hid_message.bundle_stream_ack.next_sequence_number = comms_hid_msgs_bundle_stream_next_seq;
+                    temp_tx_message_pt->hid_message.bundle_stream_ack.window = HID_BUNDLE_STREAM_WINDOW;
+                    temp_tx_message_pt->hid_message.bundle_stream_ack.flags = HID_BUNDLE_STREAM_FLAG_RESYNC;
+                    comms_aux_mcu_send_message(temp_tx_message_pt);
+                    comms_hid_msgs_bundle_stream_resync_sent = TRUE;
+                }
+                return;
+            }
+            
+            /* Make sure the page we're about to write was erased */
+            while (comms_hid_msgs_bundle_stream_erased_limit < write_address + W25Q16_PAGE_SIZE)
+            {
+                dataflash_wait_for_not_busy(&dataflash_descriptor);
+                dataflash_erase_64kb_block(&dataflash_descriptor, comms_hid_msgs_bundle_stream_erased_limit);
+                comms_hid_msgs_bundle_stream_erased_limit += W25Q16_BLOCK_SIZE;
+            }
+            
+            /* Previous erase may still be ongoing */
+            dataflash_wait_for_not_busy(&dataflash_descriptor);
+            dataflash_write_array_to_memory(&dataflash_descriptor, write_address, rcv_msg->bundle_stream_chunk.chunk, W25Q16_PAGE_SIZE);
+            comms_hid_msgs_bundle_stream_next_seq++;
+            comms_hid_msgs_bundle_stream_resync_sent = FALSE;
+            
+            /* Last page of the erased area written: start erasing the next block while the next chunks come in */
+            if ((write_address + W25Q16_PAGE_SIZE == comms_hid_msgs_bundle_stream_erased_limit) && (comms_hid_msgs_bundle_stream_erased_limit < W25Q16_FLASH_SIZE))
+            {
+                dataflash_erase_64kb_block(&dataflash_descriptor, comms_hid_msgs_bundle_stream_erased_limit);
+                comms_hid_msgs_bundle_stream_erased_limit += W25Q16_BLOCK_SIZE;
+            }
+            
+            /* Cumulative ack */
+            if ((comms_hid_msgs_bundle_stream_next_seq % HID_BUNDLE_STREAM_ACK_INTERVAL) == 0)
+            {
+                aux_mcu_message_t* temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, sizeof(hid_message_bundle_stream_ack_t));
+                temp_tx_message_pt->hid_message.bundle_stream_ack.next_sequence_number = comms_hid_msgs_bundle_stream_next_seq;
+                temp_tx_message_pt->hid_message.bundle_stream_ack.window = HID_BUNDLE_STREAM_WINDOW;
+                temp_tx_message_pt->hid_message.bundle_stream_ack.flags = 0;
+                comms_aux_mcu_send_message(temp_tx_message_pt);
+            }
+            return;
+        }
+        
         case HID_CMD_BUNDLE_UL_DONE:
         {
+            if ((comms_hid_msgs_bundle_upload_allowed != FALSE) && (comms_hid_msgs_bundle_stream_mode != FALSE))
+            {
+                /* Streamed upload: check the bundle crc32 before going further */
+                dataflash_wait_for_not_busy(&dataflash_descriptor);
+                if (custom_fs_check_uploaded_bundle_crc32(comms_hid_msgs_bundle_stream_next_seq*W25Q16_PAGE_SIZE) != RETURN_OK)
+                {
+                    /* Host can stream the bundle again from chunk 0, blocks will be erased again */
+                    comms_hid_msgs_bundle_stream_next_seq = 0;
+                    comms_hid_msgs_bundle_stream_erased_limit = 0;
+                    comms_hid_msgs_bundle_stream_resync_sent = FALSE;
+                    
+                    /* Set nack, leave same command id */
+                    comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                    return;
+                }
+                comms_hid_msgs_bundle_stream_mode = FALSE;
+            }
+            
+            if ((comms_hid_msgs_bundle_upload_allowed != FALSE) && (comms_hid_msgs_bundle_delta_mode != FALSE))
+            {
+                /* Delta upload: every listed sector must have been rewritten, the patched bundle must carry and match the announced crc32 */
+                custom_file_flash_header_t new_bundle_header;
+                custom_fs_read_from_flash((uint8_t*)&new_bundle_header, CUSTOM_FS_FILES_ADDR_OFFSET, sizeof(new_bundle_header));
+                if ((memcmp(comms_hid_msgs_bundle_delta_changed_sectors, comms_hid_msgs_bundle_delta_erased_sectors, sizeof(comms_hid_msgs_bundle_delta_changed_sectors)) != 0) || (new_bundle_header.crc32 != comms_hid_msgs_bundle_delta_new_crc32) || (custom_fs_check_uploaded_bundle_crc32(W25Q16_FLASH_SIZE) != RETURN_OK))
+                {
+                    /* Host can still rewrite listed sectors, or fall back to a complete upload */
+                    comms_hid_msgs_send_ack_nack_message(is_message_from_usb, rcv_message_type, FALSE);
+                    return;
+                }
+                comms_hid_msgs_bundle_delta_mode = FALSE;
+            }
+            
             if (comms_hid_msgs_bundle_upload_allowed != FALSE)
             {
                 /* Do required actions: depending on the mini BLE version, it's possible we don't come back from this function (bootloader launched) */
@@ -32,6 +32,9 @@ void comms_hid_msgs_parse(hid_message_t* rcv_msg, uint16_t supposed_payload_leng
 void comms_hid_msgs_update_message_fields(aux_mcu_message_t* message_pt, BOOL usb_hid_message, uint16_t message_type, uint16_t hid_payload_size);
 aux_mcu_message_t* comms_hid_msgs_get_empty_hid_packet(BOOL usb_hid_message, uint16_t message_type, uint16_t hid_payload_size);
 void comms_hid_msgs_update_message_payload_length_fields(aux_mcu_message_t* message_pt, uint16_t hid_payload_size);
+RET_TYPE comms_hid_msgs_write_nodes_batch_entries(uint8_t* entries, uint16_t entries_length, uint16_t nb_entries, uint16_t* nb_nodes_written, uint16_t* nb_nodes_denied);
+void comms_hid_msgs_send_nodes_batch_status(BOOL usb_hid_message, uint16_t message_type, uint16_t nb_nodes_ok, uint16_t nb_nodes_denied);
+RET_TYPE comms_hid_msgs_check_profile_addresses(uint16_t* addresses);
 void comms_hid_msgs_send_ack_nack_message(BOOL usb_hid_message, uint16_t message_type, BOOL ack_message);
 uint16_t comms_hid_msgs_fill_get_status_message_answer(uint16_t* msg_array_uint16);
 
@@ -34,6 +34,7 @@
 #include "platform_io.h"
 #include "logic_power.h"
 #include "dataflash.h"
+#include "dbflash.h"
 #include "sh1122.h"
 #include "main.h"
 #include "dma.h"
@@ -284,8 +285,7 @@ void comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payloa
         case HID_CMD_ID_FLASH_AUX_MCU:
         {            
             /* Wait for current packet reception and arm reception */
-            dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag();
-            comms_aux_arm_rx_and_clear_no_comms();            
+            comms_aux_mcu_prepare_for_active_rx_packet_receive();
             logic_aux_mcu_flash_firmware_update(TRUE);            
             return;
         }
@@ -344,6 +344,26 @@ void comms_hid_msgs_parse_debug(hid_message_t* rcv_msg, uint16_t supposed_payloa
             comms_aux_mcu_send_message(temp_tx_message_pt);
             return;          
         }
+        case HID_CMD_ID_GET_DBFLASH_CACHE_STATS:
+        {
+            aux_mcu_message_t* temp_tx_message_pt;
+            
+            /* Get empty message, fill it with page cache hits & misses and send it */
+            temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, 8);
+            dbflash_get_page_cache_stats(&temp_tx_message_pt->hid_message.payload_as_uint32[0], &temp_tx_message_pt->hid_message.payload_as_uint32[1]);
+            comms_aux_mcu_send_message(temp_tx_message_pt);
+            return;
+        }
+        case HID_CMD_ID_GET_AUX_QUEUE_STATS:
+        {
+            aux_mcu_message_t* temp_tx_message_pt;
+            
+            /* Get empty message, fill it with aux MCU TX & RX queues max depths & stalls and send it */
+            temp_tx_message_pt = comms_hid_msgs_get_empty_hid_packet(is_message_from_usb, rcv_message_type, 16);
+            comms_aux_mcu_get_queue_stats(&temp_tx_message_pt->hid_message.payload_as_uint32[0], &temp_tx_message_pt->hid_message.payload_as_uint32[1], &temp_tx_message_pt->hid_message.payload_as_uint32[2], &temp_tx_message_pt->hid_message.payload_as_uint32[3]);
+            comms_aux_mcu_send_message(temp_tx_message_pt);
+            return;
+        }
         case HID_CMD_ID_GET_BATTERY_STATUS:
         {
             aux_mcu_message_t* temp_tx_message_pt;
@@ -42,13 +42,56 @@ volatile BOOL dma_custom_fs_transfer_done = FALSE;
 volatile BOOL dma_oled_transfer_done = FALSE;
 /* Boolean to specify if the last DMA transfer for the accelerometer is done */
 volatile BOOL dma_acc_transfer_done = FALSE;
-/* Boolean to specify if we received a packet from aux MCU */
-volatile BOOL dma_aux_mcu_packet_received = FALSE;
+/* Number of packets received from aux MCU and not yet handed out */
+volatile uint16_t dma_aux_mcu_nb_packets_received = 0;
 /* Boolean to specify if we sent a packet to aux MCU */
 volatile BOOL dma_aux_mcu_packet_sent = TRUE;
 /* Boolean to specify if DMA needs to be rearmed to receive an aux MCU packet (use with caution) */
 volatile BOOL dma_aux_mcu_rx_transfer_to_be_rearmed = TRUE;
-
+/* Ring of slots for packets received from aux MCU, filled in turn: slot being received, oldest slot not released, number of received slots not released */
+aux_mcu_message_t dma_aux_mcu_rx_slots[AUX_MCU_RX_QUEUE_DEPTH];
+volatile uint16_t dma_aux_mcu_rx_write_slot = 0;
+volatile uint16_t dma_aux_mcu_rx_read_slot = 0;
+volatile uint16_t dma_aux_mcu_rx_nb_used_slots = 0;
+/* Aux MCU RX ring: sercom to use when the DMA interrupt arms the next slot */
+Sercom* dma_aux_mcu_rx_sercom = 0;
+/* Aux MCU RX ring diagnostics: max number of used slots, number of times the ring was full */
+uint32_t dma_aux_mcu_rx_max_used_slots = 0;
+uint32_t dma_aux_mcu_rx_nb_stalls = 0;
+/* Queue of transfers to aux MCU, each started once the previous one is done and its flood protection expired */
+void* dma_aux_mcu_tx_queue_datap[AUX_MCU_TX_QUEUE_DEPTH*2];
+uint16_t dma_aux_mcu_tx_queue_size[AUX_MCU_TX_QUEUE_DEPTH*2];
+volatile uint16_t dma_aux_mcu_tx_queue_read_index = 0;
+volatile uint16_t dma_aux_mcu_tx_queue_nb_transfers = 0;
+Sercom* dma_aux_mcu_tx_sercom = 0;
+/* Number of transfers to aux MCU queued and done since boot */
+volatile uint32_t dma_aux_mcu_nb_tx_transfers_queued = 0;
+volatile uint32_t dma_aux_mcu_nb_tx_transfers_done = 0;
+
+/*! \fn     dma_aux_mcu_arm_rx_slot(void)
+*   \brief  Arm the reception of the next aux MCU packet in the current RX ring slot
+*   \note   To be called with interrupts disabled
+*/
+static void dma_aux_mcu_arm_rx_slot(void)
+{
+    aux_mcu_message_t* slot_pt = &dma_aux_mcu_rx_slots[dma_aux_mcu_rx_write_slot];
+    volatile void *usart_data_p = &dma_aux_mcu_rx_sercom->USART.DATA.reg;
+    uint16_t size = sizeof(aux_mcu_message_t);
+    
+    /* Setup transfer size */
+    dma_descriptors[DMA_DESCID_RX_COMMS].BTCNT.bit.BTCNT = size;
+    /* Destination address: the slot */
+    dma_descriptors[DMA_DESCID_RX_COMMS].DSTADDR.reg = (uint32_t)slot_pt + size;
+    /* Source address: DATA register from USART */
+    dma_descriptors[DMA_DESCID_RX_COMMS].SRCADDR.reg = (uint32_t)usart_data_p;
+    
+    /* Resume DMA channel operation */
+    DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_RX_COMMS);
+    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    
+    /* Set boolean */
+    dma_aux_mcu_rx_transfer_to_be_rearmed = FALSE;
+}
 
 /*! \fn     DMAC_Handler(void)
 *   \brief  Function called by interrupt when RX is done
@@ -60,11 +103,27 @@ void DMAC_Handler(void)
     DMAC->CHID.reg = DMAC_CHID_ID(DMA_DESCID_RX_COMMS);
     if ((DMAC->CHINTFLAG.reg & DMAC_CHINTFLAG_TCMPL) != 0)
     {
-        /* Set transfer done boolean, clear interrupt */
-        platform_io_set_no_comms();
-        dma_aux_mcu_packet_received = TRUE;
+        /* One more packet received, clear interrupt */
+        dma_aux_mcu_nb_packets_received++;
+        dma_aux_mcu_rx_nb_used_slots++;
         DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
-        dma_aux_mcu_rx_transfer_to_be_rearmed = TRUE;
+        if (dma_aux_mcu_rx_nb_used_slots > dma_aux_mcu_rx_max_used_slots)
+        {
+            dma_aux_mcu_rx_max_used_slots = dma_aux_mcu_rx_nb_used_slots;
+        }
+        
+        /* Move on to the next slot: receive into it straight away if it is free, otherwise hold the aux MCU until a slot is released */
+        dma_aux_mcu_rx_write_slot = (dma_aux_mcu_rx_write_slot + 1) % AUX_MCU_RX_QUEUE_DEPTH;
+        if (dma_aux_mcu_rx_nb_used_slots < AUX_MCU_RX_QUEUE_DEPTH)
+        {
+            dma_aux_mcu_arm_rx_slot();
+        }
+        else
+        {
+            platform_io_set_no_comms();
+            dma_aux_mcu_rx_nb_stalls++;
+            dma_aux_mcu_rx_transfer_to_be_rearmed = TRUE;
+        }
     }
     
     /* AUX MCU RX routine */
@@ -74,7 +133,8 @@ void DMAC_Handler(void)
         /* Arm MCU systick for tx flood protection */
         timer_arm_mcu_systick_for_aux_tx_flood_protection();
         
-        /* Set transfer done boolean, clear interrupt */
+        /* Set transfer done boolean, clear interrupt, next queued transfer is started once flood protection expires */
+        dma_aux_mcu_nb_tx_transfers_done++;
         dma_aux_mcu_packet_sent = TRUE;
         DMAC->CHINTFLAG.reg = DMAC_CHINTFLAG_TCMPL;
     }
@@ -125,11 +185,11 @@ void dma_set_custom_fs_flag_done(void)
 }
 
 /*! \fn     dma_wait_for_aux_mcu_packet_sent(void)
-*   \brief  Wait for aux mcu packet to be sent
+*   \brief  Wait for all queued aux mcu packets to be sent
 */
 void dma_wait_for_aux_mcu_packet_sent(void)
 {
-    while (dma_aux_mcu_packet_sent == FALSE);
+    while ((dma_aux_mcu_tx_queue_nb_transfers != 0) || (dma_aux_mcu_packet_sent == FALSE));
 }
 
 /*! \fn     dma_reset(void)
@@ -377,41 +437,75 @@ uint16_t dma_aux_mcu_get_remaining_bytes_for_rx_transfer(void)
     }
 }
 
-/*! \fn     dma_aux_mcu_check_and_clear_dma_transfer_flag(void)
-*   \brief  Check if a DMA transfer from aux MCU comms has been done
-*   \note   If the flag is true, flag will be cleared to false
-*   \return TRUE or FALSE
+/*! \fn     dma_aux_mcu_get_received_packet(void)
+*   \brief  Get the oldest packet received from aux MCU that wasn't handed out yet
+*   \return Pointer to the packet or 0 if there is none
+*   \note   The packet RX ring slot is ours until dma_aux_mcu_release_rx_slot is called
 */
-BOOL dma_aux_mcu_check_and_clear_dma_transfer_flag(void)
+void* dma_aux_mcu_get_received_packet(void)
 {
-    /* flag can't be set twice, code is safe */
-    if (dma_aux_mcu_packet_received != FALSE)
+    void* packet_pt = 0;
+    
+    cpu_irq_enter_critical();
+    if (dma_aux_mcu_nb_packets_received != 0)
     {
-        dma_aux_mcu_packet_received = FALSE;
-        return TRUE;
+        /* Packets handed out and not released yet come first in the ring */
+        uint16_t slot = (dma_aux_mcu_rx_read_slot + dma_aux_mcu_rx_nb_used_slots - dma_aux_mcu_nb_packets_received) % AUX_MCU_RX_QUEUE_DEPTH;
+        packet_pt = (void*)&dma_aux_mcu_rx_slots[slot];
+        dma_aux_mcu_nb_packets_received--;
     }
-    return FALSE;
+    cpu_irq_leave_critical();
+    
+    return packet_pt;
 }
 
-/*! \fn     dma_aux_mcu_check_dma_transfer_flag(void)
-*   \brief  Check if a DMA transfer from aux MCU comms has been done
-*   \return TRUE or FALSE
+/*! \fn     dma_aux_mcu_get_packet_being_received(void)
+*   \brief  Get the RX ring slot the DMA is currently receiving into
+*   \return Pointer to the packet being received
 */
-BOOL dma_aux_mcu_check_dma_transfer_flag(void)
+void* dma_aux_mcu_get_packet_being_received(void)
 {
-    return dma_aux_mcu_packet_received;
+    return (void*)&dma_aux_mcu_rx_slots[dma_aux_mcu_rx_write_slot];
+}
+
+/*! \fn     dma_aux_mcu_release_rx_slot(void)
+*   \brief  Release the RX ring slot of the oldest packet handed out, so the DMA can receive into it again
+*   \return If a slot was released
+*/
+BOOL dma_aux_mcu_release_rx_slot(void)
+{
+    BOOL ret_val = FALSE;
+    
+    cpu_irq_enter_critical();
+    if (dma_aux_mcu_rx_nb_used_slots > dma_aux_mcu_nb_packets_received)
+    {
+        dma_aux_mcu_rx_read_slot = (dma_aux_mcu_rx_read_slot + 1) % AUX_MCU_RX_QUEUE_DEPTH;
+        dma_aux_mcu_rx_nb_used_slots--;
+        ret_val = TRUE;
+    }
+    cpu_irq_leave_critical();
+    
+    return ret_val;
+}
+
+/*! \fn     dma_aux_mcu_get_rx_ring_stats(uint32_t* max_used_slots, uint32_t* nb_stalls)
+*   \brief  Get the RX ring diagnostics
+*   \param  max_used_slots  Where to store the max number of slots used at the same time
+*   \param  nb_stalls       Where to store the number of times the aux MCU was held because all slots were used
+*/
+void dma_aux_mcu_get_rx_ring_stats(uint32_t* max_used_slots, uint32_t* nb_stalls)
+{
+    *max_used_slots = dma_aux_mcu_rx_max_used_slots;
+    *nb_stalls = dma_aux_mcu_rx_nb_stalls;
 }
 
 /*! \fn     dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void)
-*   \brief  Wait for the complete reception of current AUX MCU packet
-*   \return If the DMA reception flag was already cleared
+*   \brief  Wait for the complete reception of current AUX MCU packet and hand it out
+*   \note   To be used for a packet already dealt with using its first bytes, which then only needs its slot released
 */
-BOOL dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void)
+void dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void)
 {
-    while (dma_aux_mcu_rx_transfer_to_be_rearmed == FALSE);
-    BOOL ret_val = dma_aux_mcu_packet_received;
-    dma_aux_mcu_packet_received = FALSE;
-    return !ret_val;
+    while (dma_aux_mcu_get_received_packet() == 0);
 }
 
 /*! \fn     dma_custom_fs_init_transfer(Sercom* sercom, void* datap, uint16_t size)
@@ -576,6 +670,79 @@ uint32_t dma_compute_crc32_from_spi(Sercom* sercom, uint32_t size)
     return DMAC->CRCCHKSUM.reg;
 }
 
+/*! \fn     dma_custom_fs_compute_crc32_from_spi(Sercom* sercom, uint32_t size)
+*   \brief  Use the DMA controller to compute a CRC32 from a spi transfer, through the custom fs channels
+*   \param  sercom      Pointer to a sercom module
+*   \param  size        Number of bytes to transfer
+*   \return the crc32
+*   \note   Unlike dma_compute_crc32_from_spi, can be called while the DMA controller is running (aux MCU comms, accelerometer...)
+*/
+uint32_t dma_custom_fs_compute_crc32_from_spi(Sercom* sercom, uint32_t size)
+{
+    volatile void *spi_data_p = &sercom->SPI.DATA.reg;
+    /* The byte that will be used to read/write spi data */
+    volatile uint8_t temp_src_dst_reg = 0;
+    
+    /* Setup CRC32: CRC generator needs to be disabled to change its setup */
+    DMAC->CTRL.bit.CRCENABLE = 0;
+    DMAC_CRCCTRL_Type crc_ctrl_reg;
+    crc_ctrl_reg.reg = 0;
+    crc_ctrl_reg.bit.CRCSRC = 0x20 + DMA_DESCID_RX_FS;                                      // Custom fs RX channel
+    crc_ctrl_reg.bit.CRCPOLY = DMAC_CRCCTRL_CRCPOLY_CRC32_Val;                              // CRC32
+    crc_ctrl_reg.bit.CRCBEATSIZE = DMAC_CRCCTRL_CRCBEATSIZE_BYTE_Val;                       // Beat size is one byte
+    DMAC->CRCCTRL = crc_ctrl_reg;                                                           // Store register
+    DMAC->CRCCHKSUM.reg = 0xFFFFFFFF;                                                       // Not sure why, it is needed
+    DMAC->CTRL.bit.CRCENABLE = 1;                                                           // Enable CRC generator
+    
+    /* Custom fs transfers without address increment: we only care about the crc */
+    dma_descriptors[DMA_DESCID_RX_FS].BTCTRL.bit.DSTINC = 0;
+    dma_descriptors[DMA_DESCID_TX_FS].BTCTRL.bit.SRCINC = 0;
+    
+    uint32_t nb_bytes_to_transfer = size;
+    while (size > 0)
+    {
+        /* Compute nb bytes to transfer */
+        if (size > UINT16_MAX)
+        {
+            nb_bytes_to_transfer = UINT16_MAX;
+        } 
+        else
+        {
+            nb_bytes_to_transfer = size;
+        }
+        
+        /* Arm transfers, same as dma_custom_fs_init_transfer */
+        cpu_irq_enter_critical();
+        dma_descriptors[DMA_DESCID_RX_FS].BTCNT.bit.BTCNT = (uint16_t)nb_bytes_to_transfer;
+        dma_descriptors[DMA_DESCID_RX_FS].SRCADDR.reg = (uint32_t)spi_data_p;
+        dma_descriptors[DMA_DESCID_RX_FS].DSTADDR.reg = (uint32_t)&temp_src_dst_reg;
+        DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_RX_FS);
+        DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+        dma_descriptors[DMA_DESCID_TX_FS].BTCNT.bit.BTCNT = (uint16_t)nb_bytes_to_transfer;
+        dma_descriptors[DMA_DESCID_TX_FS].DSTADDR.reg = (uint32_t)spi_data_p;
+        dma_descriptors[DMA_DESCID_TX_FS].SRCADDR.reg = (uint32_t)&temp_src_dst_reg;
+        DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_TX_FS);
+        DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+        cpu_irq_leave_critical();
+        
+        /* Wait for transfer to finish: flag set by our interrupt */
+        while (dma_custom_fs_check_and_clear_dma_transfer_flag() == FALSE);
+        
+        /* Update size */
+        size -= nb_bytes_to_transfer;
+    }
+    
+    /* Get crc32 from dma */
+    while ((DMAC->CRCSTATUS.reg & DMAC_CRCSTATUS_CRCBUSY) == DMAC_CRCSTATUS_CRCBUSY);
+    uint32_t crc32 = DMAC->CRCCHKSUM.reg;
+    
+    /* Back to normal custom fs transfers */
+    DMAC->CTRL.bit.CRCENABLE = 0;
+    dma_descriptors[DMA_DESCID_RX_FS].BTCTRL.bit.DSTINC = 1;
+    dma_descriptors[DMA_DESCID_TX_FS].BTCTRL.bit.SRCINC = 1;
+    return crc32;
+}
+
 /*! \fn     dma_oled_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint16_t dma_trigger)
 *   \brief  Initialize a DMA transfer from an array to the oled spi bus
 *   \param  sercom      Pointer to a sercom module
@@ -680,39 +847,89 @@ void dma_acc_init_transfer(Sercom *sercom, void* datap, uint16_t size, uint8_t*
     cpu_irq_leave_critical();
 }
 
+/*! \fn     dma_aux_mcu_start_queued_tx_transfer(void)
+*   \brief  Start the oldest queued DMA transfer to the AUX MCU, if the previous one is done and its flood protection expired (120us around)
+*   \note   Called when a transfer is queued and by the systick interrupt once the flood protection expires
+*/
+void dma_aux_mcu_start_queued_tx_transfer(void)
+{
+    cpu_irq_enter_critical();
+    
+    if ((dma_aux_mcu_tx_queue_nb_transfers != 0) && (dma_aux_mcu_packet_sent != FALSE) && (timer_has_aux_tx_flood_protection_expired() != FALSE))
+    {
+        volatile void *usart_data_p = &dma_aux_mcu_tx_sercom->USART.DATA.reg;
+        void* datap = dma_aux_mcu_tx_queue_datap[dma_aux_mcu_tx_queue_read_index];
+        uint16_t size = dma_aux_mcu_tx_queue_size[dma_aux_mcu_tx_queue_read_index];
+        
+        /* Remove it from the queue */
+        dma_aux_mcu_tx_queue_read_index = (dma_aux_mcu_tx_queue_read_index + 1) % ARRAY_SIZE(dma_aux_mcu_tx_queue_datap);
+        dma_aux_mcu_tx_queue_nb_transfers--;
+        
+        /* Set bool */
+        dma_aux_mcu_packet_sent = FALSE;
+        
+        /* Setup transfer size */
+        dma_descriptors[DMA_DESCID_TX_COMMS].BTCNT.bit.BTCNT = (uint16_t)size;
+        /* Destination address: DATA register from USART */
+        dma_descriptors[DMA_DESCID_TX_COMMS].DSTADDR.reg = (uint32_t)usart_data_p;
+        /* Source address: given value */
+        dma_descriptors[DMA_DESCID_TX_COMMS].SRCADDR.reg = (uint32_t)datap + size;
+        
+        /* Resume DMA channel operation */
+        DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_TX_COMMS);
+        DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    }
+    
+    cpu_irq_leave_critical();
+}
+
 /*! \fn     dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size)
-*   \brief  Initialize a DMA transfer to the AUX MCU
+*   \brief  Queue a DMA transfer to the AUX MCU
 *   \param  sercom      Pointer to a sercom module
-*   \param  datap       Pointer to the data
+*   \param  datap       Pointer to the data, to be left untouched until the transfer is done
 *   \param  size        Number of bytes to transfer
+*   \return Transfer ID, to be given to dma_aux_mcu_is_tx_transfer_done
 */
-void dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size)
+uint32_t dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size)
 {
-    volatile void *usart_data_p = &sercom->USART.DATA.reg;
-    
-    /* Wait for previous transfer to be done */
-    while (dma_aux_mcu_packet_sent == FALSE);
+    uint32_t transfer_id;
     
-    /* Wait for flood protection to expire (120us around) */
-    timer_wait_for_aux_tx_flood_protection();
+    /* Wait for a free queue spot */
+    while (dma_aux_mcu_tx_queue_nb_transfers == ARRAY_SIZE(dma_aux_mcu_tx_queue_datap));
     
     cpu_irq_enter_critical();
     
-    /* Set bool */
-    dma_aux_mcu_packet_sent = FALSE;
+    /* Queue transfer */
+    uint16_t write_index = (dma_aux_mcu_tx_queue_read_index + dma_aux_mcu_tx_queue_nb_transfers) % ARRAY_SIZE(dma_aux_mcu_tx_queue_datap);
+    dma_aux_mcu_tx_queue_datap[write_index] = datap;
+    dma_aux_mcu_tx_queue_size[write_index] = size;
+    dma_aux_mcu_tx_queue_nb_transfers++;
+    dma_aux_mcu_tx_sercom = sercom;
+    transfer_id = ++dma_aux_mcu_nb_tx_transfers_queued;
     
-    /* Setup transfer size */
-    dma_descriptors[DMA_DESCID_TX_COMMS].BTCNT.bit.BTCNT = (uint16_t)size;
-    /* Source address: DATA register from SPI */
-    dma_descriptors[DMA_DESCID_TX_COMMS].DSTADDR.reg = (uint32_t)usart_data_p;
-    /* Destination address: given value */
-    dma_descriptors[DMA_DESCID_TX_COMMS].SRCADDR.reg = (uint32_t)datap + size;
-    
-    /* Resume DMA channel operation */
-    DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_TX_COMMS);
-    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
+    /* Start it if the link is idle */
+    dma_aux_mcu_start_queued_tx_transfer();
     
     cpu_irq_leave_critical();
+    
+    return transfer_id;
+}
+
+/*! \fn     dma_aux_mcu_is_tx_transfer_done(uint32_t transfer_id)
+*   \brief  Know if a queued DMA transfer to the AUX MCU is done
+*   \param  transfer_id Transfer ID returned by dma_aux_mcu_init_tx_transfer
+*   \return TRUE or FALSE
+*/
+BOOL dma_aux_mcu_is_tx_transfer_done(uint32_t transfer_id)
+{
+    if ((int32_t)(dma_aux_mcu_nb_tx_transfers_done - transfer_id) >= 0)
+    {
+        return TRUE;
+    }
+    else
+    {
+        return FALSE;
+    }
 }
 
 /*! \fn     dma_aux_mcu_disable_transfer(void)
@@ -736,36 +953,29 @@ void dma_aux_mcu_disable_transfer(void)
     /* Wait for bit clear */
     while(DMAC->CHCTRLA.reg != 0);
     
-    /* Reset bool */
-    dma_aux_mcu_packet_received = FALSE;
+    /* Empty the RX ring, the next transfer is to be armed again */
+    dma_aux_mcu_nb_packets_received = 0;
+    dma_aux_mcu_rx_nb_used_slots = 0;
+    dma_aux_mcu_rx_read_slot = dma_aux_mcu_rx_write_slot;
+    dma_aux_mcu_rx_transfer_to_be_rearmed = TRUE;
     
     cpu_irq_leave_critical();    
 }
 
-/*! \fn     dma_aux_mcu_init_rx_transfer(Sercom* sercom, void* datap, uint16_t size)
-*   \brief  Initialize a DMA transfer from the AUX MCU
+/*! \fn     dma_aux_mcu_init_rx_transfer(Sercom* sercom)
+*   \brief  Initialize a DMA transfer from the AUX MCU, into the current slot of the RX ring
 *   \param  sercom      Pointer to a sercom module
-*   \param  datap       Pointer to where to store the data
-*   \param  size        Number of bytes for transfer
+*   \note   The DMA interrupt then keeps on receiving packets in the next slots, as long as they are released in time
 */
-void dma_aux_mcu_init_rx_transfer(Sercom* sercom, void* datap, uint16_t size)
+void dma_aux_mcu_init_rx_transfer(Sercom* sercom)
 {
-    volatile void *usart_data_p = &sercom->USART.DATA.reg;
     cpu_irq_enter_critical();
     
-    /* Setup transfer size */
-    dma_descriptors[DMA_DESCID_RX_COMMS].BTCNT.bit.BTCNT = (uint16_t)size;
-    /* Source address: DATA register from SPI */
-    dma_descriptors[DMA_DESCID_RX_COMMS].DSTADDR.reg = (uint32_t)datap + size;
-    /* Destination address: given value */
-    dma_descriptors[DMA_DESCID_RX_COMMS].SRCADDR.reg = (uint32_t)usart_data_p;
-    
-    /* Resume DMA channel operation */
-    DMAC->CHID.reg= DMAC_CHID_ID(DMA_DESCID_RX_COMMS);
-    DMAC->CHCTRLA.reg = DMAC_CHCTRLA_ENABLE;
-    
-    /* Set boolean */
-    dma_aux_mcu_rx_transfer_to_be_rearmed = FALSE;
+    dma_aux_mcu_rx_sercom = sercom;
+    if (dma_aux_mcu_rx_nb_used_slots < AUX_MCU_RX_QUEUE_DEPTH)
+    {
+        dma_aux_mcu_arm_rx_slot();
+    }
     
     cpu_irq_leave_critical();
 }
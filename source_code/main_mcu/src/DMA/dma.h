@@ -30,26 +30,30 @@
 
 /* Prototypes */
 void dma_oled_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint16_t dma_trigger);
+uint32_t dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size);
 void dma_acc_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint8_t* read_cmd);
-uint32_t dma_compute_crc32_from_spi(Sercom* sercom, uint32_t size);
-void dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size);
-void dma_aux_mcu_init_rx_transfer(Sercom* sercom, void* datap, uint16_t size);
+void dma_aux_mcu_get_rx_ring_stats(uint32_t* max_used_slots, uint32_t* nb_stalls);
+uint32_t dma_custom_fs_compute_crc32_from_spi(Sercom* sercom, uint32_t size);
+void dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void);
 void dma_custom_fs_init_transfer(Sercom* sercom, void* datap, uint16_t size);
-BOOL dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void);
+uint32_t dma_compute_crc32_from_spi(Sercom* sercom, uint32_t size);
+void dma_aux_mcu_init_rx_transfer(Sercom* sercom);
 uint16_t dma_aux_mcu_get_remaining_bytes_for_rx_transfer(void);
 BOOL dma_custom_fs_check_and_clear_dma_transfer_flag(void);
-BOOL dma_aux_mcu_check_and_clear_dma_transfer_flag(void);
+BOOL dma_aux_mcu_is_tx_transfer_done(uint32_t transfer_id);
 BOOL dma_oled_check_and_clear_dma_transfer_flag(void);
 BOOL dma_acc_check_and_clear_dma_transfer_flag(void);
+void dma_aux_mcu_start_queued_tx_transfer(void);
 BOOL dma_aux_mcu_is_rx_transfer_already_init(void);
-BOOL dma_aux_mcu_check_dma_transfer_flag(void);
+void* dma_aux_mcu_get_packet_being_received(void);
+void* dma_aux_mcu_get_received_packet(void);
 void dma_wait_for_aux_mcu_packet_sent(void);
 BOOL dma_acc_check_dma_transfer_flag(void);
+BOOL dma_aux_mcu_release_rx_slot(void);
 void dma_aux_mcu_disable_transfer(void);
 void dma_set_custom_fs_flag_done(void);
 void dma_acc_disable_transfer(void);
 void dma_reset(void);
 void dma_init(void);
 
-
 #endif /* DMA_H_ */
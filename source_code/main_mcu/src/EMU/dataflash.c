@@ -3,8 +3,56 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+/* Bundle image, mapped in memory (read in memory on windows) */
+static const uint8_t* bundle_data = NULL;
+static uint32_t bundle_size = 0;
+/* Read cursor for opened transfers */
+static uint32_t bundle_read_address = 0;
+
+static BOOL emu_dataflash_map_bundle(int fd)
+{
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size <= 0)
+        return FALSE;
+
+#ifndef WIN32
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map == MAP_FAILED)
+        return FALSE;
+    bundle_data = map;
+#else
+    uint8_t *buf = malloc(st.st_size);
+    if(!buf || read(fd, buf, st.st_size) != st.st_size) {
+        free(buf);
+        return FALSE;
+    }
+    bundle_data = buf;
+#endif
+
+    bundle_size = st.st_size;
+    return TRUE;
+}
 
-static int bundle_fd = -1;
+/* Copy bundle bytes, reads past the end of the image return erased flash */
+static void emu_dataflash_copy(uint32_t address, uint8_t* data, uint32_t length)
+{
+    uint32_t available = 0;
+    if(address < bundle_size)
+        available = (length < bundle_size - address) ? length : bundle_size - address;
+
+    if(available > 0)
+        memcpy(data, bundle_data + address, available);
+
+    if(available < length)
+        memset(data + available, 0xff, length - available);
+}
 
 void emu_dataflash_init(const char *path)
 {
@@ -27,12 +75,16 @@ void emu_dataflash_init(const char *path)
     for(i = 0; bundle_paths[i] != NULL;i++) {
         fprintf(stderr, "Trying to open bundle file %s\n", bundle_paths[i]);
 #ifdef O_BINARY
-        bundle_fd = open(bundle_paths[i], O_RDONLY|O_BINARY);
+        int bundle_fd = open(bundle_paths[i], O_RDONLY|O_BINARY);
 #else
-        bundle_fd = open(bundle_paths[i], O_RDONLY);
+        int bundle_fd = open(bundle_paths[i], O_RDONLY);
 #endif
-        if(bundle_fd >= 0)
-            return;
+        if(bundle_fd >= 0) {
+            BOOL mapped = emu_dataflash_map_bundle(bundle_fd);
+            close(bundle_fd);
+            if(mapped)
+                return;
+        }
     }
 
     fprintf(stderr, "Failed to open bundle file, tried:\n");
@@ -44,21 +96,22 @@ void emu_dataflash_init(const char *path)
 void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length){}
 void dataflash_read_data_array(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length) 
 {
-    lseek(bundle_fd, address, SEEK_SET);
-    read(bundle_fd, data, length);
+    emu_dataflash_copy(address, data, length);
 }
 
 void dataflash_read_bytes_from_opened_transfer(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length) {
-    read(bundle_fd, data, length);
+    emu_dataflash_copy(bundle_read_address, data, length);
+    bundle_read_address += length;
 }
 
 void dataflash_send_command(spi_flash_descriptor_t* descriptor_pt, uint8_t* data, uint32_t length){}
 void dataflash_send_single_byte_command(spi_flash_descriptor_t* descriptor_pt, uint8_t command){}
 void dataflash_read_data_array_start(spi_flash_descriptor_t* descriptor_pt, uint32_t address) {
-    lseek(bundle_fd, address, SEEK_SET);
+    bundle_read_address = address;
 }
 
 void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t address){}
+void dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address){}
 void dataflash_bulk_erase_without_wait(spi_flash_descriptor_t* descriptor_pt){}
 uint8_t dataflash_read_status_register(spi_flash_descriptor_t* descriptor_pt){return 0;}
 void dataflash_stop_ongoing_transfer(spi_flash_descriptor_t* descriptor_pt){}
@@ -36,8 +36,15 @@ RET_TYPE dbflash_check_presence(spi_flash_descriptor_t* descriptor_pt)
 {   
     if(!initialized) {
         initialized = TRUE;
-        emu_dbflash_open();
+        emu_dbflash_open(DBFLASH_SIZE);
     }
 
     return RETURN_OK;
 }
+
+void dbflash_get_page_cache_stats(uint32_t* hits, uint32_t* misses)
+{
+    // No page cache in front of the emulated storage
+    *hits = 0;
+    *misses = 0;
+}
@@ -1,29 +1,46 @@
 #include "dma.h"
+#include "comms_aux_mcu.h"
 #include "emu_aux_mcu.h"
+#include "emu_oled.h"
 
-void dma_oled_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint16_t dma_trigger){}
+/* Transfers complete immediately: the whole buffer goes to the display at once */
+void dma_oled_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint16_t dma_trigger)
+{
+    if(sercom == OLED_SERCOM) {
+        emu_oled_data(datap, size);
+    }
+}
 void dma_acc_init_transfer(Sercom* sercom, void* datap, uint16_t size, uint8_t* read_cmd){}
 uint32_t dma_compute_crc32_from_spi(Sercom* sercom, uint32_t size){return 0;}
+uint32_t dma_custom_fs_compute_crc32_from_spi(Sercom* sercom, uint32_t size){return 0;}
+
+/* Transfers to the emulated aux MCU are done as soon as queued */
+static uint32_t dma_aux_mcu_nb_tx_transfers = 0;
 
-void dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size)
+uint32_t dma_aux_mcu_init_tx_transfer(Sercom* sercom, void* datap, uint16_t size)
 {
     emu_send_aux(datap, size);
+    return ++dma_aux_mcu_nb_tx_transfers;
 }
 
+BOOL dma_aux_mcu_is_tx_transfer_done(uint32_t transfer_id){return TRUE;}
+void dma_aux_mcu_start_queued_tx_transfer(void){}
+
+/* Single RX slot: the next packet is only received once the firmware rearms reception */
+static aux_mcu_message_t aux_rcv_slot;
 static BOOL dma_aux_mcu_packet_received = FALSE;
 static char *aux_rcvbuf;
 static int aux_rcv_remain;
 
-void dma_aux_mcu_init_rx_transfer(Sercom* sercom, void* datap, uint16_t size)
+void dma_aux_mcu_init_rx_transfer(Sercom* sercom)
 {
-    aux_rcv_remain = size;
-    aux_rcvbuf = datap;
+    aux_rcv_remain = sizeof(aux_rcv_slot);
+    aux_rcvbuf = (char*)&aux_rcv_slot;
 }
 
-BOOL dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void){
+void dma_aux_mcu_wait_for_current_packet_reception_and_clear_flag(void){
     while(dma_aux_mcu_get_remaining_bytes_for_rx_transfer()) {}
     dma_aux_mcu_packet_received = FALSE;
-    return TRUE;
 }
 
 uint16_t dma_aux_mcu_get_remaining_bytes_for_rx_transfer(void){
@@ -38,27 +55,31 @@ uint16_t dma_aux_mcu_get_remaining_bytes_for_rx_transfer(void){
     return aux_rcv_remain;
 }
 
-BOOL dma_aux_mcu_check_and_clear_dma_transfer_flag(void)
+void* dma_aux_mcu_get_received_packet(void)
 {
     // this updates the flag
     (void)dma_aux_mcu_get_remaining_bytes_for_rx_transfer();
 
     if (dma_aux_mcu_packet_received) { 
         dma_aux_mcu_packet_received = FALSE;
-        return TRUE;
+        return &aux_rcv_slot;
     }
-    return FALSE;
+    return NULL;
 }
 
-BOOL dma_aux_mcu_check_dma_transfer_flag(void)
+void* dma_aux_mcu_get_packet_being_received(void){return &aux_rcv_slot;}
+BOOL dma_aux_mcu_release_rx_slot(void){return FALSE;}
+
+void dma_aux_mcu_get_rx_ring_stats(uint32_t* max_used_slots, uint32_t* nb_stalls)
 {
-    (void)dma_aux_mcu_get_remaining_bytes_for_rx_transfer();
-    return dma_aux_mcu_packet_received;
+    *max_used_slots = 0;
+    *nb_stalls = 0;
 }
 
 void dma_aux_mcu_disable_transfer(void){
     aux_rcvbuf = NULL;
     aux_rcv_remain = 0;
+    dma_aux_mcu_packet_received = FALSE;
 }
 
 void dma_custom_fs_init_transfer(Sercom* sercom, void* datap, uint16_t size){}
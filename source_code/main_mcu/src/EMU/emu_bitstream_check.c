@@ -0,0 +1,378 @@
+/*
+ * emu_bitstream_check.c
+ *
+ * Host side check of bitstream_bitmap_array_read() against the previous
+ * per pixel decoder: every bitmap and glyph of a graphics bundle is decoded
+ * row by row with both decoders, then random 1/2/4bpp and RLE streams are
+ * decoded with arbitrary read lengths.
+ * Build & run from the main_mcu folder: make -f Makefile.emu bitstream_check
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+/* Built as a single unit to reach the decoder static helpers */
+#include "custom_bitstream.c"
+#include "sh1122.h"
+
+/* Guard byte written after the decoded pixels */
+#define CHECK_GUARD_BYTE        0xA5
+/* Maximum number of pixels read at once */
+#define CHECK_MAX_NB_PIXELS     512
+/* Number of random streams to decode */
+#define CHECK_NB_RANDOM_STREAMS 20000
+/* Size of a random stream */
+#define CHECK_RANDOM_DATA_SIZE  1024
+
+/* Flash contents the bitstreams read from */
+static uint8_t* check_flash_data;
+static uint32_t check_flash_size;
+
+/* Number of decoded rows, skipped rows & bitmaps, mismatches */
+static uint32_t check_nb_rows;
+static uint32_t check_nb_mismatches;
+static uint32_t check_nb_skipped_rows;
+static uint32_t check_nb_skipped_bitmaps;
+
+
+/*! \fn     check_read_flash(uint8_t* datap, custom_fs_address_t address, uint32_t size)
+*   \brief  Read from the flash contents, 0xFF outside of them
+*   \param  datap       Where to store the data
+*   \param  address     Address to read from
+*   \param  size        Number of bytes to read
+*/
+static void check_read_flash(uint8_t* datap, custom_fs_address_t address, uint32_t size)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        datap[i] = ((address + i) < check_flash_size)? check_flash_data[address + i] : 0xFF;
+    }
+}
+
+/* Flash & DMA functions used by the bitstream decoder */
+RET_TYPE custom_fs_read_from_flash(uint8_t* datap, custom_fs_address_t address, uint32_t size)
+{
+    check_read_flash(datap, address, size);
+    return RETURN_OK;
+}
+RET_TYPE custom_fs_continuous_read_from_flash(uint8_t* datap, custom_fs_address_t address, uint32_t size, BOOL use_dma)
+{
+    check_read_flash(datap, address, size);
+    return RETURN_OK;
+}
+void custom_fs_stop_continuous_read_from_flash(BOOL was_using_emergency_bundle_data){}
+BOOL dma_custom_fs_check_and_clear_dma_transfer_flag(void){return TRUE;}
+
+/*! \fn     check_reference_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+*   \brief  Previous bitstream_bitmap_array_read() implementation, one pixel at a time
+*   \param  bs          Pointer to a bitmap bitstream structure
+*   \param  data        Pointer to where to store the data
+*   \param  nb_pixels   Number of pixels to be read (even for RLE bitstreams)
+*/
+static void check_reference_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
+{
+    if (bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG)
+    {
+        while (nb_pixels != 0)
+        {
+            if (bs->_bits == 0)
+            {
+                /* We have read all pixels of the same color */
+                uint8_t byte = bitstream_bitmap_get_next_byte(bs);
+                bs->_bits = (byte >> 4) + 1;
+                bs->_pixel = byte & 0x0F;
+            }
+
+            /* We have pixels of the same color to store */
+            *data = bs->_pixel << 4;
+            bs->_bits--;
+            nb_pixels--;
+
+            if (bs->_bits == 0)
+            {
+                /* We have read all pixels of the same color */
+                uint8_t byte = bitstream_bitmap_get_next_byte(bs);
+                bs->_bits = (byte >> 4) + 1;
+                bs->_pixel = byte & 0x0F;
+            }
+
+            /* We have pixels of the same color to store */
+            *data |= bs->_pixel;
+            bs->_bits--;
+            nb_pixels--;
+            data++;
+        }
+    }
+    else
+    {
+        while (nb_pixels != 0)
+        {
+            *data = 0;
+            for (uint16_t i = 0; (i < 2) && (nb_pixels-i) != 0; i++)
+            {
+                *data <<= 4;
+                if (bs->_bits == 0)
+                {
+                    /* We have processed all data inside _word */
+                    bs->_word = bitstream_bitmap_get_next_byte(bs);
+                    bs->_bits = 8;
+                }
+                if (bs->_bits >= bs->bitsPerPixel)
+                {
+                    /* Move pixel data from _word to data */
+                    bs->_bits -= bs->bitsPerPixel;
+                    *data |= (((bs->_word >> bs->_bits) & bs->mask) * 15) / bs->mask;
+                }
+                else
+                {
+                    /* Pixel depth not aligned with word */
+                    uint8_t offset = bs->bitsPerPixel - bs->_bits;
+                    *data |= (bs->_word << offset & bs->mask);
+                    bs->_bits += 8 - bs->bitsPerPixel;
+                    bs->_word = bitstream_bitmap_get_next_byte(bs);
+                    *data |= ((bs->_word >> bs->_bits) * 15) / bs->mask;
+                }
+            }
+            if (nb_pixels == 1)
+            {
+                *data <<= 4;
+                break;
+            }
+            nb_pixels-=2;
+            data++;
+        }
+    }
+}
+
+/*! \fn     check_compare_read(bitstream_bitmap_t* new_bs, bitstream_bitmap_t* ref_bs, uint16_t nb_pixels, const char* description, uint32_t row)
+*   \brief  Read pixels with both decoders and compare the outputs
+*   \param  new_bs      Bitstream used by the current decoder
+*   \param  ref_bs      Bitstream used by the reference decoder
+*   \param  nb_pixels   Number of pixels to read
+*   \param  description What is being decoded, for error messages
+*   \param  row         Row number, for error messages
+*   \return RETURN_OK if both outputs match
+*/
+static RET_TYPE check_compare_read(bitstream_bitmap_t* new_bs, bitstream_bitmap_t* ref_bs, uint16_t nb_pixels, const char* description, uint32_t row)
+{
+    uint8_t new_data[CHECK_MAX_NB_PIXELS/2 + 1];
+    uint8_t ref_data[CHECK_MAX_NB_PIXELS/2 + 1];
+    uint16_t nb_bytes = (nb_pixels + 1)/2;
+
+    /* The reference decoder doesn't support odd RLE reads */
+    if ((nb_pixels > CHECK_MAX_NB_PIXELS) || (((ref_bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0) && ((nb_pixels & 0x01) != 0)))
+    {
+        check_nb_skipped_rows++;
+        return RETURN_OK;
+    }
+
+    memset(new_data, CHECK_GUARD_BYTE, sizeof(new_data));
+    memset(ref_data, CHECK_GUARD_BYTE, sizeof(ref_data));
+    bitstream_bitmap_array_read(new_bs, new_data, nb_pixels);
+    check_reference_array_read(ref_bs, ref_data, nb_pixels);
+    check_nb_rows++;
+
+    if ((memcmp(new_data, ref_data, nb_bytes) != 0) || (new_data[nb_bytes] != CHECK_GUARD_BYTE))
+    {
+        if (check_nb_mismatches++ < 10)
+        {
+            printf("Mismatch: %s, row %u, %u pixels, %ubpp%s\n", description, (unsigned int)row, nb_pixels, ref_bs->bitsPerPixel, ((ref_bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0)? " RLE":"");
+        }
+        return RETURN_NOK;
+    }
+    return RETURN_OK;
+}
+
+/*! \fn     check_bundle_file_address(custom_fs_address_t table_offset, uint32_t file_id)
+*   \brief  Get the address of a file inside the bundle
+*   \param  table_offset    File address table offset
+*   \param  file_id         File index
+*   \return The file address
+*/
+static custom_fs_address_t check_bundle_file_address(custom_fs_address_t table_offset, uint32_t file_id)
+{
+    custom_fs_address_t address;
+    check_read_flash((uint8_t*)&address, CUSTOM_FS_FILES_ADDR_OFFSET + table_offset + file_id*sizeof(address), sizeof(address));
+    return address + CUSTOM_FS_FILES_ADDR_OFFSET;
+}
+
+/*! \fn     check_bundle_bitmaps(custom_file_flash_header_t* header)
+*   \brief  Decode all the bitmaps of the bundle row by row
+*   \param  header      Bundle header
+*   \return Number of decoded bitmaps
+*/
+static uint32_t check_bundle_bitmaps(custom_file_flash_header_t* header)
+{
+    uint32_t nb_bitmaps = 0;
+
+    for (uint32_t i = 0; (i < header->bitmap_file_count) && (header->bitmap_file_count != CUSTOM_FS_MAX_FILE_COUNT); i++)
+    {
+        custom_fs_address_t address = check_bundle_file_address(header->bitmap_file_offset, i);
+        bitstream_bitmap_t new_bs, ref_bs;
+        char description[32];
+        bitmap_t bitmap;
+
+        check_read_flash((uint8_t*)&bitmap, address, sizeof(bitmap));
+
+        /* Not a bitstream bitmap */
+        if ((bitmap.depth == 0) || (bitmap.depth > 8))
+        {
+            check_nb_skipped_bitmaps++;
+            continue;
+        }
+
+        snprintf(description, sizeof(description), "bitmap %u", (unsigned int)i);
+        bitstream_bitmap_init(&new_bs, &bitmap, address + sizeof(bitmap), FALSE);
+        bitstream_bitmap_init(&ref_bs, &bitmap, address + sizeof(bitmap), FALSE);
+        for (uint32_t row = 0; row < bitmap.height; row++)
+        {
+            if (check_compare_read(&new_bs, &ref_bs, bitmap.width, description, row) != RETURN_OK)
+            {
+                break;
+            }
+        }
+        bitstream_bitmap_close(&new_bs);
+        bitstream_bitmap_close(&ref_bs);
+        nb_bitmaps++;
+    }
+
+    return nb_bitmaps;
+}
+
+/*! \fn     check_bundle_glyphs(custom_file_flash_header_t* header)
+*   \brief  Decode all the glyphs of all the bundle fonts row by row
+*   \param  header      Bundle header
+*   \return Number of decoded glyphs
+*/
+static uint32_t check_bundle_glyphs(custom_file_flash_header_t* header)
+{
+    uint32_t nb_glyphs = 0;
+
+    for (uint32_t i = 0; (i < header->fonts_file_count) && (header->fonts_file_count != CUSTOM_FS_MAX_FILE_COUNT); i++)
+    {
+        custom_fs_address_t font_address = check_bundle_file_address(header->fonts_file_offset, i);
+        /* Header, unicode intervals, glyph indexes, glyph headers then glyph data: see sh1122_get_glyph_from_flash() */
+        custom_fs_address_t glyph_table_address = font_address + sizeof(font_header_t) + MEMBER_SIZE(sh1122_descriptor_t, current_unicode_inters);
+        font_header_t font_header;
+
+        check_read_flash((uint8_t*)&font_header, font_address, sizeof(font_header));
+        glyph_table_address += font_header.described_chr_count*sizeof(uint16_t);
+
+        for (uint32_t j = 0; j < font_header.chr_count; j++)
+        {
+            custom_fs_address_t glyph_data_address = glyph_table_address + font_header.chr_count*sizeof(font_glyph_t);
+            bitstream_bitmap_t new_bs, ref_bs;
+            char description[32];
+            font_glyph_t glyph;
+
+            check_read_flash((uint8_t*)&glyph, glyph_table_address + j*sizeof(font_glyph_t), sizeof(glyph));
+            if (glyph.xrect == 0)
+            {
+                continue;
+            }
+
+            snprintf(description, sizeof(description), "font %u glyph %u", (unsigned int)i, (unsigned int)j);
+            bitstream_glyph_bitmap_init(&new_bs, &font_header, &glyph, glyph_data_address + glyph.glyph_data_offset, FALSE);
+            bitstream_glyph_bitmap_init(&ref_bs, &font_header, &glyph, glyph_data_address + glyph.glyph_data_offset, FALSE);
+            for (uint32_t row = 0; row < glyph.yrect; row++)
+            {
+                if (check_compare_read(&new_bs, &ref_bs, glyph.xrect, description, row) != RETURN_OK)
+                {
+                    break;
+                }
+            }
+            bitstream_bitmap_close(&new_bs);
+            bitstream_bitmap_close(&ref_bs);
+            nb_glyphs++;
+        }
+    }
+
+    return nb_glyphs;
+}
+
+/*! \fn     check_random_streams(void)
+*   \brief  Decode random streams of random depths with random read lengths
+*/
+static void check_random_streams(void)
+{
+    static uint8_t random_data[CHECK_RANDOM_DATA_SIZE];
+    static const uint8_t depths[] = {1, 2, 4};
+
+    srand(0x4D50);
+    check_flash_data = random_data;
+    check_flash_size = sizeof(random_data);
+
+    for (uint32_t i = 0; i < CHECK_NB_RANDOM_STREAMS; i++)
+    {
+        bitstream_bitmap_t new_bs, ref_bs;
+        bitmap_t bitmap;
+
+        for (uint32_t j = 0; j < sizeof(random_data); j++)
+        {
+            random_data[j] = (uint8_t)rand();
+        }
+        bitmap.depth = depths[rand() % sizeof(depths)];
+        bitmap.flags = ((rand() & 0x01) != 0)? CUSTOM_FS_BITMAP_RLE_FLAG : 0;
+        bitmap.width = GUI_DISPLAY_WIDTH;
+        bitmap.height = 64;
+        bitmap.dataSize = (uint16_t)(rand() % sizeof(random_data));
+
+        bitstream_bitmap_init(&new_bs, &bitmap, 0, FALSE);
+        bitstream_bitmap_init(&ref_bs, &bitmap, 0, FALSE);
+        for (uint32_t row = 0; row < bitmap.height; row++)
+        {
+            uint16_t nb_pixels = (uint16_t)(rand() % (CHECK_MAX_NB_PIXELS + 1));
+
+            /* RLE reads have to be even for the reference decoder */
+            if ((bitmap.flags & CUSTOM_FS_BITMAP_RLE_FLAG) != 0)
+            {
+                nb_pixels &= ~0x01;
+            }
+            if (check_compare_read(&new_bs, &ref_bs, nb_pixels, "random stream", row) != RETURN_OK)
+            {
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* bundle_path = (argc > 1)? argv[1] : "emu_assets/miniblebundle.img";
+    custom_file_flash_header_t header;
+    uint32_t nb_bitmaps, nb_glyphs;
+    FILE* bundle_file;
+    long bundle_size;
+
+    /* Load the bundle */
+    bundle_file = fopen(bundle_path, "rb");
+    if (bundle_file == 0)
+    {
+        printf("Couldn't open %s\n", bundle_path);
+        return 1;
+    }
+    fseek(bundle_file, 0, SEEK_END);
+    bundle_size = ftell(bundle_file);
+    fseek(bundle_file, 0, SEEK_SET);
+    check_flash_data = (uint8_t*)malloc(bundle_size);
+    if ((check_flash_data == 0) || (fread(check_flash_data, 1, bundle_size, bundle_file) != (size_t)bundle_size))
+    {
+        printf("Couldn't read %s\n", bundle_path);
+        fclose(bundle_file);
+        return 1;
+    }
+    check_flash_size = (uint32_t)bundle_size;
+    fclose(bundle_file);
+
+    /* Bundle contents */
+    check_read_flash((uint8_t*)&header, CUSTOM_FS_FILES_ADDR_OFFSET, sizeof(header));
+    nb_bitmaps = check_bundle_bitmaps(&header);
+    nb_glyphs = check_bundle_glyphs(&header);
+    printf("%s: %u bitmaps (%u skipped), %u glyphs\n", bundle_path, (unsigned int)nb_bitmaps, (unsigned int)check_nb_skipped_bitmaps, (unsigned int)nb_glyphs);
+    free(check_flash_data);
+
+    /* Random streams */
+    check_random_streams();
+    printf("%u rows compared, %u skipped, %u mismatches\n", (unsigned int)check_nb_rows, (unsigned int)check_nb_skipped_rows, (unsigned int)check_nb_mismatches);
+
+    return (check_nb_mismatches == 0)? 0:1;
+}
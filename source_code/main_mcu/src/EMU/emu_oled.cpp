@@ -17,12 +17,30 @@ extern "C" {
 #include <QThread>
 #include <QTimer>
 
-#define FB_WIDTH (256)
-#define FB_HEIGHT (64)
+#define FB_WIDTH EMU_OLED_FB_WIDTH
+#define FB_HEIGHT EMU_OLED_FB_HEIGHT
 
 /// grayscale 8-bit
 static uint8_t oled_fb[FB_WIDTH * FB_HEIGHT];
 static int oled_col, oled_row;
+static bool oled_fb_dirty = false;
+
+/// the two grayscale pixels of each data byte, high nibble first
+static struct oled_byte_pixels_t {
+    uint8_t px[256][2];
+
+    oled_byte_pixels_t() {
+        for(int i = 0; i < 256; i++) {
+            px[i][0] = i & 0xf0;
+            px[i][1] = (i & 0x0f) << 4;
+        }
+    }
+} oled_byte_pixels;
+
+const uint8_t *emu_oled_get_framebuffer(void)
+{
+    return oled_fb;
+}
 
 void emu_oled_byte(uint8_t data)
 {
@@ -52,10 +70,12 @@ void emu_oled_byte(uint8_t data)
                 cmdargs = 1;
                 break;
             case SH1122_CMD_SET_DISPLAY_ON:
-                postToObject([]() { oled->set_display_on(true); }, oled);
+                if(oled)
+                    postToObject([]() { oled->set_display_on(true); }, oled);
                 break;
             case SH1122_CMD_SET_DISPLAY_OFF:
-                postToObject([]() { oled->set_display_on(false); }, oled);
+                if(oled)
+                    postToObject([]() { oled->set_display_on(false); }, oled);
                 break;
             }
 
@@ -71,10 +91,29 @@ void emu_oled_byte(uint8_t data)
     } else {
         // data byte
         //printf("Oled DATA @%d,%d: %02x\n", oled_col, oled_row, data);
-        oled_fb[FB_WIDTH * oled_row + oled_col*2] = data & 0xf0;
-        oled_fb[FB_WIDTH * oled_row + oled_col*2 + 1] = (data & 0x0f) << 4;
-        
-        if(oled_col == SH1122_OLED_Max_Column) {
+        emu_oled_data(&data, 1);
+    }
+}
+
+/* Data bytes written in a row, as sent by a DMA transfer */
+void emu_oled_data(const uint8_t *data, int size)
+{
+    while(size > 0) {
+        // expand the bytes up to the end of the current row at once
+        int count = qMin(size, SH1122_OLED_Max_Column + 1 - oled_col);
+        if(count > 0) {
+            uint8_t *optr = &oled_fb[FB_WIDTH * oled_row + oled_col*2];
+            for(int i = 0; i < count; i++) {
+                memcpy(optr, oled_byte_pixels.px[data[i]], 2);
+                optr += 2;
+            }
+
+            data += count;
+            size -= count;
+            oled_col += count;
+        }
+
+        if(oled_col > SH1122_OLED_Max_Column) {
             if(oled_row == SH1122_OLED_Max_Row) {
                 oled_row = 0;
 
@@ -82,10 +121,10 @@ void emu_oled_byte(uint8_t data)
                 oled_row++;
             }
             oled_col = 0;
-        } else {
-            oled_col++;
         }
     }
+
+    oled_fb_dirty = true;
 }
 
 static QMutex fb_update;
@@ -95,6 +134,12 @@ static int fb_next=0, fb_pending=-1;
 void emu_oled_flush(void)
 {
     emu_appexit_test();
+
+    // headless or nothing drawn since last time: nothing to repaint
+    if(!oled || !oled_fb_dirty)
+        return;
+
+    oled_fb_dirty = false;
     fb_update.lock();
     if(fb_pending >= 0) {
         // an update is queued, just replace the contents
@@ -120,7 +165,7 @@ void emu_oled_flush(void)
     fb_update.unlock();
 }
 
-OLEDWidget::OLEDWidget(): display(256, 64, QImage::Format_RGB888) {
+OLEDWidget::OLEDWidget(): display(256, 64, QImage::Format_Grayscale8) {
     setMinimumSize(display.size());
     setMaximumSize(display.size());
 }
@@ -132,20 +177,16 @@ OLEDWidget::~OLEDWidget() {
 }
 
 void OLEDWidget::update_display(const uint8_t *fb) {
-    uint8_t *optr = display.bits();
-
     for(int y=0;y<64;y++)
-        for(int x=0;x<256;x++) {
-            optr[0] = optr[1] = optr[2] = *fb++;
-            optr+=3;
-        }
-   
-    repaint();
+        memcpy(display.scanLine(y), fb + y*256, 256);
+
+    // let Qt merge this with other pending paint events
+    update();
 }
 
 void OLEDWidget::set_display_on(bool on) {
     display_on = on;
-    repaint();
+    update();
 }
 
 void OLEDWidget::paintEvent(QPaintEvent *) {
@@ -172,6 +213,16 @@ static void set_emulated_wheel_state(bool state, int16_t nb_ms_press_override)
     }
 }
 
+void emu_oled_set_wheel_state(bool pressed, int16_t nb_ms_press_override)
+{
+    set_emulated_wheel_state(pressed, nb_ms_press_override);
+}
+
+void emu_oled_turn_wheel(int16_t increment)
+{
+    inputs_wheel_cur_increment += increment;
+}
+
 extern "C" void inputs_scan(void);
 
 extern "C" void inputs_scan(void)
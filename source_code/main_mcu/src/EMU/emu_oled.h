@@ -2,6 +2,9 @@
 #define _EMU_OLED_H
 #include <inttypes.h>
 
+#define EMU_OLED_FB_WIDTH   (256)
+#define EMU_OLED_FB_HEIGHT  (64)
+
 #ifdef __cplusplus
 
 #include <QWidget>
@@ -26,10 +29,18 @@ protected:
     virtual void keyReleaseEvent(QKeyEvent *evt);
 };
 
+// to be called with the irq mutex held
+void emu_oled_set_wheel_state(bool pressed, int16_t nb_ms_press_override);
+void emu_oled_turn_wheel(int16_t increment);
+
+/// grayscale 8-bit, EMU_OLED_FB_WIDTH x EMU_OLED_FB_HEIGHT
+const uint8_t *emu_oled_get_framebuffer(void);
+
 extern "C" {
 #endif
 
 void emu_oled_byte(uint8_t data);
+void emu_oled_data(const uint8_t *data, int size);
 void emu_oled_flush(void);
 
 #ifdef __cplusplus
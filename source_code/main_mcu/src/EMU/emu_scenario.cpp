@@ -0,0 +1,241 @@
+#include "emu_scenario.h"
+#include "emulator.h"
+#include "emu_oled.h"
+#include "emu_smartcard.h"
+#include "qt_metacall_helper.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QVector>
+
+// how long the wheel is held for a (long) click
+#define SCENARIO_CLICK_MS       50
+
+enum scenario_cmd_t {
+    SCN_WHEEL, SCN_PRESS, SCN_LONG_PRESS, SCN_RELEASE,
+    SCN_CARD_INSERT, SCN_CARD_NEW, SCN_CARD_REMOVE,
+    SCN_HID, SCN_BATTERY, SCN_USB,
+    SCN_FB_HASH, SCN_FB_EXPECT, SCN_FB_DUMP, SCN_QUIT
+};
+
+struct scenario_step_t {
+    uint64_t time_ms;
+    scenario_cmd_t cmd;
+    int value;
+    QString arg;
+    QByteArray data;
+};
+
+static QVector<scenario_step_t> steps;
+static int next_step = 0;
+static int nb_failures = 0;
+static bool scenario_loaded = false;
+
+static bool emu_scenario_add_step(uint64_t time_ms, const QString & cmd, const QStringList & args)
+{
+    scenario_step_t step;
+    step.time_ms = time_ms;
+    step.value = 0;
+    bool ok = true;
+
+    if(cmd == "wheel" && args.size() == 1) {
+        step.cmd = SCN_WHEEL;
+        step.value = args[0].toInt(&ok);
+    } else if(cmd == "press" && args.isEmpty()) {
+        step.cmd = SCN_PRESS;
+    } else if(cmd == "release" && args.isEmpty()) {
+        step.cmd = SCN_RELEASE;
+    } else if((cmd == "click" || cmd == "long_click") && args.isEmpty()) {
+        step.cmd = cmd == "click" ? SCN_PRESS : SCN_LONG_PRESS;
+        steps.append(step);
+        step.time_ms += SCENARIO_CLICK_MS;
+        step.cmd = SCN_RELEASE;
+    } else if(cmd == "card_insert" && args.size() == 1) {
+        step.cmd = SCN_CARD_INSERT;
+        step.arg = args[0];
+    } else if(cmd == "card_new" && args.size() == 1) {
+        step.cmd = SCN_CARD_NEW;
+        step.arg = args[0];
+    } else if(cmd == "card_remove" && args.isEmpty()) {
+        step.cmd = SCN_CARD_REMOVE;
+    } else if(cmd == "hid" && !args.isEmpty()) {
+        step.cmd = SCN_HID;
+        step.data = QByteArray::fromHex(args.join("").toLatin1());
+        ok = !step.data.isEmpty();
+    } else if(cmd == "battery" && args.size() == 1) {
+        step.cmd = SCN_BATTERY;
+        step.value = args[0].toInt(&ok);
+    } else if(cmd == "usb" && args.size() == 1) {
+        step.cmd = SCN_USB;
+        step.value = args[0].toInt(&ok);
+    } else if(cmd == "fb_hash" && args.size() <= 1) {
+        step.cmd = SCN_FB_HASH;
+        step.arg = args.value(0);
+    } else if(cmd == "fb_expect" && args.size() == 1) {
+        step.cmd = SCN_FB_EXPECT;
+        step.arg = args[0].toLower();
+    } else if(cmd == "fb_dump" && args.size() == 1) {
+        step.cmd = SCN_FB_DUMP;
+        step.arg = args[0];
+    } else if(cmd == "quit" && args.isEmpty()) {
+        step.cmd = SCN_QUIT;
+    } else {
+        return false;
+    }
+
+    if(ok)
+        steps.append(step);
+
+    return ok;
+}
+
+bool emu_scenario_load(QString filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        fprintf(stderr, "Failed to open scenario %s\n", filePath.toUtf8().constData());
+        return false;
+    }
+
+    QTextStream in(&file);
+    int line_number = 0;
+    while(!in.atEnd()) {
+        QString line = in.readLine().trimmed();
+        line_number++;
+        if(line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        QStringList fields = line.split(' ', Qt::SkipEmptyParts);
+        bool ok = fields.size() >= 2;
+        uint64_t time_ms = ok ? fields[0].toULongLong(&ok) : 0;
+        if(ok)
+            ok = emu_scenario_add_step(time_ms, fields[1], fields.mid(2));
+
+        if(!ok) {
+            fprintf(stderr, "Invalid scenario line %d: %s\n", line_number, line.toUtf8().constData());
+            return false;
+        }
+    }
+
+    // steps are run in time order, keeping the script order for equal times
+    std::stable_sort(steps.begin(), steps.end(), [](const scenario_step_t & a, const scenario_step_t & b) {
+        return a.time_ms < b.time_ms;
+    });
+
+    scenario_loaded = true;
+    return true;
+}
+
+static QString emu_scenario_fb_hash(void)
+{
+    // 64-bit FNV-1a
+    const uint8_t *fb = emu_oled_get_framebuffer();
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for(int i = 0; i < EMU_OLED_FB_WIDTH * EMU_OLED_FB_HEIGHT; i++) {
+        hash ^= fb[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return QString("%1").arg(hash, 16, 16, QChar('0'));
+}
+
+static bool emu_scenario_fb_dump(const QString & filePath)
+{
+    QFile file(filePath);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(QString("P5\n%1 %2\n255\n").arg(EMU_OLED_FB_WIDTH).arg(EMU_OLED_FB_HEIGHT).toLatin1());
+    file.write((const char*)emu_oled_get_framebuffer(), EMU_OLED_FB_WIDTH * EMU_OLED_FB_HEIGHT);
+    return true;
+}
+
+/* Called with the irq mutex held, from the emulated ms tick */
+void emu_scenario_tick(uint64_t now_ms)
+{
+    while(next_step < steps.size() && steps[next_step].time_ms <= now_ms) {
+        const scenario_step_t & step = steps[next_step];
+
+        // the firmware thread may be the one holding the card: retry on next tick
+        if((step.cmd == SCN_CARD_INSERT || step.cmd == SCN_CARD_NEW || step.cmd == SCN_CARD_REMOVE) && emu_is_smartcard_opened())
+            return;
+
+        next_step++;
+
+        switch(step.cmd) {
+        case SCN_WHEEL:
+            emu_oled_turn_wheel(step.value);
+            break;
+        case SCN_PRESS:
+            emu_oled_set_wheel_state(true, -1);
+            break;
+        case SCN_LONG_PRESS:
+            emu_oled_set_wheel_state(true, 3000);
+            break;
+        case SCN_RELEASE:
+            emu_oled_set_wheel_state(false, -1);
+            break;
+        case SCN_CARD_INSERT:
+            if(!emu_insert_smartcard(step.arg)) {
+                printf("[%llu] card_insert %s: failed\n", (unsigned long long)now_ms, step.arg.toUtf8().constData());
+                nb_failures++;
+            }
+            break;
+        case SCN_CARD_NEW:
+            if(!emu_insert_new_smartcard(step.arg)) {
+                printf("[%llu] card_new %s: failed\n", (unsigned long long)now_ms, step.arg.toUtf8().constData());
+                nb_failures++;
+            }
+            break;
+        case SCN_CARD_REMOVE:
+            emu_remove_smartcard();
+            break;
+        case SCN_HID:
+            emu_inject_hid(step.data.constData(), step.data.size());
+            break;
+        case SCN_BATTERY:
+            emu_set_battery_level(step.value);
+            break;
+        case SCN_USB:
+            emu_set_usb_powered(step.value != 0 ? TRUE : FALSE);
+            break;
+        case SCN_FB_HASH:
+            printf("[%llu] fb_hash %s %s\n", (unsigned long long)now_ms, emu_scenario_fb_hash().toLatin1().constData(), step.arg.toUtf8().constData());
+            break;
+        case SCN_FB_EXPECT: {
+            QString hash = emu_scenario_fb_hash();
+            bool match = hash == step.arg;
+            printf("[%llu] fb_expect %s: %s\n", (unsigned long long)now_ms, step.arg.toLatin1().constData(), match ? "ok" : qPrintable("FAILED, got " + hash));
+            if(!match)
+                nb_failures++;
+            break;
+        }
+        case SCN_FB_DUMP:
+            if(!emu_scenario_fb_dump(step.arg)) {
+                printf("[%llu] fb_dump %s: failed\n", (unsigned long long)now_ms, step.arg.toUtf8().constData());
+                nb_failures++;
+            }
+            break;
+        case SCN_QUIT: {
+            int exit_code = nb_failures > 0 ? 1 : 0;
+            printf("[%llu] quit, %d failure(s)\n", (unsigned long long)now_ms, nb_failures);
+            postToObject([exit_code]() { QCoreApplication::exit(exit_code); }, qApp);
+            break;
+        }
+        }
+        fflush(stdout);
+    }
+}
+
+void emu_scenario_hid_sent(const char *data, int size)
+{
+    if(!scenario_loaded)
+        return;
+
+    printf("hid> %s\n", QByteArray(data, size).toHex().constData());
+    fflush(stdout);
+}
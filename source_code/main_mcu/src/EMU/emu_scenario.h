@@ -0,0 +1,39 @@
+#ifndef EMU_SCENARIO_H
+#define EMU_SCENARIO_H
+#include <inttypes.h>
+
+#ifdef __cplusplus
+#include <QString>
+
+/*
+ * Scenario scripts: one step per line, "<time_ms> <command> [args]",
+ * time being the emulated ms since start. Empty lines and lines
+ * starting with '#' are ignored. Commands:
+ *   wheel <n>                turn the wheel by n detents (positive = down)
+ *   press / release          press or release the wheel
+ *   click / long_click       press and release the wheel
+ *   card_insert <file>       insert an existing smartcard file
+ *   card_new <file>          insert a blank smartcard, stored in file
+ *   card_remove              remove the smartcard
+ *   hid <hex bytes>          inject raw packet bytes as if sent by moolticute
+ *   battery <percent>        set the battery level
+ *   usb <0|1>                set the USB power state
+ *   fb_hash [label]          print a hash of the OLED frame buffer
+ *   fb_expect <hash>         check the OLED frame buffer hash
+ *   fb_dump <file>           dump the OLED frame buffer as a PGM image
+ *   quit                     exit the emulator, non-zero code if a check failed
+ * See scenarios/new_user_unlock.txt for an example.
+ */
+bool emu_scenario_load(QString filePath);
+
+extern "C" {
+#endif
+
+void emu_scenario_tick(uint64_t now_ms);
+void emu_scenario_hid_sent(const char *data, int size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
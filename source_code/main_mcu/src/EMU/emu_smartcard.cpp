@@ -7,12 +7,14 @@
 static QMutex smc_mutex;
 static emu_smartcard_t card;
 static bool card_present = false;
+static volatile bool card_opened = false;
 static QFile smartcardFile;
 
 struct emu_smartcard_t *emu_open_smartcard()
 {
     smc_mutex.lock();
     if(card_present) {
+        card_opened = true;
         return &card;
 
     } else {
@@ -28,6 +30,7 @@ void emu_close_smartcard(BOOL written)
         smartcardFile.write((char*)&card, sizeof(card));
         smartcardFile.flush();
     }
+    card_opened = false;
     smc_mutex.unlock();
 }
 
@@ -86,3 +89,8 @@ bool emu_is_smartcard_inserted()
 {
     return card_present;
 }
+
+bool emu_is_smartcard_opened()
+{
+    return card_opened;
+}
@@ -34,6 +34,7 @@ bool emu_insert_smartcard(QString filePath);
 bool emu_insert_new_smartcard(QString filePath, int smartcard_type = EMU_SMARTCARD_REGULAR);
 void emu_remove_smartcard();
 bool emu_is_smartcard_inserted();
+bool emu_is_smartcard_opened();
 
 
 }
@@ -1,57 +1,119 @@
 #include "emu_storage.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <QDebug>
 #include <QFile>
+#include <QMutex>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
-static QFile eeprom("eeprom.bin");
-static QFile dbflash("dbflash.bin");
-static bool emu_open_flash(QFile & flashFile)
+/* Emulated flash: file memory-mapped at its full size */
+struct emu_flash_t {
+    QFile file;
+    uint8_t *map;
+    int size;
+    bool dirty;
+
+    emu_flash_t(const char *name): file(name), map(nullptr), size(0), dirty(false) {}
+};
+
+static emu_flash_t eeprom("eeprom.bin");
+static emu_flash_t dbflash("dbflash.bin");
+static int storage_sync_mode = EMU_STORAGE_SYNC_ON_REQUEST;
+static QMutex storage_sync_mutex;
+
+static BOOL emu_open_flash(emu_flash_t & flash, int size)
 {
-    if(!flashFile.open(QIODevice::ReadWrite)) {
-        qWarning() << "Failed to open emulated flash" << flashFile.fileName();
+    if(!flash.file.open(QIODevice::ReadWrite)) {
+        qWarning() << "Failed to open emulated flash" << flash.file.fileName();
+        abort();
+    }
+
+    BOOL existed = flash.file.size() > 0 ? TRUE : FALSE;
+
+    // extend the file once to its full size, erased flash reads as 0xff
+    if(flash.file.size() < size) {
+        flash.file.seek(flash.file.size());
+        flash.file.write(QByteArray(size - flash.file.size(), '\xff'));
+        flash.file.flush();
+    }
+
+    flash.size = flash.file.size();
+    flash.map = flash.file.map(0, flash.size);
+    if(!flash.map) {
+        qWarning() << "Failed to map emulated flash" << flash.file.fileName() << flash.file.errorString();
         abort();
     }
 
-    return flashFile.size() > 0;
+    return existed;
 }
 
-static void emu_extend_flash(QFile & flashFile, int size)
+static void emu_sync_flash(emu_flash_t & flash)
 {
-    if(flashFile.size() < size) {
-        flashFile.seek(flashFile.size());
-        int extend_size = size - flashFile.size();
-        flashFile.write(QByteArray(extend_size, '\xff'));
-    }
-    
-    flashFile.flush();
+    if(!flash.map || !flash.dirty)
+        return;
+
+    flash.dirty = false;
+#ifdef Q_OS_WIN
+    FlushViewOfFile(flash.map, flash.size);
+#else
+    msync(flash.map, flash.size, MS_SYNC);
+#endif
 }
 
-static void emu_flash_read(QFile & flashFile, int offset, uint8_t *buf, int length) 
+static void emu_flash_read(emu_flash_t & flash, int offset, uint8_t *buf, int length)
 {
-    if(flashFile.isOpen()) {
-        emu_extend_flash(flashFile, offset+length);
-        flashFile.seek(offset);
-        flashFile.read((char*)buf, length);
+    int available = 0;
+    if(flash.map && offset >= 0 && offset < flash.size)
+        available = qMin(length, flash.size - offset);
 
-    } else {
-        memset(buf, 0xff, length);
-    }
+    if(available > 0)
+        memcpy(buf, flash.map + offset, available);
+
+    if(available < length)
+        memset(buf + qMax(available, 0), 0xff, length - qMax(available, 0));
 }
 
-static void emu_flash_write(QFile & flashFile, int offset, uint8_t *buf, int length)
+static void emu_flash_write(emu_flash_t & flash, int offset, uint8_t *buf, int length)
 {
-    if(flashFile.isOpen()) {
-        emu_extend_flash(flashFile, offset+length);
-        flashFile.seek(offset);
-        flashFile.write((char*)buf, length);
-        flashFile.flush();
+    if(!flash.map)
+        return;
+
+    if(offset < 0 || length > flash.size - offset) {
+        qWarning() << "Out of bounds write to emulated flash" << flash.file.fileName() << offset << length;
+        return;
+    }
+
+    memcpy(flash.map + offset, buf, length);
+    flash.dirty = true;
+
+    if(storage_sync_mode == EMU_STORAGE_SYNC_ON_WRITE) {
+        storage_sync_mutex.lock();
+        emu_sync_flash(flash);
+        storage_sync_mutex.unlock();
     }
 }
 
-BOOL emu_eeprom_open()
+void emu_storage_set_sync_mode(int mode)
+{
+    storage_sync_mode = mode;
+}
+
+void emu_storage_sync(void)
+{
+    storage_sync_mutex.lock();
+    emu_sync_flash(eeprom);
+    emu_sync_flash(dbflash);
+    storage_sync_mutex.unlock();
+}
+
+BOOL emu_eeprom_open(int size)
 {
-    return emu_open_flash(eeprom);
+    return emu_open_flash(eeprom, size);
 }
 
 void emu_eeprom_read(int offset, uint8_t *buf, int length)
@@ -64,9 +126,9 @@ void emu_eeprom_write(int offset, uint8_t *buf, int length)
     return emu_flash_write(eeprom, offset, buf, length);
 }
 
-BOOL emu_dbflash_open()
+BOOL emu_dbflash_open(int size)
 {
-    return emu_open_flash(dbflash);
+    return emu_open_flash(dbflash, size);
 }
 
 void emu_dbflash_read(int offset, uint8_t *buf, int length)
@@ -78,4 +140,3 @@ void emu_dbflash_write(int offset, uint8_t *buf, int length)
 {
     return emu_flash_write(dbflash, offset, buf, length);
 }
-
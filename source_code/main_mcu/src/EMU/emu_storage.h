@@ -3,15 +3,23 @@
 #include <inttypes.h>
 #include "defines.h"
 
+/* Storage durability modes: when mapped flash contents are synced to disk */
+#define EMU_STORAGE_SYNC_ON_REQUEST     0   // on MMM exit and emulator shutdown
+#define EMU_STORAGE_SYNC_ON_WRITE       1   // after every write
+#define EMU_STORAGE_SYNC_PERIODIC       2   // every N ms, plus on request
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-BOOL emu_eeprom_open(void);
+void emu_storage_set_sync_mode(int mode);
+void emu_storage_sync(void);
+
+BOOL emu_eeprom_open(int size);
 void emu_eeprom_read(int offset, uint8_t *buf, int length);
 void emu_eeprom_write(int offset, uint8_t *buf, int length);
 
-BOOL emu_dbflash_open(void);
+BOOL emu_dbflash_open(int size);
 void emu_dbflash_read(int offset, uint8_t *buf, int length);
 void emu_dbflash_write(int offset, uint8_t *buf, int length);
 
@@ -7,6 +7,8 @@ extern "C" {
 }
 
 #include <QApplication>
+#include <QCoreApplication>
+#include <QScopedPointer>
 #include <QThread>
 #include <QTimer>
 #include <QWidget>
@@ -16,10 +18,14 @@ extern "C" {
 #include <QLocalSocket>
 #include <QCommandLineParser>
 #include <QElapsedTimer>
+#include <string.h>
+#include <unistd.h>
 
 #include "emu_oled.h"
 #include "emu_smartcard.h"
 #include "emu_dataflash.h"
+#include "emu_storage.h"
+#include "emu_scenario.h"
 #include "emulator_ui.h"
 
 static struct emu_port_t _PORT;
@@ -37,9 +43,17 @@ void cpu_irq_leave_critical(void)
     irq_mutex.unlock();
 }
 
-static void pseudo_irq(void)
+/* Headless mode: no GUI, time only moves when the firmware or a test driver advances it */
+static bool headless = false;
+static QMutex virtual_time_mutex;
+static uint64_t virtual_time_ms;
+static uint32_t virtual_time_pending_us;
+
+static void pseudo_irq_locked(void)
 {
-    irq_mutex.lock();
+    /* Scripted inputs due now */
+    emu_scenario_tick(virtual_time_ms);
+
     timer_ms_tick();
 
     /* Scan buttons */
@@ -48,9 +62,55 @@ static void pseudo_irq(void)
     /* Power logic */
     logic_power_ms_tick();
 
+    virtual_time_mutex.lock();
+    virtual_time_ms++;
+    virtual_time_mutex.unlock();
+}
+
+static void pseudo_irq(void)
+{
+    irq_mutex.lock();
+    pseudo_irq_locked();
     irq_mutex.unlock();
 }
 
+BOOL emu_is_headless(void)
+{
+    return headless ? TRUE : FALSE;
+}
+
+void emu_advance_virtual_time(uint32_t ms)
+{
+    while(ms--)
+        pseudo_irq();
+}
+
+void emu_virtual_time_poll(void)
+{
+    if(!headless)
+        return;
+
+    // firmware polling a timer: let 1ms go by, unless it is inside a critical section
+    if(irq_mutex.tryLock()) {
+        pseudo_irq_locked();
+        irq_mutex.unlock();
+    }
+}
+
+void emu_delay_us(uint32_t us)
+{
+    if(!headless) {
+        usleep(us);
+        return;
+    }
+
+    virtual_time_pending_us += us;
+    while(virtual_time_pending_us >= 1000) {
+        virtual_time_pending_us -= 1000;
+        emu_virtual_time_poll();
+    }
+}
+
 extern "C" void minible_main();
 
 class AppThread: public QThread {
@@ -61,6 +121,9 @@ private:
 
     QLocalSocket *hid;
 
+    QMutex injected_hid_mutex;
+    QByteArray injected_hid;
+
     bool reconnect_hid() {
         if(hid->state() != QLocalSocket::ConnectedState) {
             hid->connectToServer("moolticuted_local_dev");
@@ -111,8 +174,26 @@ public:
         }
     }
 
+    void inject_hid(const char *data, int size) {
+        injected_hid_mutex.lock();
+        injected_hid.append(data, size);
+        injected_hid_mutex.unlock();
+    }
+
     int rcv_hid(char *data, int size) {
         test_stop();
+
+        // scripted packets first, they don't need moolticute
+        injected_hid_mutex.lock();
+        int injected = qMin(size, injected_hid.size());
+        if(injected > 0) {
+            memcpy(data, injected_hid.constData(), injected);
+            injected_hid.remove(0, injected);
+        }
+        injected_hid_mutex.unlock();
+        if(injected > 0)
+            return injected;
+
         if(!reconnect_hid())
             return -1;
 
@@ -132,9 +213,15 @@ OLEDWidget *oled;
 
 void emu_send_hid(char *data, int size)
 {
+    emu_scenario_hid_sent(data, size);
     app_thread.send_hid(data, size);
 }
 
+void emu_inject_hid(const char *data, int size)
+{
+    app_thread.inject_hid(data, size);
+}
+
 int emu_rcv_hid(char *data, int size)
 {
     return app_thread.rcv_hid(data, size);
@@ -146,9 +233,19 @@ static uint64_t last_systick;
 
 BOOL emu_get_systick(uint32_t *value)
 {
+    uint64_t elapsed_ms;
+    if(headless) {
+        emu_virtual_time_poll();
+        virtual_time_mutex.lock();
+        elapsed_ms = virtual_time_ms;
+        virtual_time_mutex.unlock();
+    } else {
+        elapsed_ms = systick_timer.elapsed();
+    }
+
     systick_mutex.lock();
     // milliseconds to 48MHz ticks
-    uint64_t systick = systick_timer.elapsed() * (uint64_t)48000;
+    uint64_t systick = elapsed_ms * (uint64_t)48000;
     BOOL wrapped = FALSE;
     if((systick & 0xffffff) != (last_systick & 0xffffff))
         wrapped = TRUE;
@@ -165,7 +262,12 @@ int main(int ac, char ** av)
     // Qt needs to run on the main thread. We run the application code on a separate thread
     // (1) to ensure responsiveness when the main code blocks
     // (2) to have our input behave in an interrupt-like manner
-    QApplication app(ac, av);
+    // In headless mode no widget is created, so we don't need a display either
+    for(int i = 1; i < ac; i++)
+        if(!strcmp(av[i], "--headless"))
+            headless = true;
+
+    QScopedPointer<QCoreApplication> app(headless ? new QCoreApplication(ac, av) : new QApplication(ac, av));
 
     // ensure that the calendar works in UTC, so that time doesn't shift unpredictably
     qputenv("TZ", "");
@@ -177,11 +279,31 @@ int main(int ac, char ** av)
 
     parser.addOption(QCommandLineOption("smartcard", "Smartcard file to be used at startup", "smartcard"));
     parser.addOption(QCommandLineOption("bundle", "Specify path to bundle.img file", "bundle"));
-    parser.process(app);
+    parser.addOption(QCommandLineOption("headless", "Run without GUI, on a virtual clock advanced by the firmware"));
+    parser.addOption(QCommandLineOption("scenario", "Scenario script to replay (see emu_scenario.h)", "scenario"));
+    parser.addOption(QCommandLineOption("storage-sync", "When to sync emulated flash to disk: 'request' (MMM exit / shutdown, default), 'write' or a period in ms", "mode"));
+    parser.process(*app);
+
+    if(parser.isSet("scenario") && !emu_scenario_load(parser.value("scenario")))
+        return 1;
+
+    QTimer storage_sync_timer;
+    QString storage_sync = parser.value("storage-sync");
+    if(storage_sync == "write")
+        emu_storage_set_sync_mode(EMU_STORAGE_SYNC_ON_WRITE);
+    else if(storage_sync.toInt() > 0) {
+        emu_storage_set_sync_mode(EMU_STORAGE_SYNC_PERIODIC);
+        storage_sync_timer.setInterval(storage_sync.toInt());
+        storage_sync_timer.start();
+        QObject::connect(&storage_sync_timer, &QTimer::timeout, [] () {
+            emu_storage_sync();
+        });
+    }
 
     QTimer ms_timer;
     ms_timer.setInterval(1);
-    ms_timer.start();
+    if(!headless)
+        ms_timer.start();
 
     QObject::connect(&ms_timer, &QTimer::timeout, [] () {
         if (true)
@@ -198,23 +320,28 @@ int main(int ac, char ** av)
         }
     });
 
-    oled = new OLEDWidget;
+    if(!headless)
+        oled = new OLEDWidget;
 
     if(parser.isSet("smartcard"))
         emu_insert_smartcard(parser.value("smartcard"));
 
     emu_dataflash_init(parser.value("bundle").toUtf8().constData());
 
-    EmuWindow emu_window;
-    emu_window.show();
+    QScopedPointer<EmuWindow> emu_window;
+    if(!headless) {
+        emu_window.reset(new EmuWindow);
+        emu_window->show();
+        oled->show();
+    }
 
-    oled->show();
     app_thread.start();
 
-    app.exec();
+    int exit_code = app->exec();
 
     app_thread.stop();
+    emu_storage_sync();
 
     delete oled;
-    return 0;
+    return exit_code;
 }
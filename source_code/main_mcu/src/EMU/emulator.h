@@ -17,13 +17,21 @@ extern "C" {
 void emu_appexit_test(void);
 void emu_send_hid(char *data, int size);
 int emu_rcv_hid(char *data, int size);
+void emu_inject_hid(const char *data, int size);
 
 int emu_get_battery_level(void);
 BOOL emu_get_usb_charging(void);
 void emu_charger_enable(BOOL en);
+void emu_set_battery_level(int level);
+void emu_set_usb_powered(BOOL powered);
 
 BOOL emu_get_systick(uint32_t *value);
 
+BOOL emu_is_headless(void);
+void emu_delay_us(uint32_t us);
+void emu_virtual_time_poll(void);
+void emu_advance_virtual_time(uint32_t ms);
+
 BOOL emu_get_lefthanded(void);
 
 int emu_get_failure_flags(void);
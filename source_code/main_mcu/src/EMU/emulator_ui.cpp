@@ -123,6 +123,20 @@ BOOL emu_get_usb_charging()
     return ret;
 }
 
+void emu_set_battery_level(int level)
+{
+    ui_mutex.lock();
+    battery_level = level;
+    ui_mutex.unlock();
+}
+
+void emu_set_usb_powered(BOOL powered)
+{
+    ui_mutex.lock();
+    usb_powered = powered != FALSE;
+    ui_mutex.unlock();
+}
+
 void emu_charger_enable(BOOL en)
 {
     ui_mutex.lock();
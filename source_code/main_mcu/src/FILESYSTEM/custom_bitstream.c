@@ -20,11 +20,17 @@
  * Created: 16/05/2017 15:42:53
  *  Author: stephan
  */
+#include <string.h>
 #include "platform_defines.h"
 #include "custom_bitstream.h"
 #include "custom_fs.h"
 #include "dma.h"
 
+/* Expansion of 4 1bpp pixels (a nibble) into 4 4bpp pixels */
+static const uint16_t bitstream_1bpp_nibble_expand[16] = {0x0000, 0x000F, 0x00F0, 0x00FF, 0x0F00, 0x0F0F, 0x0FF0, 0x0FFF, 0xF000, 0xF00F, 0xF0F0, 0xF0FF, 0xFF00, 0xFF0F, 0xFFF0, 0xFFFF};
+/* Expansion of 2 2bpp pixels (a nibble) into 2 4bpp pixels */
+static const uint8_t bitstream_2bpp_nibble_expand[16] = {0x00, 0x05, 0x0A, 0x0F, 0x50, 0x55, 0x5A, 0x5F, 0xA0, 0xA5, 0xAA, 0xAF, 0xF0, 0xF5, 0xFA, 0xFF};
+
 
 /*! \fn     bitstream_bitmap_init(bitstream_bitmap_t* bs, bitmap_t* bitmap, custom_fs_address_t address, BOOL exclusive)
 *   \brief  Initialize a bitmap bitstream
@@ -208,14 +214,39 @@ static inline uint8_t bitstream_bitmap_get_next_byte(bitstream_bitmap_t* bs)
     }
 }
 
+/*! \fn     bitstream_bitmap_expand_byte(uint8_t depth, uint8_t byte)
+*   \brief  Expand a byte of 1/2/4bpp pixels into 4bpp pixels
+*   \param  depth       Number of bits per pixel
+*   \param  byte        Byte to expand
+*   \return 4bpp pixels, first pixel in the most significant nibble
+*/
+static inline uint32_t bitstream_bitmap_expand_byte(uint8_t depth, uint8_t byte)
+{
+    if (depth == 1)
+    {
+        return ((uint32_t)bitstream_1bpp_nibble_expand[byte >> 4] << 16) | ((uint32_t)bitstream_1bpp_nibble_expand[byte & 0x0F]);
+    }
+    else if (depth == 2)
+    {
+        return ((uint32_t)bitstream_2bpp_nibble_expand[byte >> 4] << 24) | ((uint32_t)bitstream_2bpp_nibble_expand[byte & 0x0F] << 16);
+    }
+    else
+    {
+        return (uint32_t)byte << 24;
+    }
+}
+
 /*! \fn     bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
 *   \brief  Read continuous pixel data
 *   \param  bs          Pointer to a bitmap bitstream structure
 *   \param  data        Pointer to where to store the data
 *   \param  nb_pixels   Number of pixels to be read
+*   \note   For an odd number of pixels, the last pixel is stored in the high nibble of the last byte
 */
 void bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t nb_pixels)
 {
+    BOOL high_nibble = TRUE;
+    
     if (bs->_flags & CUSTOM_FS_BITMAP_RLE_FLAG)
     {
         while (nb_pixels != 0)
@@ -228,24 +259,85 @@ void bitstream_bitmap_array_read(bitstream_bitmap_t* bs, uint8_t* data, uint16_t
                 bs->_pixel = byte & 0x0F;
             }
             
-            /* We have pixels of the same color to store */
-            *data = bs->_pixel << 4;
-            bs->_bits--;
-            nb_pixels--;
+            if ((high_nibble != FALSE) && (bs->_bits >= 2) && (nb_pixels >= 2))
+            {
+                /* Fill whole bytes with the current run */
+                uint16_t nb_bytes = ((bs->_bits < nb_pixels)? bs->_bits : nb_pixels) / 2;
+                memset(data, bs->_pixel * 0x11, nb_bytes);
+                bs->_bits -= nb_bytes*2;
+                nb_pixels -= nb_bytes*2;
+                data += nb_bytes;
+            }
+            else if (high_nibble != FALSE)
+            {
+                *data = bs->_pixel << 4;
+                high_nibble = FALSE;
+                bs->_bits--;
+                nb_pixels--;
+            }
+            else
+            {
+                *data++ |= bs->_pixel;
+                high_nibble = TRUE;
+                bs->_bits--;
+                nb_pixels--;
+            }
+        }
+    }
+    else if ((bs->bitsPerPixel == 1) || (bs->bitsPerPixel == 2) || (bs->bitsPerPixel == 4))
+    {
+        uint16_t nb_pixels_per_byte = 8 / bs->bitsPerPixel;
+        
+        while (nb_pixels != 0)
+        {
+            if ((bs->_bits == 0) && (nb_pixels >= nb_pixels_per_byte))
+            {
+                /* Expand a complete byte through the lookup tables */
+                uint32_t pixels = bitstream_bitmap_expand_byte(bs->bitsPerPixel, bitstream_bitmap_get_next_byte(bs));
+                uint16_t nb_whole_bytes = nb_pixels_per_byte/2;
+                nb_pixels -= nb_pixels_per_byte;
                 
-            if (bs->_bits == 0)
+                /* Output not byte aligned: first nibble completes current byte, last one starts a new one */
+                if (high_nibble == FALSE)
+                {
+                    *data++ |= (uint8_t)(pixels >> 28);
+                    nb_whole_bytes--;
+                    pixels <<= 4;
+                }
+                for (uint16_t i = 0; i < nb_whole_bytes; i++)
+                {
+                    *data++ = (uint8_t)(pixels >> 24);
+                    pixels <<= 8;
+                }
+                if (high_nibble == FALSE)
+                {
+                    *data = (uint8_t)(pixels >> 24) & 0xF0;
+                }
+            }
+            else
             {
-                /* We have read all pixels of the same color */
-                uint8_t byte = bitstream_bitmap_get_next_byte(bs);
-                bs->_bits = (byte >> 4) + 1;
-                bs->_pixel = byte & 0x0F;
+                /* Single pixel */
+                if (bs->_bits == 0)
+                {
+                    /* We have processed all data inside _word */
+                    bs->_word = bitstream_bitmap_get_next_byte(bs);
+                    bs->_bits = 8;
+                }
+                bs->_bits -= bs->bitsPerPixel;
+                uint8_t pixel = (((bs->_word >> bs->_bits) & bs->mask) * 15) / bs->mask;
+                
+                if (high_nibble != FALSE)
+                {
+                    *data = pixel << 4;
+                    high_nibble = FALSE;
+                }
+                else
+                {
+                    *data++ |= pixel;
+                    high_nibble = TRUE;
+                }
+                nb_pixels--;
             }
-            
-            /* We have pixels of the same color to store */
-            *data |= bs->_pixel;
-            bs->_bits--;
-            nb_pixels--;
-            data++;
         }
     }
     else
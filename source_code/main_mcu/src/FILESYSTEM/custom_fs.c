@@ -106,6 +106,9 @@ custom_fs_address_t custom_fs_usb_keyboard_layout_addr = 0;
 uint8_t custom_fs_cur_usb_keyboard_id = 0;
 custom_fs_address_t custom_fs_ble_keyboard_layout_addr = 0;
 uint8_t custom_fs_cur_ble_keyboard_id = 0;
+/* Keyboard symbols lookup tables for the current USB & BLE layouts */
+keyb_lut_t custom_fs_usb_keyboard_lut;
+keyb_lut_t custom_fs_ble_keyboard_lut;
 /* CPZ look up table */
 cpz_lut_entry_t* custom_fs_cpz_lut;
 
@@ -347,6 +350,50 @@ RET_TYPE custom_fs_compute_and_check_external_bundle_crc32(void)
 #endif
 }
 
+/*! \fn     custom_fs_check_uploaded_bundle_crc32(uint32_t nb_bytes_uploaded)
+*   \brief  Check the crc32 of a freshly uploaded bundle, while other DMA transfers are running
+*   \param  nb_bytes_uploaded   Number of bytes that were written to the external flash
+*   \return Success status
+*   \note   Contrary to custom_fs_compute_and_check_external_bundle_crc32, doesn't reset the DMA controller
+*/
+RET_TYPE custom_fs_check_uploaded_bundle_crc32(uint32_t nb_bytes_uploaded)
+{
+    uint32_t header_fields[3];
+    
+    /* Read magic header, total size and crc32 of the uploaded bundle */
+    dataflash_read_data_array(custom_fs_dataflash_desc, CUSTOM_FS_FILES_ADDR_OFFSET, (uint8_t*)header_fields, sizeof(header_fields));
+    
+    /* Sanity checks */
+    if ((header_fields[0] != CUSTOM_FS_MAGIC_HEADER) || (header_fields[1] < sizeof(header_fields)) || (header_fields[1] > nb_bytes_uploaded))
+    {
+        return RETURN_NOK;
+    }
+    
+#ifndef EMULATOR_BUILD
+    /* Start a read on external flash, just after the crc32 field */
+    dataflash_read_data_array_start(custom_fs_dataflash_desc, CUSTOM_FS_FILES_ADDR_OFFSET + sizeof(header_fields));
+    
+    /* Use the custom fs DMA channels to compute the crc32 */
+    uint32_t crc32 = dma_custom_fs_compute_crc32_from_spi(custom_fs_dataflash_desc->sercom_pt, header_fields[1] - sizeof(header_fields));
+    
+    /* Stop transfer */
+    dataflash_stop_ongoing_transfer(custom_fs_dataflash_desc);
+    
+    /* Do the final check */
+    if (header_fields[2] == crc32)
+    {
+        return RETURN_OK;
+    }
+    else
+    {
+        return RETURN_NOK;
+    }
+#else
+    /* We don't emulate the DMA controller, and don't bother with reimplementing the crc32 routines */
+    return RETURN_OK;
+#endif
+}
+
 /*! \fn     custom_fs_stop_continuous_read_from_flash(BOOL was_using_emergency_bundle_data)
 *   \brief  Stop a continuous flash read
 *   \param  was_using_emergency_bundle_data Boolean to inform if we were using emergency bundle data
@@ -480,6 +527,172 @@ ret_type_te custom_fs_get_keyboard_descriptor_string(uint8_t keyboard_id, cust_c
     return RETURN_OK;
 }
 
+/*! \fn     custom_fs_add_keyboard_lut_sparse_entry(keyb_lut_t* lut, uint16_t unicode_point, uint16_t symbol)
+*   \brief  Insert a point in the sorted sparse entries of a keyboard lookup table
+*   \param  lut             Pointer to the lookup table
+*   \param  unicode_point   The unicode point
+*   \param  symbol          Its keyboard symbol
+*   \note   Points already in the table are kept, as the first interval describing a point is the one used for flash lookups
+*/
+static void custom_fs_add_keyboard_lut_sparse_entry(keyb_lut_t* lut, uint16_t unicode_point, uint16_t symbol)
+{
+    uint16_t high = lut->nb_sparse_entries;
+    uint16_t low = 0;
+    
+    /* Insertion position, end of the table for sorted intervals */
+    while (low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+        
+        if (lut->sparse_entries[middle].unicode_point == unicode_point)
+        {
+            return;
+        }
+        else if (lut->sparse_entries[middle].unicode_point < unicode_point)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    /* Table full: remaining points will be fetched from flash */
+    if (lut->nb_sparse_entries == ARRAY_SIZE(lut->sparse_entries))
+    {
+        lut->sparse_entries_complete = FALSE;
+        return;
+    }
+    
+    memmove(&lut->sparse_entries[low+1], &lut->sparse_entries[low], (lut->nb_sparse_entries - low)*sizeof(lut->sparse_entries[0]));
+    lut->sparse_entries[low].unicode_point = unicode_point;
+    lut->sparse_entries[low].symbol = symbol;
+    lut->nb_sparse_entries++;
+}
+
+/*! \fn     custom_fs_load_keyboard_lut(keyb_lut_t* lut, custom_fs_address_t layout_address)
+*   \brief  Load a keyboard layout symbols lookup table
+*   \param  lut             Pointer to the lookup table to fill
+*   \param  layout_address  Layout file address in external flash
+*   \note   Points not fitting in the sparse table will be fetched from flash at translation time
+*/
+static void custom_fs_load_keyboard_lut(keyb_lut_t* lut, custom_fs_address_t layout_address)
+{
+    custom_fs_address_t symbols_address = layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t) + sizeof(lut->description_intervals);
+    uint16_t symbols[CUSTOM_FS_KEYB_LUT_READ_CHUNK];
+    uint32_t symbol_desc_pt_offset = 0;
+    
+    /* Non described points are not supported, except for tab and return */
+    memset(lut->dense_symbols, 0xFF, sizeof(lut->dense_symbols));
+    lut->dense_symbols[0x09] = KEY_TAB;
+    lut->dense_symbols[0x0A] = KEY_RETURN;
+    lut->sparse_entries_complete = TRUE;
+    lut->layout_address = layout_address;
+    lut->nb_sparse_entries = 0;
+    
+    /* Load the description intervals */
+    custom_fs_read_from_flash((uint8_t*)lut->description_intervals, layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t), sizeof(lut->description_intervals));
+    
+    /* Load the described symbols, sparse entries are kept sorted whatever the intervals order in the bundle */
+    for (uint16_t i = 0; i < ARRAY_SIZE(lut->description_intervals); i++)
+    {
+        uint32_t interval_start = lut->description_intervals[i].interval_start;
+        uint32_t interval_end = lut->description_intervals[i].interval_end;
+        
+        if ((interval_start != 0xFFFF) && (interval_end >= interval_start))
+        {
+            for (uint32_t chunk_start = interval_start; chunk_start <= interval_end; chunk_start += ARRAY_SIZE(symbols))
+            {
+                uint16_t nb_symbols = ARRAY_SIZE(symbols);
+                if (interval_end - chunk_start + 1 < nb_symbols)
+                {
+                    nb_symbols = (uint16_t)(interval_end - chunk_start + 1);
+                }
+                custom_fs_read_from_flash((uint8_t*)symbols, symbols_address + (symbol_desc_pt_offset + chunk_start - interval_start)*sizeof(cust_char_t), nb_symbols*sizeof(uint16_t));
+                
+                for (uint16_t j = 0; j < nb_symbols; j++)
+                {
+                    uint32_t unicode_point = chunk_start + j;
+                    
+                    if (unicode_point < CUSTOM_FS_KEYB_LUT_NB_DENSE)
+                    {
+                        lut->dense_symbols[unicode_point] = symbols[j];
+                    }
+                    else if (symbols[j] != 0xFFFF)
+                    {
+                        custom_fs_add_keyboard_lut_sparse_entry(lut, (uint16_t)unicode_point, symbols[j]);
+                    }
+                }
+            }
+        }
+        
+        /* Add offset to descriptor */
+        symbol_desc_pt_offset += lut->description_intervals[i].interval_end - lut->description_intervals[i].interval_start + 1;
+    }
+}
+
+/*! \fn     custom_fs_get_keyboard_symbol_from_lut(keyb_lut_t* lut, cust_char_t unicode_point)
+*   \brief  Get the keyboard symbol for a unicode point
+*   \param  lut             Pointer to the layout lookup table
+*   \param  unicode_point   The unicode point
+*   \return The symbol, 0xFFFF if not supported
+*/
+static uint16_t custom_fs_get_keyboard_symbol_from_lut(keyb_lut_t* lut, cust_char_t unicode_point)
+{
+    uint16_t symbol_desc_pt_offset = 0;
+    uint16_t symbol = 0xFFFF;
+    
+    /* Latin-1 range */
+    if (unicode_point < CUSTOM_FS_KEYB_LUT_NB_DENSE)
+    {
+        return lut->dense_symbols[unicode_point];
+    }
+    
+    /* Binary search in the sparse entries */
+    int16_t low = 0;
+    int16_t high = (int16_t)lut->nb_sparse_entries - 1;
+    while (low <= high)
+    {
+        int16_t middle = (low + high) / 2;
+        
+        if (lut->sparse_entries[middle].unicode_point == unicode_point)
+        {
+            return lut->sparse_entries[middle].symbol;
+        }
+        else if (lut->sparse_entries[middle].unicode_point < unicode_point)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    
+    /* Not found in a complete table: not supported */
+    if (lut->sparse_entries_complete != FALSE)
+    {
+        return 0xFFFF;
+    }
+    
+    /* Sparse table overflowed: fetch symbol from flash */
+    for (uint16_t i = 0; i < ARRAY_SIZE(lut->description_intervals); i++)
+    {
+        /* Check if char is within this interval */
+        if ((lut->description_intervals[i].interval_start != 0xFFFF) && (lut->description_intervals[i].interval_start <= unicode_point) && (lut->description_intervals[i].interval_end >= unicode_point))
+        {
+            custom_fs_read_from_flash((uint8_t*)&symbol, lut->layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t) + sizeof(lut->description_intervals) + symbol_desc_pt_offset*sizeof(cust_char_t) + (unicode_point - lut->description_intervals[i].interval_start)*sizeof(cust_char_t), sizeof(symbol));
+            break;
+        }
+        
+        /* Add offset to descriptor */
+        symbol_desc_pt_offset += lut->description_intervals[i].interval_end - lut->description_intervals[i].interval_start + 1;
+    }
+    
+    return symbol;
+}
+
 /*! \fn     custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layout)
 *   \brief  Set current keyboard ID
 *   \param  keyboard_id     Keyboard ID
@@ -504,11 +717,13 @@ ret_type_te custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layo
     {
         custom_fs_ble_keyboard_layout_addr = layout_file_addr;
         custom_fs_cur_ble_keyboard_id = keyboard_id;
+        custom_fs_load_keyboard_lut(&custom_fs_ble_keyboard_lut, layout_file_addr);
     } 
     else
     {
         custom_fs_usb_keyboard_layout_addr = layout_file_addr;
         custom_fs_cur_usb_keyboard_id = keyboard_id;
+        custom_fs_load_keyboard_lut(&custom_fs_usb_keyboard_lut, layout_file_addr);
     }
     
     return RETURN_OK;
@@ -524,12 +739,8 @@ ret_type_te custom_fs_set_current_keyboard_id(uint8_t keyboard_id, BOOL usb_layo
 */
 ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* string_pt, uint16_t* buffer, BOOL usb_layout)
 {
-    unicode_interval_desc_t description_intervals[CUSTOM_FS_KEYB_NB_INT_DESCRIBED];
-    custom_fs_address_t layout_address = custom_fs_usb_keyboard_layout_addr;
-    BOOL point_support_described = FALSE;
-    uint16_t symbol_desc_pt_offset = 0;
+    keyb_lut_t* lut = &custom_fs_usb_keyboard_lut;
     BOOL all_points_described = TRUE;
-    uint16_t interval_start = 0;
     
     /* Check for correctly setup keyboard layout */
     if ((custom_fs_usb_keyboard_layout_addr == 0) || (custom_fs_ble_keyboard_layout_addr == 0))
@@ -537,67 +748,23 @@ ret_type_te custom_fs_get_keyboard_symbols_for_unicode_string(cust_char_t* strin
         return RETURN_NOK;
     }   
     
-    /* Mapping address based on layout selection */
+    /* Lookup table based on layout selection */
     if (usb_layout == FALSE)
     {
-        layout_address = custom_fs_ble_keyboard_layout_addr;
+        lut = &custom_fs_ble_keyboard_lut;
     }
     
-    /* Load the description intervals */
-    custom_fs_read_from_flash((uint8_t*)description_intervals, layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t), sizeof(description_intervals));
-    
     /* Iterate over string */
     while (*string_pt != 0)
     {
-        /* Reset vars */
-        point_support_described = FALSE;
-        symbol_desc_pt_offset = 0;
-        interval_start = 0;
-        
-        /* Check that support for this point is described */
-        for (uint16_t i = 0; i < ARRAY_SIZE(description_intervals); i++)
-        {
-            /* Check if char is within this interval */
-            if ((description_intervals[i].interval_start != 0xFFFF) && (description_intervals[i].interval_start <= *string_pt) && (description_intervals[i].interval_end >= *string_pt))
-            {
-                interval_start = description_intervals[i].interval_start;
-                point_support_described = TRUE;
-                break;
-            }
+        /* Fetch keyboard symbol: 0xFFFF for "not supported" matches with our definition of not described */
+        *buffer = custom_fs_get_keyboard_symbol_from_lut(lut, *string_pt);
             
-            /* Add offset to descriptor */
-            symbol_desc_pt_offset += description_intervals[i].interval_end - description_intervals[i].interval_start + 1;
-        }
-        
-        /* Check for described point support */
-        if (point_support_described == FALSE)
+        /* Is this symbol supported? */
+        if (*buffer == 0xFFFF)
         {
-            /* Check for tab or return */
-            if (*string_pt == 0x09)
-            {
-                *buffer = KEY_TAB;
-            } 
-            else if (*string_pt == 0x0A)
-            {
-                *buffer = KEY_RETURN;
-            } 
-            else
-            {
-                all_points_described = FALSE;
-                *buffer = 0xFFFF;
-            }
+            all_points_described = FALSE;
         }
-        else
-        {
-            /* Fetch keyboard symbol: 0xFFFF for "not supported" matches with our definition of not described */
-            custom_fs_read_from_flash((uint8_t*)buffer, layout_address + CUSTOM_FS_KEYBOARD_DESC_LGTH*sizeof(cust_char_t) + sizeof(description_intervals) + symbol_desc_pt_offset*sizeof(*string_pt) + (*string_pt - interval_start)*sizeof(*string_pt), sizeof(*buffer));       
-            
-            /* Is this symbol supported? */
-            if (*buffer == 0xFFFF)
-            {
-                all_points_described = FALSE;
-            }
-        }        
         
         /* Move on to the next point */
         string_pt++;
@@ -1098,7 +1265,7 @@ static uint8_t eeprom[256 * 128];
 
 static void custom_fs_init_custom_storage_slots(void)
 {
-    if(!emu_eeprom_open())
+    if(!emu_eeprom_open(sizeof(eeprom)))
         custom_fs_hard_reset_settings();
 
     emu_eeprom_read(0, eeprom, sizeof(eeprom));
@@ -64,6 +64,7 @@ BOOL custom_fs_get_device_flag_value(custom_fs_flag_id_te flag_id);
 uint8_t custom_fs_settings_get_device_setting(uint16_t setting_id);
 void custom_fs_set_auth_challenge_counter(uint32_t counter_value);
 RET_TYPE custom_fs_compute_and_check_external_bundle_crc32(void);
+RET_TYPE custom_fs_check_uploaded_bundle_crc32(uint32_t nb_bytes_uploaded);
 void custom_fs_clear_power_consumption_log_and_calib_data(void);
 ret_type_te custom_fs_set_current_language(uint8_t language_id);
 void custom_fs_set_device_default_language(uint8_t language_id);
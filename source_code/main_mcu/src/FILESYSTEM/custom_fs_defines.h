@@ -52,6 +52,11 @@
 #define CUSTOM_FS_KEYBOARD_DESC_LGTH        20
 #define CUSTOM_FS_KEYB_NB_INT_DESCRIBED     20
 
+/* Keyboard symbols lookup tables: dense for the Latin-1 range, sorted sparse for supported points above it */
+#define CUSTOM_FS_KEYB_LUT_NB_DENSE         256
+#define CUSTOM_FS_KEYB_LUT_NB_SPARSE        80
+#define CUSTOM_FS_KEYB_LUT_READ_CHUNK       32
+
 /* Settings IDs */
 #define NB_DEVICE_SETTINGS                  64
 #define SETTING_RESERVED_ID                 0
@@ -229,6 +234,24 @@ typedef struct
     uint16_t interval_end;
 } unicode_interval_desc_t;
 
+// Keyboard symbol lookup table sparse entry
+typedef struct
+{
+    uint16_t unicode_point;
+    uint16_t symbol;
+} keyb_lut_sparse_entry_t;
+
+// Keyboard symbols lookup table for a layout
+typedef struct
+{
+    custom_fs_address_t layout_address;
+    unicode_interval_desc_t description_intervals[CUSTOM_FS_KEYB_NB_INT_DESCRIBED];
+    uint16_t dense_symbols[CUSTOM_FS_KEYB_LUT_NB_DENSE];
+    keyb_lut_sparse_entry_t sparse_entries[CUSTOM_FS_KEYB_LUT_NB_SPARSE];
+    uint16_t nb_sparse_entries;
+    BOOL sparse_entries_complete;
+} keyb_lut_t;
+
 // Glyph struct
 typedef struct
 {
@@ -265,6 +265,19 @@ void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t
     dataflash_send_command(descriptor_pt, erase_64kb_cmd, sizeof(erase_64kb_cmd));
 } 
 
+/*! \fn     dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
+*   \brief  Erase a 4KB sector
+*   \param  descriptor_pt   Pointer to dataflash descriptor
+*   \param  address         Address of the 4KB sector
+*   \note   This command takes a while (around 45ms), please call flash_check_busy to know termination
+*/
+void dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address)
+{
+    uint8_t erase_4kb_cmd[] = {0x20, (uint8_t)((address >> 16) & 0xFF), (uint8_t)((address >> 8) & 0xFF), (uint8_t)((address >> 0) & 0xFF)};
+    dataflash_send_write_enable(descriptor_pt);
+    dataflash_send_command(descriptor_pt, erase_4kb_cmd, sizeof(erase_4kb_cmd));
+}
+
 /*! \fn     dataflash_bulk_erase_with_wait(spi_flash_descriptor_t* descriptor_pt)
 *   \brief  Erase the complete flash (will take a long while)
 *   \param  descriptor_pt   Pointer to dataflash descriptor
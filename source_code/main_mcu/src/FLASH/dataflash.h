@@ -28,6 +28,8 @@
 /* Defines */
 #define W25Q16_PAGE_SIZE    256
 #define W25Q16_FLASH_SIZE   2097152UL
+#define W25Q16_BLOCK_SIZE   65536UL
+#define W25Q16_SECTOR_SIZE  4096UL
 
 /* Prototypes */
 void dataflash_write_array_to_memory(spi_flash_descriptor_t* descriptor_pt, uint32_t address, uint8_t* data, uint32_t length);
@@ -37,6 +39,7 @@ void dataflash_send_command(spi_flash_descriptor_t* descriptor_pt, uint8_t* data
 void dataflash_send_single_byte_command(spi_flash_descriptor_t* descriptor_pt, uint8_t command);
 void dataflash_read_data_array_start(spi_flash_descriptor_t* descriptor_pt, uint32_t address);
 void dataflash_erase_64kb_block(spi_flash_descriptor_t* descriptor_pt, uint32_t address);
+void dataflash_erase_4kb_sector(spi_flash_descriptor_t* descriptor_pt, uint32_t address);
 void dataflash_bulk_erase_without_wait(spi_flash_descriptor_t* descriptor_pt);
 uint8_t dataflash_read_status_register(spi_flash_descriptor_t* descriptor_pt);
 void dataflash_stop_ongoing_transfer(spi_flash_descriptor_t* descriptor_pt);
@@ -23,7 +23,16 @@
 #include "driver_sercom.h"
 #include "dbflash.h"
 #include "main.h"
-
+#include <string.h>
+#ifdef DBFLASH_PAGE_CACHE
+/* Write-through page cache, used to avoid SPI transfers when parsing nodes */
+dbflash_page_cache_slot_t dbflash_page_cache_slots[DBFLASH_PAGE_CACHE_NB_PAGES];
+/* CLOCK eviction hand */
+uint16_t dbflash_page_cache_clock_hand = 0;
+/* Cache statistics */
+uint32_t dbflash_page_cache_misses = 0;
+uint32_t dbflash_page_cache_hits = 0;
+#endif
 
 /*! \fn     dbflash_memory_boundary_error_callblack(void)
 *   \brief  Function called when a memory boundary issue occurs
@@ -110,6 +119,95 @@ static inline void dbflash_fill_page_read_write_erase_opcode_from_address(uint16
     buffer[2] = (uint8_t)offset;
 }
 
+#ifdef DBFLASH_PAGE_CACHE
+/*! \fn     dbflash_page_cache_lookup(uint16_t pageNumber)
+*   \brief  Find a page in the page cache
+*   \param  pageNumber  The page number
+*   \return Pointer to the cache slot or 0 if not cached
+*/
+static dbflash_page_cache_slot_t* dbflash_page_cache_lookup(uint16_t pageNumber)
+{
+    for (uint16_t i = 0; i < DBFLASH_PAGE_CACHE_NB_PAGES; i++)
+    {
+        if ((dbflash_page_cache_slots[i].valid != FALSE) && (dbflash_page_cache_slots[i].page_number == pageNumber))
+        {
+            dbflash_page_cache_slots[i].referenced = TRUE;
+            return &dbflash_page_cache_slots[i];
+        }
+    }
+    return 0;
+}
+
+/*! \fn     dbflash_page_cache_get_slot_to_fill(void)
+*   \brief  Get a page cache slot to store a newly read page into (CLOCK eviction)
+*   \return Pointer to the cache slot
+*/
+static dbflash_page_cache_slot_t* dbflash_page_cache_get_slot_to_fill(void)
+{
+    while (TRUE)
+    {
+        dbflash_page_cache_slot_t* slot_pt = &dbflash_page_cache_slots[dbflash_page_cache_clock_hand];
+        
+        /* Move hand forward */
+        if (++dbflash_page_cache_clock_hand == DBFLASH_PAGE_CACHE_NB_PAGES)
+        {
+            dbflash_page_cache_clock_hand = 0;
+        }
+        
+        /* Free slot or not recently used one */
+        if ((slot_pt->valid == FALSE) || (slot_pt->referenced == FALSE))
+        {
+            return slot_pt;
+        }
+        
+        /* Give it a second chance */
+        slot_pt->referenced = FALSE;
+    }
+}
+
+/*! \fn     dbflash_page_cache_invalidate_page(uint16_t pageNumber)
+*   \brief  Remove a given page from the page cache
+*   \param  pageNumber  The page number
+*/
+static void dbflash_page_cache_invalidate_page(uint16_t pageNumber)
+{
+    for (uint16_t i = 0; i < DBFLASH_PAGE_CACHE_NB_PAGES; i++)
+    {
+        if (dbflash_page_cache_slots[i].page_number == pageNumber)
+        {
+            dbflash_page_cache_slots[i].valid = FALSE;
+        }
+    }
+}
+
+/*! \fn     dbflash_page_cache_invalidate_all(void)
+*   \brief  Empty the page cache
+*/
+static void dbflash_page_cache_invalidate_all(void)
+{
+    for (uint16_t i = 0; i < DBFLASH_PAGE_CACHE_NB_PAGES; i++)
+    {
+        dbflash_page_cache_slots[i].valid = FALSE;
+    }
+}
+#endif
+
+/*! \fn     dbflash_get_page_cache_stats(uint32_t* hits, uint32_t* misses)
+*   \brief  Get the page cache statistics
+*   \param  hits    Where to store the number of page reads served from cache
+*   \param  misses  Where to store the number of page reads that went to the flash
+*/
+void dbflash_get_page_cache_stats(uint32_t* hits, uint32_t* misses)
+{
+    #ifdef DBFLASH_PAGE_CACHE
+        *hits = dbflash_page_cache_hits;
+        *misses = dbflash_page_cache_misses;
+    #else
+        *hits = 0;
+        *misses = 0;
+    #endif
+}
+
 /*! \fn     dbflash_send_data_with_four_bytes_opcode(spi_flash_descriptor_t* descriptor_pt, uint8_t* opcode, uint8_t* buffer, uint16_t buffer_size)
 *   \brief  Send data with a four bytes opcode to flash
 *   \param  descriptor_pt   Pointer to dbflash descriptor
@@ -244,6 +342,10 @@ void dbflash_sector_zero_erase(spi_flash_descriptor_t* descriptor_pt, uint8_t se
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        dbflash_page_cache_invalidate_all();
+    #endif
 }
 
 /*! \fn     dbflash_sector_erase(spi_flash_descriptor_t* descriptor_pt, uint8_t sectorNumber)
@@ -267,7 +369,11 @@ void dbflash_sector_erase(spi_flash_descriptor_t* descriptor_pt, uint8_t sectorN
     dbflash_send_command(descriptor_pt, opcode, sizeof(opcode));
     
     /* Wait until memory is ready */
-    dbflash_wait_for_not_busy(descriptor_pt);   
+    dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        dbflash_page_cache_invalidate_all();
+    #endif
 }
 
 /*! \fn     dbflash_chip_erase(spi_flash_descriptor_t* descriptor_pt)
@@ -280,7 +386,11 @@ void dbflash_chip_erase(spi_flash_descriptor_t* descriptor_pt)
     dbflash_send_command(descriptor_pt, opcode, sizeof(opcode));
     
     /* Wait until memory is ready */
-    dbflash_wait_for_not_busy(descriptor_pt);   
+    dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        dbflash_page_cache_invalidate_all();
+    #endif
 }
 
 /*! \fn     dbflash_block_erase(spi_flash_descriptor_t* descriptor_pt, uint16_t blockNumber)
@@ -305,6 +415,10 @@ void dbflash_block_erase(spi_flash_descriptor_t* descriptor_pt, uint16_t blockNu
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        dbflash_page_cache_invalidate_all();
+    #endif
 }
 
 /*! \fn     dbflash_page_erase(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber)
@@ -329,6 +443,10 @@ void dbflash_page_erase(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumb
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        dbflash_page_cache_invalidate_page(pageNumber);
+    #endif
 }
 
 /*! \fn     dbflash_format_flash(spi_flash_descriptor_t* descriptor_pt) 
@@ -409,6 +527,19 @@ void dbflash_write_data_pattern_to_flash(spi_flash_descriptor_t* descriptor_pt,
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        /* Keep cached copy up to date */
+        dbflash_page_cache_slot_t* slot_pt = dbflash_page_cache_lookup(pageNumber);
+        if ((slot_pt != 0) && ((offset + dataSize) <= BYTES_PER_PAGE))
+        {
+            memset(&slot_pt->page_data[offset], pattern, dataSize);
+        }
+        else if (slot_pt != 0)
+        {
+            dbflash_page_cache_invalidate_page(pageNumber);
+        }
+    #endif
 }
 
 /*! \fn     dbflash_write_data_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, void *data)
@@ -449,6 +580,34 @@ void dbflash_write_data_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t
     
     /* Wait until memory is ready */
     dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        /* Keep cached copy up to date */
+        dbflash_page_cache_slot_t* slot_pt = dbflash_page_cache_lookup(pageNumber);
+        if ((slot_pt != 0) && ((offset + dataSize) <= BYTES_PER_PAGE))
+        {
+            memcpy(&slot_pt->page_data[offset], data, dataSize);
+        }
+        else if (slot_pt != 0)
+        {
+            dbflash_page_cache_invalidate_page(pageNumber);
+        }
+    #endif
+}
+
+/*! \fn     dbflash_read_page_chunk_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, uint8_t* data)
+*   \brief  Read data from the flash array, bypassing the page cache
+*   \param  descriptor_pt   Pointer to dbflash descriptor
+*   \param  pageNumber      The target page number of flash memory
+*   \param  offset          The starting byte offset to begin reading in pageNumber
+*   \param  dataSize        The number of bytes to read
+*   \param  data            The buffer used to store the data read from flash
+*/
+static inline void dbflash_read_page_chunk_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, uint8_t* data)
+{
+    uint8_t opcode[4] = {DBFLASH_OPCODE_LOWF_READ};
+    dbflash_fill_page_read_write_erase_opcode_from_address(pageNumber, offset, &opcode[1]);
+    dbflash_send_data_with_four_bytes_opcode(descriptor_pt, opcode, data, dataSize);
 }
 
 /*! \fn     dbflash_read_data_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, void *data)
@@ -485,9 +644,59 @@ void dbflash_read_data_from_flash(spi_flash_descriptor_t* descriptor_pt, uint16_
         }
     #endif
     
-    uint8_t opcode[4] = {DBFLASH_OPCODE_LOWF_READ};
-    dbflash_fill_page_read_write_erase_opcode_from_address(pageNumber, offset, &opcode[1]);
-    dbflash_send_data_with_four_bytes_opcode(descriptor_pt, opcode, data, dataSize);
+    #ifdef DBFLASH_PAGE_CACHE
+        uint8_t* data_pt = (uint8_t*)data;
+        
+        /* Serve the read page by page */
+        while (dataSize != 0)
+        {
+            /* Offset outside of page or non existing page: read the remainder as is */
+            if ((offset >= BYTES_PER_PAGE) || (pageNumber >= PAGE_COUNT))
+            {
+                dbflash_read_page_chunk_from_flash(descriptor_pt, pageNumber, offset, dataSize, data_pt);
+                return;
+            }
+            
+            /* Number of bytes to take from this page */
+            uint16_t chunk_size = BYTES_PER_PAGE - offset;
+            if (chunk_size > dataSize)
+            {
+                chunk_size = dataSize;
+            }
+            
+            dbflash_page_cache_slot_t* slot_pt = dbflash_page_cache_lookup(pageNumber);
+            if (slot_pt != 0)
+            {
+                dbflash_page_cache_hits++;
+                memcpy(data_pt, &slot_pt->page_data[offset], chunk_size);
+            }
+            else if (chunk_size >= DBFLASH_PAGE_CACHE_MIN_FILL_SIZE)
+            {
+                /* Fetch the complete page */
+                dbflash_page_cache_misses++;
+                slot_pt = dbflash_page_cache_get_slot_to_fill();
+                dbflash_read_page_chunk_from_flash(descriptor_pt, pageNumber, 0, BYTES_PER_PAGE, slot_pt->page_data);
+                slot_pt->page_number = pageNumber;
+                slot_pt->referenced = TRUE;
+                slot_pt->valid = TRUE;
+                memcpy(data_pt, &slot_pt->page_data[offset], chunk_size);
+            }
+            else
+            {
+                /* Small read: not worth evicting a page for it */
+                dbflash_page_cache_misses++;
+                dbflash_read_page_chunk_from_flash(descriptor_pt, pageNumber, offset, chunk_size, data_pt);
+            }
+            
+            /* Move on to the next page */
+            data_pt += chunk_size;
+            dataSize -= chunk_size;
+            pageNumber++;
+            offset = 0;
+        }
+    #else
+        dbflash_read_page_chunk_from_flash(descriptor_pt, pageNumber, offset, dataSize, data);
+    #endif
 } 
 
 /*! \fn     dbflash_raw_read(spi_flash_descriptor_t* descriptor_pt, uint8_t* datap, uint16_t addr, uint16_t size)
@@ -536,4 +745,8 @@ void dbflash_flash_write_buffer_to_page(spi_flash_descriptor_t* descriptor_pt, u
     dbflash_fill_page_read_write_erase_opcode_from_address(page, 0, &op[1]);
     dbflash_send_data_with_four_bytes_opcode(descriptor_pt, op, op, 0);
     dbflash_wait_for_not_busy(descriptor_pt);
+    
+    #ifdef DBFLASH_PAGE_CACHE
+        dbflash_page_cache_invalidate_page(page);
+    #endif
 }
\ No newline at end of file
@@ -29,6 +29,12 @@
 // Enable boundary checks
 #define DBFLASH_MEMORY_BOUNDARY_CHECKS
 
+// Enable write-through page cache (not for the bootloader, emulator has its own storage)
+#if !defined(BOOTLOADER) && !defined(EMULATOR_BUILD)
+    #define DBFLASH_PAGE_CACHE
+    #define DBFLASH_PAGE_CACHE_NB_PAGES         4
+#endif
+
 /* Prototypes */
 void dbflash_write_data_pattern_to_flash(spi_flash_descriptor_t* descriptor_pt, uint16_t pageNumber, uint16_t offset, uint16_t dataSize, uint8_t pattern);
 void dbflash_send_data_with_four_bytes_opcode_no_readback(spi_flash_descriptor_t* descriptor_pt, uint8_t* opcode, uint8_t* buffer, uint16_t buffer_size);
@@ -50,6 +56,7 @@ RET_TYPE dbflash_check_presence(spi_flash_descriptor_t* descriptor_pt);
 void dbflash_wait_for_not_busy(spi_flash_descriptor_t* descriptor_pt);
 void dbflash_format_flash(spi_flash_descriptor_t* descriptor_pt);
 void dbflash_chip_erase(spi_flash_descriptor_t* descriptor_pt);
+void dbflash_get_page_cache_stats(uint32_t* hits, uint32_t* misses);
 void dbflash_memory_boundary_error_callblack(void);
 
 /* Defines */
@@ -290,4 +297,16 @@ void dbflash_memory_boundary_error_callblack(void);
 // Flash size defines
 #define DBFLASH_SIZE          ((uint32_t)PAGE_COUNT * (uint32_t)BYTES_PER_PAGE)
 
+// Page cache defines
+#define DBFLASH_PAGE_CACHE_MIN_FILL_SIZE    (BYTES_PER_PAGE/4)  // Reads smaller than this don't fetch the complete page on cache miss
+
+/* Typedefs */
+typedef struct
+{
+    BOOL valid;                             // Set when the slot contains a page
+    BOOL referenced;                        // CLOCK eviction reference bit
+    uint16_t page_number;                   // Cached page number
+    uint8_t page_data[BYTES_PER_PAGE];      // Cached page contents
+} dbflash_page_cache_slot_t;
+
 #endif /* DBFLASH_MEM_H_ */
\ No newline at end of file
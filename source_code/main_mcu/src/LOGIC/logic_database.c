@@ -264,7 +264,7 @@ uint16_t logic_database_search_for_next_data_parent_after_addr(uint16_t node_add
 *   \param  cred_type               set to TRUE to search for credential, FALSE for data 
 *   \param  category_id             Credential/Data category ID
 *   \return Address of the found node, NODE_ADDR_NULL otherwise
-*   \note   Full 8Mb database search has been timed at 581ms
+*   \note   Full 8Mb database search has been timed at 581ms, the service index now limits the number of parents read
 */
 uint16_t logic_database_search_service(cust_char_t* name, service_compare_mode_te compare_type, BOOL cred_type, uint16_t category_id)
 {
@@ -292,15 +292,8 @@ uint16_t logic_database_search_service(cust_char_t* name, service_compare_mode_t
         }
     }
     
-    /* Get start node */
-    if (cred_type != FALSE)
-    {
-        next_node_addr = nodemgmt_get_starting_parent_addr(category_id);
-    }
-    else
-    {
-        next_node_addr = nodemgmt_get_starting_data_parent_addr(category_id);
-    }
+    /* Get start node: closest indexed parent before the service we're looking for */
+    next_node_addr = nodemgmt_get_service_index_start_addr(name, cred_type, category_id, mult_domain_possible);
     
     /* Check for presence of at least one parent node */
     if (next_node_addr == NODE_ADDR_NULL)
@@ -457,6 +450,12 @@ uint16_t logic_database_search_webauthn_credential_id_in_service(uint16_t parent
     parent_node_t temp_pnode;
     uint16_t next_node_addr;
     
+    /* Look into the credential ID index first */
+    if (nodemgmt_search_cred_id_index(parent_addr, credential_id, &next_node_addr) == RETURN_OK)
+    {
+        return next_node_addr;
+    }
+    
     /* Dirty trick */
     temp_half_cnode_pt = (child_webauthn_node_t*)&temp_pnode;
     
@@ -847,6 +846,7 @@ void logic_database_update_webauthn_credential(uint16_t child_address, cust_char
 
     /* Then write node */
     nodemgmt_write_child_node_block_to_flash(child_address, (child_node_t*)&temp_cnode, FALSE);
+    nodemgmt_update_cred_id_index(child_address, credential_id);
     nodemgmt_user_db_changed_actions(FALSE);
 }
 
@@ -1016,6 +1016,7 @@ RET_TYPE logic_database_add_webauthn_credential_for_service(uint16_t service_add
     ret_type_te ret_val = nodemgmt_create_child_node(service_addr, (child_cred_node_t*)&temp_cnode, &storage_addr);
     if (ret_val == RETURN_OK)
     {
+        nodemgmt_add_to_cred_id_index(service_addr, storage_addr, credential_id);
         nodemgmt_user_db_changed_actions(FALSE);
     }
 
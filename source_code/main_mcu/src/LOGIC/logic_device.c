@@ -361,6 +361,7 @@ void logic_device_bundle_update_end(BOOL from_debug_messages)
     {        
         /* Refresh file system and font */
         custom_fs_init();
+        sh1122_invalidate_font(&plat_oled_descriptor);
         
         /* Go to default screen */
         gui_dispatcher_set_current_screen(GUI_SCREEN_NINSERTED, TRUE, GUI_OUTOF_MENU_TRANSITION);
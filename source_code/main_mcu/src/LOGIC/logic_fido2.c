@@ -123,24 +123,27 @@ static uint32_t logic_fido2_cbor_encode_public_key(uint8_t* buf, uint32_t bufLen
     return output_data_length;
 }
 
-/*! \fn     logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* request)
-*   \brief  Process Exclude list check from aux_mcu.
-*           Checks if tag already exists. Returns 1 if credential exists or 0
-*           otherwise. If tag exists prompt the user and wait for user ack.
-*   \param  incoming messsage request
-*   \return void
+/*! \fn     logic_fido2_process_exclude_list_credentials(uint8_t* rp_id, uint8_t (*cred_IDs)[FIDO2_CREDENTIAL_ID_LENGTH], uint16_t nb_cred_IDs)
+*   \brief  Process an exclude list check from aux_mcu.
+*           Checks if one of the tags already exists. Answers FIDO2_CREDENTIAL_EXISTS
+*           with the first matching tag or 0 otherwise. If a tag exists prompt the user and wait for user ack.
+*   \param  rp_id           Relying party ID, part of the incoming message (FIDO2_RPID_LEN long)
+*   \param  cred_IDs        Credential IDs to check
+*   \param  nb_cred_IDs     Number of credential IDs
+*   \note   The no match delay is only applied once for the whole list
 */
-void logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* request)
+static void logic_fido2_process_exclude_list_credentials(uint8_t* rp_id, uint8_t (*cred_IDs)[FIDO2_CREDENTIAL_ID_LENGTH], uint16_t nb_cred_IDs)
 {
+    uint16_t child_address = NODE_ADDR_NULL;
     fido2_credential_ID_t cred_ID_copy;
 
     /* Input sanitation & buffer for UTF8 to Unicode BMP conversion */
     cust_char_t rp_id_copy[MEMBER_ARRAY_SIZE(parent_data_node_t, service)];
-    request->rpID[MEMBER_SIZE(fido2_auth_cred_req_message_t, rpID)-1] = 0;
+    rp_id[FIDO2_RPID_LEN-1] = 0;
     memset(rp_id_copy, 0, sizeof(rp_id_copy));
     
     /* Try to convert to unicode BMP */
-    int16_t rpid_conv_length = utils_utf8_string_to_bmp_string(request->rpID, rp_id_copy, MEMBER_SIZE(fido2_auth_cred_req_message_t, rpID), ARRAY_SIZE(rp_id_copy));
+    int16_t rpid_conv_length = utils_utf8_string_to_bmp_string(rp_id, rp_id_copy, FIDO2_RPID_LEN, ARRAY_SIZE(rp_id_copy));
     
     /* Did the conversion go badly? */
     if (rpid_conv_length < 0)
@@ -167,11 +170,20 @@ void logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* reques
         return;
     }
     
-    /* Look for credential ID */
-    uint16_t child_address = logic_database_search_webauthn_credential_id_in_service(parent_address, request->cred_ID.tag);
+    /* Look for the first known credential ID */
+    for (uint16_t i = 0; (i < nb_cred_IDs) && (child_address == NODE_ADDR_NULL); i++)
+    {
+        child_address = logic_database_search_webauthn_credential_id_in_service(parent_address, cred_IDs[i]);
+        
+        /* gui_prompts_ask_for_confirmation() reuses buffer that contains the incoming message. Make a copy
+         * of the credential ID since we are using this value afterwards
+         */
+        memcpy(&cred_ID_copy, cred_IDs[i], sizeof(cred_ID_copy));
+    }
     
     /* Static asserts */
     _Static_assert(MEMBER_SIZE(fido2_auth_cred_rsp_message_t, user_handle) >= MEMBER_SIZE(child_webauthn_node_t, user_handle), "user handle size not big enough");
+    _Static_assert(sizeof(fido2_credential_ID_t) == FIDO2_CREDENTIAL_ID_LENGTH, "credential ID size mismatch");
     
     /* Check for existing login */
     if (child_address == NODE_ADDR_NULL)
@@ -186,11 +198,6 @@ void logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* reques
     }
     else
     {
-        /* gui_prompts_ask_for_confirmation() reuses buffer that contains the "request" object. Make a copy
-         * of the request->cred_ID since we are using this value afterwards
-         */
-        memcpy(&cred_ID_copy, &request->cred_ID, sizeof(cred_ID_copy));
-
         /* Wait for user ACK */
         cust_char_t* display_cred_prompt_text;
         custom_fs_get_string_from_file(CRED_ALREAD_PRESENT_TEXT_ID, &display_cred_prompt_text, TRUE);
@@ -211,6 +218,37 @@ void logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* reques
     }
 }
 
+/*! \fn     logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* request)
+*   \brief  Process Exclude list check from aux_mcu.
+*           Checks if tag already exists. Returns 1 if credential exists or 0
+*           otherwise. If tag exists prompt the user and wait for user ack.
+*   \param  incoming messsage request
+*   \return void
+*/
+void logic_fido2_process_exclude_list_item(fido2_auth_cred_req_message_t* request)
+{
+    logic_fido2_process_exclude_list_credentials(request->rpID, &request->cred_ID.tag, 1);
+}
+
+/*! \fn     logic_fido2_process_exclude_list(fido2_excl_list_req_message_t* request)
+*   \brief  Process a batched exclude list check from aux_mcu, answered as a single item check
+*           with the first credential ID of the list that already exists
+*   \param  incoming messsage request
+*   \return void
+*/
+void logic_fido2_process_exclude_list(fido2_excl_list_req_message_t* request)
+{
+    uint16_t nb_cred_IDs = request->excl_list.len;
+    
+    /* Input sanitation */
+    if (nb_cred_IDs > FIDO2_ALLOW_LIST_MAX_SIZE)
+    {
+        nb_cred_IDs = FIDO2_ALLOW_LIST_MAX_SIZE;
+    }
+    
+    logic_fido2_process_exclude_list_credentials(request->rpID, request->excl_list.tag, nb_cred_IDs);
+}
+
 /*! \fn     logic_fido2_process_make_credential(fido2_make_credential_req_message_t* request)
 *   \brief  Make a new credential. This essentially creates the key pair and stores the new record in the DB
 *   \param  incoming request message
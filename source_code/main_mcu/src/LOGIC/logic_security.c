@@ -23,6 +23,10 @@
 #include "logic_bluetooth.h"
 #include "logic_security.h"
 #include "logic_aux_mcu.h"
+#include "nodemgmt.h"
+#ifdef EMULATOR_BUILD
+#include "emu_storage.h"
+#endif
 /* Inserted card unlocked */
 volatile BOOL logic_security_smartcard_inserted_unlocked = FALSE;
 /* Memory management mode */
@@ -90,6 +94,14 @@ BOOL logic_security_should_leave_management_mode(void)
 void logic_security_clear_management_mode(void)
 {
     logic_security_management_mode = FALSE;
+    
+    /* Credentials may have been changed: credential ID index will be rebuilt on next search */
+    nodemgmt_invalidate_cred_id_index();
+    
+    #ifdef EMULATOR_BUILD
+    /* Database changes are done, make them durable */
+    emu_storage_sync();
+    #endif
 }
 
 /*! \fn     logic_security_is_management_mode_set(void)
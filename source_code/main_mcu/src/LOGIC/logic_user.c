@@ -2362,6 +2362,108 @@ void logic_user_manual_select_login(void)
     }
 }
 
+/*! \fn     logic_user_get_key_after_password(child_cred_node_t* cnode, lock_feature_te keys_to_send_before_login)
+*   \brief  Get the unicode point to be typed after a credential password
+*   \param  cnode                       Pointer to the credential child node
+*   \param  keys_to_send_before_login   Unlock feature bitfield, 0 if not called by the unlock feature
+*   \return The unicode point
+*/
+static cust_char_t logic_user_get_key_after_password(child_cred_node_t* cnode, lock_feature_te keys_to_send_before_login)
+{
+    if (keys_to_send_before_login != 0x00)
+    {
+        /* If we came here because of the unlock feature, discard per login & general settings */
+        return 0x0A;
+    }
+    else if (cnode->keyAfterPassword == 0xFFFF)
+    {
+        /* Use default device key press */
+        return custom_fs_settings_get_device_setting(SETTINGS_CHAR_AFTER_PASS_PRESS);
+    }
+    else
+    {
+        return cnode->keyAfterPassword;
+    }
+}
+
+/*! \fn     logic_user_decrypt_password_for_typing(child_cred_node_t* cnode, BOOL* password_decrypted)
+*   \brief  Decrypt a credential password and convert it to unicode if it is an old generation one
+*   \param  cnode               Pointer to the credential child node
+*   \param  password_decrypted  Pointer to a boolean set once the password is decrypted, to only decrypt it once
+*/
+static void logic_user_decrypt_password_for_typing(child_cred_node_t* cnode, BOOL* password_decrypted)
+{
+    BOOL prev_gen_credential_flag = FALSE;
+    
+    /* Check for previous generation password */
+    if ((cnode->flags & NODEMGMT_PREVGEN_BIT_BITMASK) != 0)
+    {
+        prev_gen_credential_flag = TRUE;
+    }
+    
+    if (*password_decrypted == FALSE)
+    {
+        /* Decrypt password. The field just after it is 0 */
+        logic_encryption_ctr_decrypt((uint8_t*)cnode->password, cnode->ctr, MEMBER_SIZE(child_cred_node_t, password), prev_gen_credential_flag);
+        *password_decrypted = TRUE;
+    }
+    
+    /* If old generation password, convert it to unicode */
+    if (prev_gen_credential_flag != FALSE)
+    {
+        _Static_assert(MEMBER_SIZE(child_cred_node_t, password) >= NODEMGMT_OLD_GEN_ASCII_PWD_LENGTH*2 + 2, "Backward compatibility problem");
+        utils_ascii_to_unicode((uint8_t*)cnode->password, NODEMGMT_OLD_GEN_ASCII_PWD_LENGTH);
+        cnode->cust_char_password[NODEMGMT_OLD_GEN_ASCII_PWD_LENGTH] = 0;
+    }
+}
+
+/*! \fn     logic_user_prepare_password_typing_message(child_cred_node_t* cnode, uint16_t interface_id, BOOL usb_selected, lock_feature_te keys_to_send_before_login, ret_type_te* transform_success)
+*   \brief  Build the message typing a decrypted credential password followed by its key after password
+*   \param  cnode                       Pointer to the credential child node
+*   \param  interface_id                Interface identifier (0 for USB, 1 for BLE)
+*   \param  usb_selected                Boolean set if the USB interface is selected
+*   \param  keys_to_send_before_login   Unlock feature bitfield, 0 if not called by the unlock feature
+*   \param  transform_success           Pointer to where to store RETURN_OK if all unicode points could be translated to keyboard symbols
+*   \return The message, to be sent or discarded
+*/
+static aux_mcu_message_t* logic_user_prepare_password_typing_message(child_cred_node_t* cnode, uint16_t interface_id, BOOL usb_selected, lock_feature_te keys_to_send_before_login, ret_type_te* transform_success)
+{
+    aux_mcu_message_t* typing_message_to_be_sent = comms_aux_mcu_get_empty_packet_ready_to_be_sent(AUX_MCU_MSG_TYPE_KEYBOARD_TYPE);
+    uint16_t password_length = utils_strlen(cnode->cust_char_password);
+    
+    typing_message_to_be_sent->payload_length1 = MEMBER_SIZE(keyboard_type_message_t, interface_identifier) + MEMBER_SIZE(keyboard_type_message_t, delay_between_types) + (password_length + 1 + 1)*sizeof(cust_char_t);
+    *transform_success = custom_fs_get_keyboard_symbols_for_unicode_string(cnode->cust_char_password, typing_message_to_be_sent->keyboard_type_message.keyboard_symbols, usb_selected);
+    /* Key after password: password is 0 terminated by read function, _Static_asserts guarantees enough space, message is initialized at 0s */
+    typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[password_length] = logic_user_get_key_after_password(cnode, keys_to_send_before_login);
+    custom_fs_get_keyboard_symbols_for_unicode_string(&typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[password_length], &typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[password_length], usb_selected);
+    typing_message_to_be_sent->keyboard_type_message.delay_between_types = custom_fs_settings_get_device_setting(SETTINGS_DELAY_BETWEEN_PRESSES);
+    typing_message_to_be_sent->keyboard_type_message.interface_identifier = interface_id;
+    
+    return typing_message_to_be_sent;
+}
+
+/*! \fn     logic_user_send_typing_message_and_wait(aux_mcu_message_t* typing_message)
+*   \brief  Send a keyboard typing message to the aux MCU and wait for the typing status
+*   \param  typing_message  The keyboard typing message
+*   \return What the aux MCU reported: TRUE if all symbols could be typed
+*/
+static BOOL logic_user_send_typing_message_and_wait(aux_mcu_message_t* typing_message)
+{
+    aux_mcu_message_t* temp_rx_message;
+    BOOL could_type_all_symbols;
+    
+    comms_aux_mcu_send_message(typing_message);
+    
+    /* Wait for typing status */
+    while(comms_aux_mcu_active_wait(&temp_rx_message, AUX_MCU_MSG_TYPE_KEYBOARD_TYPE, FALSE, -1) != RETURN_OK){}
+    could_type_all_symbols = (BOOL)temp_rx_message->payload_as_uint16[0];
+    
+    /* Rearm DMA RX */
+    comms_aux_arm_rx_and_clear_no_comms();
+    
+    return could_type_all_symbols;
+}
+
 /*! \fn     logic_user_ask_for_credentials_keyb_output(uint16_t parent_address, uint16_t child_address, BOOL skip_login_prompt_and_int_choice, BOOL* usb_selected, lock_feature_te keys_to_send_before_login, BOOL skip_login_prompt, BOOL no_password_prompt)
 *   \brief  Ask the user to enter the login & password of a given service
 *   \param  parent_address                      Address of the parent
@@ -2384,7 +2486,10 @@ RET_TYPE logic_user_ask_for_credentials_keyb_output(uint16_t parent_address, uin
     BOOL could_type_all_symbols;
     BOOL shortcut_sent = FALSE;
     parent_node_t temp_pnode;
+    aux_mcu_message_t* password_typing_message = 0;
+    ret_type_te password_transform_success = RETURN_OK;
     BOOL password_decrypted = FALSE;
+    BOOL password_pipelined = FALSE;
 
     /* Are we at least connected to anything? */
     if ((logic_bluetooth_get_state() != BT_STATE_CONNECTED) && (logic_aux_mcu_is_usb_enumerated() == FALSE))
@@ -2554,6 +2659,14 @@ RET_TYPE logic_user_ask_for_credentials_keyb_output(uint16_t parent_address, uin
                         typing_message_to_be_sent->keyboard_type_message.interface_identifier = interface_id;
                         comms_aux_mcu_send_message(typing_message_to_be_sent);
                         
+                        /* No password prompt: decrypt and translate the password while the aux MCU types the login */
+                        if ((no_password_prompt != FALSE) && (temp_cnode.passwordBlankFlag == FALSE))
+                        {
+                            logic_user_decrypt_password_for_typing(&temp_cnode, &password_decrypted);
+                            password_typing_message = logic_user_prepare_password_typing_message(&temp_cnode, interface_id, *usb_selected, keys_to_send_before_login, &password_transform_success);
+                            password_pipelined = TRUE;
+                        }
+                        
                         /* Wait for typing status */
                         while(comms_aux_mcu_active_wait(&temp_rx_message, AUX_MCU_MSG_TYPE_KEYBOARD_TYPE, FALSE, -1) != RETURN_OK){}
                         could_type_all_symbols = (BOOL)temp_rx_message->payload_as_uint16[0];
@@ -2566,16 +2679,45 @@ RET_TYPE logic_user_ask_for_credentials_keyb_output(uint16_t parent_address, uin
                         {
                             if (gui_prompts_display_information_on_screen_and_wait(COULDNT_TYPE_CHARS_TEXT_ID, DISP_MSG_WARNING, FALSE) == GUI_INFO_DISP_RET_CARD_CHANGE)
                             {
+                                if (password_typing_message != 0)
+                                {
+                                    comms_aux_mcu_discard_message(password_typing_message);
+                                }
                                 return RETURN_OK;
                             }
                         }
                         
                         /* Set bool */
                         anything_typed = TRUE;
+                        
+                        /* Password message ready: send it right after the login, unless the card was removed in the meantime */
+                        if (password_typing_message != 0)
+                        {
+                            if (smartcard_low_level_is_smc_absent() == RETURN_OK)
+                            {
+                                comms_aux_mcu_discard_message(password_typing_message);
+                                return RETURN_OK;
+                            }
+                            could_type_all_symbols = logic_user_send_typing_message_and_wait(password_typing_message);
+                            password_typing_message = 0;
+                            
+                            /* Clear the password, flag it as blank so going back doesn't type it again */
+                            memset(temp_cnode.cust_char_password, 0, sizeof(temp_cnode.cust_char_password));
+                            temp_cnode.passwordBlankFlag = TRUE;
+                            
+                            /* Display warning if some chars were missing */
+                            if ((password_transform_success != RETURN_OK) || (could_type_all_symbols == FALSE))
+                            {
+                                if (gui_prompts_display_information_on_screen_and_wait(COULDNT_TYPE_CHARS_TEXT_ID, DISP_MSG_WARNING, FALSE) == GUI_INFO_DISP_RET_CARD_CHANGE)
+                                {
+                                    return RETURN_OK;
+                                }
+                            }
+                        }
                     }
 
-                    /* Move on */
-                    state_machine++;
+                    /* Move on, skipping the password state if it was already typed */
+                    state_machine = (password_pipelined != FALSE)? 3:2;
                 }
             }            
         } 
@@ -2632,28 +2774,9 @@ RET_TYPE logic_user_ask_for_credentials_keyb_output(uint16_t parent_address, uin
                     if (prompt_return == MINI_INPUT_RET_YES)
                     {
                         aux_mcu_message_t* typing_message_to_be_sent;
-                        BOOL prev_gen_credential_flag = FALSE;
                         
-                        /* Check for previous generation password */
-                        if ((temp_cnode.flags & NODEMGMT_PREVGEN_BIT_BITMASK) != 0)
-                        {
-                            prev_gen_credential_flag = TRUE;
-                        }
-                        
-                        if (password_decrypted == FALSE)
-                        {
-                            /* Decrypt password. The field just after it is 0 */
-                            logic_encryption_ctr_decrypt((uint8_t*)temp_cnode.password, temp_cnode.ctr, MEMBER_SIZE(child_cred_node_t, password), prev_gen_credential_flag);
-                            password_decrypted = TRUE;
-                        }
-                        
-                        /* If old generation password, convert it to unicode */
-                        if (prev_gen_credential_flag != FALSE)
-                        {
-                            _Static_assert(MEMBER_SIZE(child_cred_node_t, password) >= NODEMGMT_OLD_GEN_ASCII_PWD_LENGTH*2 + 2, "Backward compatibility problem");
-                            utils_ascii_to_unicode((uint8_t*)temp_cnode.password, NODEMGMT_OLD_GEN_ASCII_PWD_LENGTH);
-                            temp_cnode.cust_char_password[NODEMGMT_OLD_GEN_ASCII_PWD_LENGTH] = 0;
-                        }
+                        /* Decrypt password */
+                        logic_user_decrypt_password_for_typing(&temp_cnode, &password_decrypted);
                             
                         /* Type shortcut if specified */
                         if ((shortcut_sent == FALSE) && ((keys_to_send_before_login & (LF_ENT_KEY_MASK|LF_CTRL_ALT_DEL_MASK)) != 0))
@@ -2670,34 +2793,9 @@ RET_TYPE logic_user_ask_for_credentials_keyb_output(uint16_t parent_address, uin
                         }
                             
                         /* Type password */
-                        typing_message_to_be_sent = comms_aux_mcu_get_empty_packet_ready_to_be_sent(AUX_MCU_MSG_TYPE_KEYBOARD_TYPE);
-                        typing_message_to_be_sent->payload_length1 = MEMBER_SIZE(keyboard_type_message_t, interface_identifier) + MEMBER_SIZE(keyboard_type_message_t, delay_between_types) + (utils_strlen(temp_cnode.cust_char_password) + 1 + 1)*sizeof(cust_char_t);
-                        ret_type_te string_to_key_points_transform_success = custom_fs_get_keyboard_symbols_for_unicode_string(temp_cnode.cust_char_password, typing_message_to_be_sent->keyboard_type_message.keyboard_symbols, *usb_selected);
-                        if (keys_to_send_before_login != 0x00)
-                        {
-                            /* If we came here because of the unlock feature, discard per login & general settings */
-                            typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[utils_strlen(temp_cnode.cust_char_password)] = 0x0A;
-                        }
-                        else if (temp_cnode.keyAfterPassword == 0xFFFF)
-                        {
-                            /* Use default device key press: password is 0 terminated by read function, _Static_asserts guarantees enough space, message is initialized at 0s */
-                            typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[utils_strlen(temp_cnode.cust_char_password)] = custom_fs_settings_get_device_setting(SETTINGS_CHAR_AFTER_PASS_PRESS);
-                        }
-                        else
-                        {
-                            typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[utils_strlen(temp_cnode.cust_char_password)] = temp_cnode.keyAfterPassword;
-                        }
-                        custom_fs_get_keyboard_symbols_for_unicode_string(&typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[utils_strlen(temp_cnode.cust_char_password)], &typing_message_to_be_sent->keyboard_type_message.keyboard_symbols[utils_strlen(temp_cnode.cust_char_password)], *usb_selected);
-                        typing_message_to_be_sent->keyboard_type_message.delay_between_types = custom_fs_settings_get_device_setting(SETTINGS_DELAY_BETWEEN_PRESSES);
-                        typing_message_to_be_sent->keyboard_type_message.interface_identifier = interface_id;
-                        comms_aux_mcu_send_message(typing_message_to_be_sent);
-                        
-                        /* Wait for typing status */
-                        while(comms_aux_mcu_active_wait(&temp_rx_message, AUX_MCU_MSG_TYPE_KEYBOARD_TYPE, FALSE, -1) != RETURN_OK){}
-                        could_type_all_symbols = (BOOL)temp_rx_message->payload_as_uint16[0];
-                        
-                        /* Rearm DMA RX */
-                        comms_aux_arm_rx_and_clear_no_comms();
+                        ret_type_te string_to_key_points_transform_success;
+                        typing_message_to_be_sent = logic_user_prepare_password_typing_message(&temp_cnode, interface_id, *usb_selected, keys_to_send_before_login, &string_to_key_points_transform_success);
+                        could_type_all_symbols = logic_user_send_typing_message_and_wait(typing_message_to_be_sent);
                         
                         /* Display warning if some chars were missing */
                         if ((string_to_key_points_transform_success != RETURN_OK) || (could_type_all_symbols == FALSE))
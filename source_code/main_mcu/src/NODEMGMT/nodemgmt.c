@@ -38,6 +38,26 @@
 nodemgmtHandle_t nodemgmt_current_handle;
 // Current date
 uint16_t nodemgmt_current_date;
+// Node slot usage bitmap: one bit per base node slot after the first sector, set when the slot is taken
+uint32_t nodemgmt_node_usage_bitmap[(NODEMGMT_NB_NODE_SLOTS-NODEMGMT_FIRST_NODE_SLOT+31)/32];
+// Set once the node slot usage bitmap has been built from flash contents
+BOOL nodemgmt_node_usage_bitmap_built = FALSE;
+// Service index: (list, service prefix, address) for the current user parent nodes, one entry per list & prefix, sorted by list then prefix
+nodemgmt_service_index_entry_t nodemgmt_service_index[NODEMGMT_SERVICE_INDEX_NB_ENTRIES];
+// Number of entries in the service index
+uint16_t nodemgmt_service_index_nb_entries = 0;
+// Set when the service index matches the current user database
+BOOL nodemgmt_service_index_valid = FALSE;
+// Credential ID index: open addressing hash table of the current user WebAuthn credentials
+nodemgmt_cred_id_index_entry_t nodemgmt_cred_id_index[NODEMGMT_CRED_ID_INDEX_NB_ENTRIES];
+// Number of entries in the credential ID index
+uint16_t nodemgmt_cred_id_index_nb_entries = 0;
+// Set when the credential ID index matches the current user database
+BOOL nodemgmt_cred_id_index_valid = FALSE;
+// Set when some of the current user credentials couldn't be indexed
+BOOL nodemgmt_cred_id_index_incomplete = FALSE;
+// Set when a multiple domain parent node has a service name shorter than the index prefix
+BOOL nodemgmt_service_index_short_mult_dom = FALSE;
 
 
 /*! \fn     nodemgmt_set_current_date(uint16_t date)
@@ -118,6 +138,58 @@ static inline uint16_t userIdFromFlags(uint16_t flags)
     return ((flags >> NODEMGMT_USERID_BITSHIFT) & NODEMGMT_USERID_MASK_FINAL);
 }
 
+/*! \fn     nodemgmt_update_node_usage_bitmap(uint16_t address, uint16_t flags)
+*   \brief  Update node slot usage bitmap for a given base node slot
+*   \param  address     Base node slot address
+*   \param  flags       Flags that were just written at the start of that slot
+*/
+static void nodemgmt_update_node_usage_bitmap(uint16_t address, uint16_t flags)
+{
+    uint32_t slot_index = (uint32_t)nodemgmt_page_from_address(address)*NODEMGMT_NB_NODES_PER_PAGE + nodemgmt_node_from_address(address);
+    
+    /* Boundary check, done at the flash write level anyway */
+    if ((slot_index < NODEMGMT_FIRST_NODE_SLOT) || (slot_index >= NODEMGMT_NB_NODE_SLOTS))
+    {
+        return;
+    }
+    slot_index -= NODEMGMT_FIRST_NODE_SLOT;
+    
+    /* Same logic as the one used to scan the memory */
+    if (validBitFromFlags(flags) == NODEMGMT_VBIT_VALID)
+    {
+        nodemgmt_node_usage_bitmap[slot_index/32] |= (1UL << (slot_index%32));
+    } 
+    else
+    {
+        nodemgmt_node_usage_bitmap[slot_index/32] &= ~(1UL << (slot_index%32));
+    }
+}
+
+/*! \fn     nodemgmt_build_node_usage_bitmap(void)
+*   \brief  Scan the complete DB flash to build the node slot usage bitmap
+*   \note   Only called once per boot, the bitmap is then kept in sync by our write & delete functions
+*/
+static void nodemgmt_build_node_usage_bitmap(void)
+{
+    uint16_t nodeFlags;
+    
+    // Slots in the first sector are reserved for the user profiles & bonding information, they aren't part of the bitmap
+    memset(nodemgmt_node_usage_bitmap, 0, sizeof(nodemgmt_node_usage_bitmap));
+    
+    // For each page, for each possible node in the page (changes per flash chip)
+    for (uint16_t pageItr = PAGE_PER_SECTOR; pageItr < PAGE_COUNT; pageItr++)
+    {
+        for (uint16_t nodeItr = 0; nodeItr < NODEMGMT_NB_NODES_PER_PAGE; nodeItr++)
+        {
+            // read node flags (2 bytes - fixed size)
+            dbflash_read_data_from_flash(&dbflash_descriptor, pageItr, BASE_NODE_SIZE*nodeItr, sizeof(nodeFlags), &nodeFlags);
+            nodemgmt_update_node_usage_bitmap(constructAddress(pageItr, (uint8_t)nodeItr), nodeFlags);
+        }
+    }
+    
+    nodemgmt_node_usage_bitmap_built = TRUE;
+}
+
 /*! \fn     nodemgmt_construct_date(uint16_t year, uint16_t month, uint16_t day)
 *   \brief  Packs a uint16_t type with a date code in format YYYYYYYMMMMDDDDD. Year Offset from 2010
 *   \param  year            The year to pack into the uint16_t
@@ -220,7 +292,7 @@ void nodemgmt_check_address_validity_and_lock(uint16_t node_addr)
 /*! \fn     nodemgmt_check_user_permission(uint16_t node_addr, node_type_te* node_type)
 *   \brief  Check that the user has the right to read/write a node
 *   \param  node_addr   Node address
-*   \param  node_type   Where to store the node type (see enum)
+*   \param  node_type   Where to store the node type (see enum), also stored when the node belongs to another user
 *   \return OK / NOK
 *   \note   Scanning a 8Mb Flash memory contents with that function was timed at 56ms in Debug mode.
 */
@@ -236,19 +308,25 @@ RET_TYPE nodemgmt_check_user_permission(uint16_t node_addr, node_type_te* node_t
     // Fetch the flags
     dbflash_read_data_from_flash(&dbflash_descriptor, page_addr, byte_addr, sizeof(temp_flags), (void*)&temp_flags);
     
-    // Check permission and memory boundaries (high boundary done on the lower level)
-    if ((page_addr >= PAGE_PER_SECTOR) && (nodemgmt_check_user_perm_from_flags(temp_flags) == RETURN_OK))
+    // Check memory boundaries (high boundary done on the lower level)
+    if (page_addr < PAGE_PER_SECTOR)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Store node type, so nodes of other users can be skipped when going through node slots */
+    if (validBitFromFlags(temp_flags) == NODEMGMT_VBIT_VALID)
+    {
+        *node_type = nodeTypeFromFlags(temp_flags);
+    } 
+    else
+    {
+        *node_type = NODE_TYPE_NULL;
+    }
+    
+    // Check permission
+    if (nodemgmt_check_user_perm_from_flags(temp_flags) == RETURN_OK)
     {
-        /* Store node type */
-        if (validBitFromFlags(temp_flags) == NODEMGMT_VBIT_VALID)
-        {
-            *node_type = nodeTypeFromFlags(temp_flags);
-        } 
-        else
-        {
-            *node_type = NODE_TYPE_NULL;
-        }
-        
         return RETURN_OK;        
     } 
     else
@@ -257,6 +335,27 @@ RET_TYPE nodemgmt_check_user_permission(uint16_t node_addr, node_type_te* node_t
     }
 }
 
+/*! \fn     nodemgmt_set_child_node_block_flags(child_node_t* child_node, BOOL write_category)
+*   \brief  Enforce current user ID (and category if asked) in a child node flags before writing it
+*   \param  child_node      Pointer to the node
+*   \param  write_category  Set to TRUE to write category to flags
+*/
+static void nodemgmt_set_child_node_block_flags(child_node_t* child_node, BOOL write_category)
+{
+    /* Enforce user ID */
+    nodemgmt_user_id_to_flags(&(child_node->cred_child.flags), nodemgmt_current_handle.currentUserId);
+    nodemgmt_user_id_to_flags(&(child_node->cred_child.fakeFlags), nodemgmt_current_handle.currentUserId);
+    child_node->cred_child.fakeFlags |= (NODEMGMT_VBIT_INVALID << NODEMGMT_CORRECT_FLAGS_BIT_BITSHIFT);
+    
+    /* Write category flags if we're asked */
+    if (write_category != FALSE)
+    {
+        // CATSEARCHLOGIC
+        nodemgmt_categoryflags_to_flags(&(child_node->cred_child.flags), nodemgmt_current_handle.currentCategoryFlags);
+        nodemgmt_categoryflags_to_flags(&(child_node->cred_child.fakeFlags), nodemgmt_current_handle.currentCategoryFlags);
+    }
+}
+
 /*! \fn     nodemgmt_write_parent_node_data_block_to_flash(uint16_t address, parent_node_t* parent_node)
 *   \brief  Write a parent node data block to flash
 *   \param  address     Where to write
@@ -268,6 +367,7 @@ void nodemgmt_write_parent_node_data_block_to_flash(uint16_t address, parent_nod
     nodemgmt_check_address_validity_and_lock(address);
     nodemgmt_user_id_to_flags(&(parent_node->cred_parent.flags), nodemgmt_current_handle.currentUserId);
     dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), BASE_NODE_SIZE, (void*)parent_node->node_as_bytes);
+    nodemgmt_update_node_usage_bitmap(address, parent_node->cred_parent.flags);
 }
 
 /*! \fn     nodemgmt_write_child_node_block_to_flash(uint16_t address, child_node_t* child_node, BOOL write_category)
@@ -280,22 +380,162 @@ void nodemgmt_write_child_node_block_to_flash(uint16_t address, child_node_t* ch
 {
     /* Enforce user ID */
     _Static_assert(2*BASE_NODE_SIZE == sizeof(*child_node), "Child node isn't twice the size of base node size");
-    nodemgmt_user_id_to_flags(&(child_node->cred_child.flags), nodemgmt_current_handle.currentUserId);
-    nodemgmt_user_id_to_flags(&(child_node->cred_child.fakeFlags), nodemgmt_current_handle.currentUserId);
-    child_node->cred_child.fakeFlags |= (NODEMGMT_VBIT_INVALID << NODEMGMT_CORRECT_FLAGS_BIT_BITSHIFT);
-    
-    /* Write category flags if we're asked */
-    if (write_category != FALSE)
-    {
-        // CATSEARCHLOGIC
-        nodemgmt_categoryflags_to_flags(&(child_node->cred_child.flags), nodemgmt_current_handle.currentCategoryFlags);
-        nodemgmt_categoryflags_to_flags(&(child_node->cred_child.fakeFlags), nodemgmt_current_handle.currentCategoryFlags);
-    }
+    nodemgmt_set_child_node_block_flags(child_node, write_category);
     
     /* Write to flash */
     nodemgmt_check_address_validity_and_lock(address);
     dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE * nodemgmt_node_from_address(address), BASE_NODE_SIZE, (void*)child_node->node_as_bytes);
     dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(nodemgmt_get_incremented_address(address)), BASE_NODE_SIZE * nodemgmt_node_from_address(nodemgmt_get_incremented_address(address)), BASE_NODE_SIZE, (void*)(&child_node->node_as_bytes[BASE_NODE_SIZE]));
+    nodemgmt_update_node_usage_bitmap(nodemgmt_get_incremented_address(address), child_node->cred_child.fakeFlags);
+    nodemgmt_update_node_usage_bitmap(address, child_node->cred_child.flags);
+}
+
+/*! \fn     nodemgmt_write_node_blocks_to_flash_in_page_order(uint16_t nb_nodes, uint16_t* addresses, uint16_t* node_sizes, uint8_t** nodes)
+*   \brief  Write a set of parent / child node blocks in page order, nodes sharing a page being written with a single page program
+*   \param  nb_nodes    Number of nodes
+*   \param  addresses   Node addresses (sorted in place along with the two other arrays)
+*   \param  node_sizes  Node sizes: sizeof(parent_node_t) or sizeof(child_node_t)
+*   \param  nodes       Pointers to the node blocks
+*   \note   User permissions for all the node slots should have been checked by the caller
+*/
+void nodemgmt_write_node_blocks_to_flash_in_page_order(uint16_t nb_nodes, uint16_t* addresses, uint16_t* node_sizes, uint8_t** nodes)
+{
+    uint8_t page_buffer[BYTES_PER_PAGE];
+    uint16_t node_index = 0;
+    
+    /* Sort by address, which is also page order: only a few nodes per call */
+    for (uint16_t i = 1; i < nb_nodes; i++)
+    {
+        for (uint16_t j = i; (j > 0) && (addresses[j-1] > addresses[j]); j--)
+        {
+            uint16_t temp_address = addresses[j];
+            uint16_t temp_size = node_sizes[j];
+            uint8_t* temp_node_pt = nodes[j];
+            addresses[j] = addresses[j-1];
+            node_sizes[j] = node_sizes[j-1];
+            nodes[j] = nodes[j-1];
+            addresses[j-1] = temp_address;
+            node_sizes[j-1] = temp_size;
+            nodes[j-1] = temp_node_pt;
+        }
+    }
+    
+    while (node_index < nb_nodes)
+    {
+        uint16_t page_number = nodemgmt_page_from_address(addresses[node_index]);
+        BOOL page_modified = FALSE;
+        
+        /* Build the new page contents from all the nodes fully stored inside it */
+        dbflash_read_data_from_flash(&dbflash_descriptor, page_number, 0, sizeof(page_buffer), (void*)page_buffer);
+        while ((node_index < nb_nodes) && (nodemgmt_page_from_address(addresses[node_index]) == page_number))
+        {
+            uint16_t page_offset = BASE_NODE_SIZE * nodemgmt_node_from_address(addresses[node_index]);
+            nodemgmt_check_address_validity_and_lock(addresses[node_index]);
+            
+            if (node_sizes[node_index] == sizeof(parent_node_t))
+            {
+                parent_node_t* parent_node_pt = (parent_node_t*)nodes[node_index];
+                nodemgmt_user_id_to_flags(&(parent_node_pt->cred_parent.flags), nodemgmt_current_handle.currentUserId);
+                memcpy(&page_buffer[page_offset], parent_node_pt->node_as_bytes, BASE_NODE_SIZE);
+                nodemgmt_update_node_usage_bitmap(addresses[node_index], parent_node_pt->cred_parent.flags);
+            }
+            else if (page_offset + sizeof(child_node_t) <= sizeof(page_buffer))
+            {
+                /* Child node fully stored inside this page (never the case with our 264B pages & nodes) */
+                child_node_t* child_node_pt = (child_node_t*)nodes[node_index];
+                nodemgmt_set_child_node_block_flags(child_node_pt, FALSE);
+                memcpy(&page_buffer[page_offset], child_node_pt->node_as_bytes, sizeof(child_node_t));
+                nodemgmt_update_node_usage_bitmap(nodemgmt_get_incremented_address(addresses[node_index]), child_node_pt->cred_child.fakeFlags);
+                nodemgmt_update_node_usage_bitmap(addresses[node_index], child_node_pt->cred_child.flags);
+            }
+            else
+            {
+                /* Child node spanning over the next page: last node in this page, written after it */
+                break;
+            }
+            
+            page_modified = TRUE;
+            node_index++;
+        }
+        
+        /* Full page write: no page read-modify-write inside the flash */
+        if (page_modified != FALSE)
+        {
+            dbflash_write_data_to_flash(&dbflash_descriptor, page_number, 0, sizeof(page_buffer), (void*)page_buffer);
+        }
+        
+        /* Child node spanning over two pages */
+        if ((node_index < nb_nodes) && (nodemgmt_page_from_address(addresses[node_index]) == page_number))
+        {
+            nodemgmt_write_child_node_block_to_flash(addresses[node_index], (child_node_t*)nodes[node_index], FALSE);
+            node_index++;
+        }
+    }
+}
+
+/*! \fn     nodemgmt_get_next_user_node_address(uint16_t address, node_type_te* node_type)
+*   \brief  Find the first node belonging to the current user, starting at a given address
+*   \param  address     Address to start looking from (included)
+*   \param  node_type   Where to store the found node type
+*   \return Node address, NODE_ADDR_NULL if none was found
+*   \note   Free slots are skipped using the node usage bitmap, second halves of child nodes are skipped
+*/
+uint16_t nodemgmt_get_next_user_node_address(uint16_t address, node_type_te* node_type)
+{
+    uint16_t nodeFlags;
+    uint32_t usageWord;
+    uint32_t slotItr;
+    
+    // First call since boot: scan the memory to build our bitmap
+    if (nodemgmt_node_usage_bitmap_built == FALSE)
+    {
+        nodemgmt_build_node_usage_bitmap();
+    }
+    
+    // Slots in the first sector aren't nodes
+    slotItr = (uint32_t)nodemgmt_page_from_address(address)*NODEMGMT_NB_NODES_PER_PAGE + nodemgmt_node_from_address(address);
+    if (slotItr < NODEMGMT_FIRST_NODE_SLOT)
+    {
+        slotItr = NODEMGMT_FIRST_NODE_SLOT;
+    }
+    
+    // Browse our bitmap from the start slot
+    while (slotItr < NODEMGMT_NB_NODE_SLOTS)
+    {
+        // Fetch the usage word, flagging the slots before our current one as free
+        usageWord = nodemgmt_node_usage_bitmap[(slotItr-NODEMGMT_FIRST_NODE_SLOT)/32] & ~((1UL << (slotItr%32)) - 1);
+        
+        // All slots free: skip the complete word
+        if (usageWord == 0)
+        {
+            slotItr = (slotItr | 31) + 1;
+            continue;
+        }
+        
+        // Go to the first used slot in that word
+        while ((usageWord & (1UL << (slotItr%32))) == 0)
+        {
+            slotItr++;
+        }
+        
+        // Slots beyond our last page
+        if (slotItr >= NODEMGMT_NB_NODE_SLOTS)
+        {
+            break;
+        }
+        
+        // Check that it is the start of one of our nodes
+        dbflash_read_data_from_flash(&dbflash_descriptor, (uint16_t)(slotItr/NODEMGMT_NB_NODES_PER_PAGE), BASE_NODE_SIZE*(slotItr%NODEMGMT_NB_NODES_PER_PAGE), sizeof(nodeFlags), &nodeFlags);
+        if ((userIdFromFlags(nodeFlags) == nodemgmt_current_handle.currentUserId) && (correctFlagsBitFromFlags(nodeFlags) == NODEMGMT_VBIT_VALID))
+        {
+            *node_type = nodeTypeFromFlags(nodeFlags);
+            return constructAddress((uint16_t)(slotItr/NODEMGMT_NB_NODES_PER_PAGE), (uint8_t)(slotItr%NODEMGMT_NB_NODES_PER_PAGE));
+        }
+        
+        slotItr++;
+    }
+    
+    return NODE_ADDR_NULL;
 }
 
 /*! \fn     nodemgmt_read_parent_node_data_block_from_flash(uint16_t address, parent_node_t* parent_node)
@@ -1541,6 +1781,9 @@ void nodemgmt_set_data_start_address(uint16_t dataParentAddress, uint16_t typeId
  */
 void nodemgmt_set_start_addresses(uint16_t* addresses_array)
 {
+    // Lists were externally modified
+    nodemgmt_invalidate_service_index();
+    
     // Update handle    
     memcpy(nodemgmt_current_handle.firstCredParentNodes, addresses_array, MEMBER_SIZE(nodemgmt_profile_main_data_t, cred_start_addresses));
     memcpy(nodemgmt_current_handle.firstDataParentNodes, &(addresses_array[MEMBER_ARRAY_SIZE(nodemgmt_profile_main_data_t, cred_start_addresses)]), MEMBER_SIZE(nodemgmt_profile_main_data_t, data_start_addresses));
@@ -1741,6 +1984,15 @@ uint16_t nodemgmt_get_favorites(uint16_t* addresses_array)
     return MEMBER_SIZE(nodemgmt_userprofile_t,category_favorites)/sizeof(favorite_addr_t);
 }
 
+/*! \fn     nodemgmt_set_favorites(uint16_t* addresses_array)
+ *  \brief  Set all favorites at once
+ *  \param  addresses_array     Favorites, in the format returned by nodemgmt_get_favorites
+ */
+void nodemgmt_set_favorites(uint16_t* addresses_array)
+{
+    dbflash_write_data_to_flash(&dbflash_descriptor, nodemgmt_current_handle.pageUserProfile, nodemgmt_current_handle.offsetUserProfile + (size_t)offsetof(nodemgmt_userprofile_t, category_favorites), MEMBER_SIZE(nodemgmt_userprofile_t,category_favorites), (void*)addresses_array);
+}
+
 /*! \fn     nodemgmt_read_profile_ctr(void* buf)
  *  \brief  Reads the users base CTR from the user profile flash memory
  *  \param  buf             The buffer to store the read CTR
@@ -1828,72 +2080,93 @@ uint16_t nodemgmt_find_free_nodes(uint16_t nbParentNodes, uint16_t* parentNodeAr
     uint16_t prevFreeAddressFound = NODE_ADDR_NULL;
     uint16_t nbParentNodesFound = 0;
     uint16_t nbChildNodesFound = 0;
-    uint16_t nodeFlags;
-    uint16_t pageItr;
-    uint16_t nodeItr;
+    uint32_t prevFreeSlotFound = 0;
+    uint16_t freeAddressFound;
+    uint32_t usageWord;
+    uint32_t slotItr;
     
 #ifdef EMULATOR_BUILD
     if(emu_get_failure_flags() & EMU_FAIL_DBFLASH_FULL)
         return 0;
 #endif
 
+    // Nothing to look for
+    if ((nbParentNodes == 0) && (nbChildtNodes == 0))
+    {
+        return 0;
+    }
+    
+    // First call since boot: scan the memory to build our bitmap
+    if (nodemgmt_node_usage_bitmap_built == FALSE)
+    {
+        nodemgmt_build_node_usage_bitmap();
+    }
+
     // Check the start page
     if (startPage < PAGE_PER_SECTOR)
     {
         startPage = PAGE_PER_SECTOR;
     }
 
-    // for each page
-    for(pageItr = startPage; pageItr < PAGE_COUNT; pageItr++)
+    // Browse our bitmap from the start slot
+    slotItr = (uint32_t)startPage*NODEMGMT_NB_NODES_PER_PAGE + startNode;
+    while (slotItr < NODEMGMT_NB_NODE_SLOTS)
     {
-        // for each possible parent node in the page (changes per flash chip)
-        for(nodeItr = startNode; nodeItr < BYTES_PER_PAGE/BASE_NODE_SIZE; nodeItr++)
+        // Fetch the usage word, flagging the slots before our current one as taken
+        usageWord = nodemgmt_node_usage_bitmap[(slotItr-NODEMGMT_FIRST_NODE_SLOT)/32] | ((1UL << (slotItr%32)) - 1);
+        
+        // All slots taken: skip the complete word
+        if (usageWord == UINT32_MAX)
         {
-            // read node flags (2 bytes - fixed size)
-            dbflash_read_data_from_flash(&dbflash_descriptor, pageItr, BASE_NODE_SIZE*nodeItr, sizeof(nodeFlags), &nodeFlags);
+            slotItr = (slotItr | 31) + 1;
+            continue;
+        }
+        
+        // Go to the first free slot in that word
+        while ((usageWord & (1UL << (slotItr%32))) != 0)
+        {
+            slotItr++;
+        }
+        
+        // Slots beyond our last page
+        if (slotItr >= NODEMGMT_NB_NODE_SLOTS)
+        {
+            break;
+        }
+        freeAddressFound = constructAddress((uint16_t)(slotItr/NODEMGMT_NB_NODES_PER_PAGE), (uint8_t)(slotItr%NODEMGMT_NB_NODES_PER_PAGE));
+        
+        // fill parent nodes first (only one block)
+        if (nbParentNodesFound != nbParentNodes)
+        {
+            parentNodeArray[nbParentNodesFound++] = freeAddressFound;
             
-            // If this slot is OK
-            if(validBitFromFlags(nodeFlags) == NODEMGMT_VBIT_INVALID)
+            // check for end
+            if ((nbChildtNodes == 0) && (nbParentNodesFound == nbParentNodes))
             {
-                // fill parent nodes first (only one block)
-                if (nbParentNodesFound != nbParentNodes)
-                {
-                    parentNodeArray[nbParentNodesFound++] = constructAddress(pageItr, nodeItr);
-                    
-                    // check for end
-                    if ((nbChildtNodes == 0) && (nbParentNodesFound == nbParentNodes))
-                    {
-                        return nbChildNodesFound+nbParentNodesFound;
-                    }
-                } 
-                else
-                {
-                    if (prevFreeAddressFound == NODE_ADDR_NULL)
-                    {
-                        // Store address if the next free block found is available
-                        prevFreeAddressFound = constructAddress(pageItr, nodeItr);
-                    } 
-                    else
-                    {
-                        childNodeArray[nbChildNodesFound++] = prevFreeAddressFound;
-                        prevFreeAddressFound = NODE_ADDR_NULL;
-                        
-                        // check for end
-                        if (nbChildNodesFound == nbChildtNodes)
-                        {
-                            return nbChildNodesFound+nbParentNodesFound;
-                        }
-                    }
-                }
+                return nbChildNodesFound+nbParentNodesFound;
             }
-            else
+        }
+        else if ((prevFreeAddressFound != NODE_ADDR_NULL) && (prevFreeSlotFound + 1 == slotItr))
+        {
+            // Two contiguous free slots: child node found
+            childNodeArray[nbChildNodesFound++] = prevFreeAddressFound;
+            prevFreeAddressFound = NODE_ADDR_NULL;
+            
+            // check for end
+            if (nbChildNodesFound == nbChildtNodes)
             {
-                // block found isn't available, reset flag
-                prevFreeAddressFound = NODE_ADDR_NULL;
+                return nbChildNodesFound+nbParentNodesFound;
             }
         }
-        startNode = 0;
-    }    
+        else
+        {
+            // Store address in case the next slot is available
+            prevFreeAddressFound = freeAddressFound;
+            prevFreeSlotFound = slotItr;
+        }
+        
+        slotItr++;
+    }
     
     return nbChildNodesFound+nbParentNodesFound;
 }
@@ -2180,6 +2453,640 @@ void nodemgmt_fetch_favorites_filtered_by_cat_sorted(favorite_addr_t* favorite_a
     }
 }   
     
+/*! \fn     nodemgmt_get_service_index_prefix(cust_char_t* service, cust_char_t* prefix)
+ *  \brief  Get the service index prefix for a given service name
+ *  \param  service     Service name, at least NODEMGMT_SERVICE_INDEX_PREFIX_LEN characters long or 0 terminated
+ *  \param  prefix      Where to store the 0 padded prefix
+ *  \return TRUE if the service name is shorter than the prefix
+ */
+static BOOL nodemgmt_get_service_index_prefix(cust_char_t* service, cust_char_t* prefix)
+{
+    BOOL string_terminated = FALSE;
+    
+    /* Characters after the terminating 0 aren't taken into account by utils_custchar_strncmp */
+    for (uint16_t i = 0; i < NODEMGMT_SERVICE_INDEX_PREFIX_LEN; i++)
+    {
+        if ((string_terminated == FALSE) && (service[i] == 0))
+        {
+            string_terminated = TRUE;
+        }
+        prefix[i] = (string_terminated == FALSE)? service[i] : 0;
+    }
+    
+    return string_terminated;
+}
+
+/*! \fn     nodemgmt_get_service_index_position(uint16_t list_id, cust_char_t* prefix, BOOL after_equal_keys)
+ *  \brief  Binary search the service index for a given list & prefix
+ *  \param  list_id             List ID
+ *  \param  prefix              Service prefix
+ *  \param  after_equal_keys    Set to TRUE to get the position after the entries having the same list & prefix
+ *  \return Position of the first entry greater or equal (greater if after_equal_keys is set) than the list & prefix
+ */
+static uint16_t nodemgmt_get_service_index_position(uint16_t list_id, cust_char_t* prefix, BOOL after_equal_keys)
+{
+    uint16_t high = nodemgmt_service_index_nb_entries;
+    uint16_t low = 0;
+    
+    while (low < high)
+    {
+        uint16_t middle = (low + high) / 2;
+        int16_t compare_result;
+        
+        /* Sort by list first, then by prefix */
+        if (nodemgmt_service_index[middle].list_id != list_id)
+        {
+            compare_result = (nodemgmt_service_index[middle].list_id < list_id)? -1 : 1;
+        }
+        else
+        {
+            compare_result = utils_custchar_strncmp(nodemgmt_service_index[middle].prefix, prefix, NODEMGMT_SERVICE_INDEX_PREFIX_LEN);
+        }
+        
+        if ((compare_result < 0) || ((compare_result == 0) && (after_equal_keys != FALSE)))
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    
+    return low;
+}
+
+/*! \fn     nodemgmt_read_parent_node_index_fields(uint16_t address, uint16_t list_id, uint16_t* flags, uint16_t* next_parent_address, cust_char_t* service_start)
+ *  \brief  Read the first bytes of a parent node, up to the service prefix, and check it belongs to a given list
+ *  \param  address             Parent node address
+ *  \param  list_id             List ID
+ *  \param  flags               Where to store the node flags
+ *  \param  next_parent_address Where to store the next parent address
+ *  \param  service_start       Where to store the first NODEMGMT_SERVICE_INDEX_PREFIX_LEN service characters
+ *  \return RETURN_OK if the node is a valid parent node of the current user for that list
+ */
+static RET_TYPE nodemgmt_read_parent_node_index_fields(uint16_t address, uint16_t list_id, uint16_t* flags, uint16_t* next_parent_address, cust_char_t* service_start)
+{
+    _Static_assert(offsetof(parent_cred_node_t, service) == offsetof(parent_data_node_t, service), "Incorrect reuse of parent node structure");
+    _Static_assert(offsetof(parent_cred_node_t, nextParentAddress) == offsetof(parent_data_node_t, nextParentAddress), "Incorrect reuse of parent node structure");
+    node_type_te expected_node_type = (list_id < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes))? NODE_TYPE_PARENT : NODE_TYPE_PARENT_DATA;
+    uint8_t node_start[offsetof(parent_cred_node_t, service) + NODEMGMT_SERVICE_INDEX_PREFIX_LEN*sizeof(cust_char_t)];
+    
+    /* Check for correct address */
+    if (nodemgmt_check_address_validity(address) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Read flags, prev/next address, first child address and service prefix */
+    dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE*nodemgmt_node_from_address(address), sizeof(node_start), (void*)node_start);
+    memcpy(flags, &node_start[offsetof(parent_cred_node_t, flags)], sizeof(*flags));
+    memcpy(next_parent_address, &node_start[offsetof(parent_cred_node_t, nextParentAddress)], sizeof(*next_parent_address));
+    memcpy(service_start, &node_start[offsetof(parent_cred_node_t, service)], NODEMGMT_SERVICE_INDEX_PREFIX_LEN*sizeof(cust_char_t));
+    
+    /* Check ownership & type */
+    if ((nodemgmt_check_user_perm_from_flags(*flags) != RETURN_OK) || (nodeTypeFromFlags(*flags) != expected_node_type))
+    {
+        return RETURN_NOK;
+    }
+    
+    return RETURN_OK;
+}
+
+/*! \fn     nodemgmt_compact_service_index(void)
+ *  \brief  Drop every other entry for each list of the service index
+ *  \note   The first entry of each list is kept. Remaining entries still are valid starting points for a search
+ */
+static void nodemgmt_compact_service_index(void)
+{
+    uint16_t prev_list_id = UINT16_MAX;
+    uint16_t nb_entries_kept = 0;
+    uint16_t list_position = 0;
+    
+    for (uint16_t i = 0; i < nodemgmt_service_index_nb_entries; i++)
+    {
+        /* New list? */
+        if (nodemgmt_service_index[i].list_id != prev_list_id)
+        {
+            prev_list_id = nodemgmt_service_index[i].list_id;
+            list_position = 0;
+        }
+        
+        /* Keep even positions */
+        if ((list_position++ & 0x01) == 0)
+        {
+            nodemgmt_service_index[nb_entries_kept++] = nodemgmt_service_index[i];
+        }
+    }
+    
+    nodemgmt_service_index_nb_entries = nb_entries_kept;
+}
+
+/*! \fn     nodemgmt_add_to_service_index(uint16_t address, uint16_t list_id, cust_char_t* service, uint16_t flags, BOOL replace_existing)
+ *  \brief  Add a parent node to the service index
+ *  \param  address             Parent node address
+ *  \param  list_id             List ID
+ *  \param  service             Parent node service name
+ *  \param  flags               Parent node flags
+ *  \param  replace_existing    Set to TRUE if the parent node comes after the one already indexed for the same prefix
+ *  \note   Only one parent node is kept per list & prefix, ideally the last one: lookups then start right before the first parent having the next prefix
+ */
+static void nodemgmt_add_to_service_index(uint16_t address, uint16_t list_id, cust_char_t* service, uint16_t flags, BOOL replace_existing)
+{
+    cust_char_t prefix[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    BOOL short_service = nodemgmt_get_service_index_prefix(service, prefix);
+    uint16_t position;
+    
+    /* Will be rebuilt anyway */
+    if (nodemgmt_service_index_valid == FALSE)
+    {
+        return;
+    }
+    
+    /* Multiple domain parents shorter than the prefix may be matched before our search starting point */
+    if ((list_id < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes)) && ((flags & NODEMGMT_MULT_DOMAIN_FLAG) != 0) && (short_service != FALSE))
+    {
+        nodemgmt_service_index_short_mult_dom = TRUE;
+    }
+    
+    /* Prefix already indexed? Any parent node carrying it is a valid search starting point */
+    position = nodemgmt_get_service_index_position(list_id, prefix, TRUE);
+    if ((position != 0) && (nodemgmt_service_index[position-1].list_id == list_id) && (utils_custchar_strncmp(nodemgmt_service_index[position-1].prefix, prefix, NODEMGMT_SERVICE_INDEX_PREFIX_LEN) == 0))
+    {
+        if (replace_existing != FALSE)
+        {
+            nodemgmt_service_index[position-1].address = address;
+        }
+        return;
+    }
+    
+    /* Make space if needed */
+    if (nodemgmt_service_index_nb_entries == NODEMGMT_SERVICE_INDEX_NB_ENTRIES)
+    {
+        nodemgmt_compact_service_index();
+        position = nodemgmt_get_service_index_position(list_id, prefix, TRUE);
+    }
+    
+    /* Insert new entry */
+    memmove(&nodemgmt_service_index[position+1], &nodemgmt_service_index[position], (nodemgmt_service_index_nb_entries - position)*sizeof(nodemgmt_service_index[0]));
+    memcpy(nodemgmt_service_index[position].prefix, prefix, sizeof(prefix));
+    nodemgmt_service_index[position].list_id = list_id;
+    nodemgmt_service_index[position].address = address;
+    nodemgmt_service_index_nb_entries++;
+}
+
+/*! \fn     nodemgmt_remove_from_service_index(uint16_t address, uint16_t prev_address)
+ *  \brief  Remove a deleted parent node from the service index
+ *  \param  address         Deleted parent node address
+ *  \param  prev_address    Address of the parent node that was before it
+ *  \note   If the previous parent node has the same prefix, it takes over the index entry
+ */
+static void nodemgmt_remove_from_service_index(uint16_t address, uint16_t prev_address)
+{
+    cust_char_t service_start[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    cust_char_t prefix[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    uint16_t parent_next_addr;
+    uint16_t parent_flags;
+    
+    for (uint16_t i = 0; i < nodemgmt_service_index_nb_entries; i++)
+    {
+        if (nodemgmt_service_index[i].address == address)
+        {
+            /* Previous parent node with the same prefix? */
+            if (nodemgmt_read_parent_node_index_fields(prev_address, nodemgmt_service_index[i].list_id, &parent_flags, &parent_next_addr, service_start) == RETURN_OK)
+            {
+                nodemgmt_get_service_index_prefix(service_start, prefix);
+                if (utils_custchar_strncmp(nodemgmt_service_index[i].prefix, prefix, NODEMGMT_SERVICE_INDEX_PREFIX_LEN) == 0)
+                {
+                    nodemgmt_service_index[i].address = prev_address;
+                    return;
+                }
+            }
+            
+            memmove(&nodemgmt_service_index[i], &nodemgmt_service_index[i+1], (nodemgmt_service_index_nb_entries - i - 1)*sizeof(nodemgmt_service_index[0]));
+            nodemgmt_service_index_nb_entries--;
+            return;
+        }
+    }
+}
+
+/*! \fn     nodemgmt_build_service_index(void)
+ *  \brief  Go through all the current user parent nodes to build the service index
+ *  \note   Only the node first bytes are read. If a list has more service prefixes than the index can hold, only a subset of them is indexed
+ */
+static void nodemgmt_build_service_index(void)
+{
+    cust_char_t last_prefix_encountered[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    cust_char_t service_start[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    cust_char_t prefix[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    uint16_t next_parent_addr;
+    uint16_t parent_next_addr;
+    uint16_t parent_flags;
+    
+    /* Start from scratch */
+    nodemgmt_service_index_short_mult_dom = FALSE;
+    nodemgmt_service_index_nb_entries = 0;
+    nodemgmt_service_index_valid = TRUE;
+    
+    /* Credential lists first, then data lists */
+    for (uint16_t list_id = 0; list_id < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes); list_id++)
+    {
+        if (list_id < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes))
+        {
+            next_parent_addr = nodemgmt_current_handle.firstCredParentNodes[list_id];
+        }
+        else
+        {
+            next_parent_addr = nodemgmt_current_handle.firstDataParentNodes[list_id-MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes)];
+        }
+        memset(last_prefix_encountered, 0, sizeof(last_prefix_encountered));
+        
+        /* Bounded loop in case of corrupted database */
+        for (uint32_t nb_parents = 0; (next_parent_addr != NODE_ADDR_NULL) && (nb_parents < NODEMGMT_NB_NODE_SLOTS); nb_parents++)
+        {
+            /* Stop at invalid nodes, list will only be partially indexed */
+            if (nodemgmt_read_parent_node_index_fields(next_parent_addr, list_id, &parent_flags, &parent_next_addr, service_start) != RETURN_OK)
+            {
+                break;
+            }
+            
+            /* Check for alphabetical order */
+            nodemgmt_get_service_index_prefix(service_start, prefix);
+            if (utils_custchar_strncmp(last_prefix_encountered, prefix, NODEMGMT_SERVICE_INDEX_PREFIX_LEN) > 0)
+            {
+                break;
+            }
+            memcpy(last_prefix_encountered, prefix, sizeof(prefix));
+            
+            /* Add to index (list is walked in order: last parent with a given prefix wins) and move to next node */
+            nodemgmt_add_to_service_index(next_parent_addr, list_id, service_start, parent_flags, TRUE);
+            next_parent_addr = parent_next_addr;
+        }
+    }
+}
+
+/*! \fn     nodemgmt_invalidate_service_index(void)
+ *  \brief  Invalidate the service index, to be called when the database is externally modified
+ *  \note   Index will be rebuilt on next use
+ */
+void nodemgmt_invalidate_service_index(void)
+{
+    nodemgmt_service_index_valid = FALSE;
+}
+
+/*! \fn     nodemgmt_get_service_index_lower_parent(uint16_t list_id, cust_char_t* service)
+ *  \brief  Use the service index to find a parent node alphabetically before a given service
+ *  \param  list_id     List ID
+ *  \param  service     Service name
+ *  \return Address of the last indexed parent node with a prefix strictly lower than the service (confirmed with one flash read), NODE_ADDR_NULL otherwise
+ *  \note   Parent nodes before the returned one can't match the service, nor be the parent after which it should be inserted
+ */
+static uint16_t nodemgmt_get_service_index_lower_parent(uint16_t list_id, cust_char_t* service)
+{
+    cust_char_t service_start[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    cust_char_t prefix[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];
+    nodemgmt_service_index_entry_t* candidate_entry;
+    uint16_t parent_next_addr;
+    uint16_t parent_flags;
+    uint16_t position;
+    
+    /* Boundary checks */
+    if (list_id >= MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes))
+    {
+        return NODE_ADDR_NULL;
+    }
+    
+    /* Database was externally changed */
+    if (nodemgmt_service_index_valid == FALSE)
+    {
+        nodemgmt_build_service_index();
+    }
+    
+    /* Last indexed parent whose prefix is strictly lower than our service */
+    nodemgmt_get_service_index_prefix(service, prefix);
+    position = nodemgmt_get_service_index_position(list_id, prefix, FALSE);
+    if ((position == 0) || (nodemgmt_service_index[position-1].list_id != list_id))
+    {
+        return NODE_ADDR_NULL;
+    }
+    candidate_entry = &nodemgmt_service_index[position-1];
+    
+    /* Confirm the index is in sync with flash contents */
+    if (nodemgmt_read_parent_node_index_fields(candidate_entry->address, list_id, &parent_flags, &parent_next_addr, service_start) != RETURN_OK)
+    {
+        nodemgmt_invalidate_service_index();
+        return NODE_ADDR_NULL;
+    }
+    nodemgmt_get_service_index_prefix(service_start, prefix);
+    if (utils_custchar_strncmp(candidate_entry->prefix, prefix, NODEMGMT_SERVICE_INDEX_PREFIX_LEN) != 0)
+    {
+        nodemgmt_invalidate_service_index();
+        return NODE_ADDR_NULL;
+    }
+    
+    return candidate_entry->address;
+}
+
+/*! \fn     nodemgmt_get_service_index_start_addr(cust_char_t* service, BOOL cred_type, uint16_t typeId, BOOL mult_domain_possible)
+ *  \brief  Use the service index to get the address from which to start looking for a given service
+ *  \param  service                 Service name we are looking for
+ *  \param  cred_type               TRUE for credential parents, FALSE for data parents
+ *  \param  typeId                  Credential / Data Type ID
+ *  \param  mult_domain_possible    Set to TRUE if the search may match a multiple domain parent
+ *  \return Address of a parent node alphabetically before the service, otherwise first parent address
+ */
+uint16_t nodemgmt_get_service_index_start_addr(cust_char_t* service, BOOL cred_type, uint16_t typeId, BOOL mult_domain_possible)
+{
+    uint16_t first_parent_addr;
+    uint16_t lower_parent_addr;
+    uint16_t list_id;
+    
+    /* Fallback address: start of the list */
+    if (cred_type != FALSE)
+    {
+        first_parent_addr = nodemgmt_get_starting_parent_addr(typeId);
+        list_id = typeId;
+    }
+    else
+    {
+        first_parent_addr = nodemgmt_get_starting_data_parent_addr(typeId);
+        list_id = MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + typeId;
+    }
+    
+    /* Empty list */
+    if (first_parent_addr == NODE_ADDR_NULL)
+    {
+        return NODE_ADDR_NULL;
+    }
+    
+    /* Look into the index */
+    lower_parent_addr = nodemgmt_get_service_index_lower_parent(list_id, service);
+    
+    /* Short multiple domain parents can't be located using the index: flag may only be set once the index is built */
+    if ((lower_parent_addr == NODE_ADDR_NULL) || ((mult_domain_possible != FALSE) && (nodemgmt_service_index_short_mult_dom != FALSE)))
+    {
+        return first_parent_addr;
+    }
+    
+    return lower_parent_addr;
+}
+
+/*! \fn     nodemgmt_read_webauthn_child_index_fields(uint16_t address, uint16_t* next_child_address, uint8_t* credential_id)
+ *  \brief  Read the next child address and the credential ID of a WebAuthn child node
+ *  \param  address             Child node address
+ *  \param  next_child_address  Where to store the next child address
+ *  \param  credential_id       Where to store the credential ID
+ *  \return RETURN_OK if the node is a valid child node of the current user
+ */
+static RET_TYPE nodemgmt_read_webauthn_child_index_fields(uint16_t address, uint16_t* next_child_address, uint8_t* credential_id)
+{
+    _Static_assert((offsetof(child_webauthn_node_t, credential_id) >= BASE_NODE_SIZE) || (offsetof(child_webauthn_node_t, credential_id) + MEMBER_SIZE(child_webauthn_node_t, credential_id) <= BASE_NODE_SIZE), "Credential ID spans over two node slots");
+    uint8_t node_start[offsetof(child_webauthn_node_t, nextChildAddress) + MEMBER_SIZE(child_webauthn_node_t, nextChildAddress)];
+    uint16_t credential_id_offset = offsetof(child_webauthn_node_t, credential_id);
+    uint16_t credential_id_address = address;
+    uint16_t flags;
+    
+    /* Check for correct address */
+    if (nodemgmt_check_address_validity(address) != RETURN_OK)
+    {
+        return RETURN_NOK;
+    }
+    
+    /* Read flags, prev/next address and check ownership & type */
+    dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(address), BASE_NODE_SIZE*nodemgmt_node_from_address(address), sizeof(node_start), (void*)node_start);
+    memcpy(&flags, &node_start[offsetof(child_webauthn_node_t, flags)], sizeof(flags));
+    if ((validBitFromFlags(flags) != NODEMGMT_VBIT_VALID) || (nodemgmt_check_user_perm_from_flags(flags) != RETURN_OK) || (nodeTypeFromFlags(flags) != NODE_TYPE_CHILD))
+    {
+        return RETURN_NOK;
+    }
+    memcpy(next_child_address, &node_start[offsetof(child_webauthn_node_t, nextChildAddress)], sizeof(*next_child_address));
+    
+    /* Credential ID may be in the second node slot */
+    if (credential_id_offset >= BASE_NODE_SIZE)
+    {
+        credential_id_address = nodemgmt_get_incremented_address(address);
+        credential_id_offset -= BASE_NODE_SIZE;
+    }
+    dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(credential_id_address), BASE_NODE_SIZE*nodemgmt_node_from_address(credential_id_address) + credential_id_offset, MEMBER_SIZE(child_webauthn_node_t, credential_id), (void*)credential_id);
+    
+    return RETURN_OK;
+}
+
+/*! \fn     nodemgmt_add_to_cred_id_index(uint16_t parent_address, uint16_t child_address, uint8_t* credential_id)
+ *  \brief  Add a WebAuthn credential to the credential ID index
+ *  \param  parent_address  Parent node address
+ *  \param  child_address   Child node address
+ *  \param  credential_id   Credential ID
+ */
+void nodemgmt_add_to_cred_id_index(uint16_t parent_address, uint16_t child_address, uint8_t* credential_id)
+{
+    uint32_t credential_id_start;
+    uint16_t position;
+    
+    /* Will be rebuilt anyway */
+    if (nodemgmt_cred_id_index_valid == FALSE)
+    {
+        return;
+    }
+    
+    /* Keep probe sequences short: lookups will walk the lists for credentials that aren't indexed */
+    if (nodemgmt_cred_id_index_nb_entries >= NODEMGMT_CRED_ID_INDEX_MAX_LOAD)
+    {
+        nodemgmt_cred_id_index_incomplete = TRUE;
+        return;
+    }
+    
+    /* Credential IDs are random: their first bytes make a good hash */
+    memcpy(&credential_id_start, credential_id, sizeof(credential_id_start));
+    position = credential_id_start & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1);
+    while (nodemgmt_cred_id_index[position].child_address != NODE_ADDR_NULL)
+    {
+        position = (position + 1) & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1);
+    }
+    
+    /* Store new entry */
+    nodemgmt_cred_id_index[position].credential_id_start = credential_id_start;
+    nodemgmt_cred_id_index[position].parent_address = parent_address;
+    nodemgmt_cred_id_index[position].child_address = child_address;
+    nodemgmt_cred_id_index_nb_entries++;
+}
+
+/*! \fn     nodemgmt_remove_from_cred_id_index(uint16_t child_address)
+ *  \brief  Remove a WebAuthn credential from the credential ID index
+ *  \param  child_address   Child node address
+ *  \return Parent address of the removed entry, NODE_ADDR_NULL if the child wasn't indexed
+ */
+static uint16_t nodemgmt_remove_from_cred_id_index(uint16_t child_address)
+{
+    uint16_t parent_address;
+    uint16_t hole_position;
+    uint16_t position;
+    
+    /* Find the entry */
+    for (hole_position = 0; hole_position < NODEMGMT_CRED_ID_INDEX_NB_ENTRIES; hole_position++)
+    {
+        if (nodemgmt_cred_id_index[hole_position].child_address == child_address)
+        {
+            break;
+        }
+    }
+    if ((child_address == NODE_ADDR_NULL) || (hole_position == NODEMGMT_CRED_ID_INDEX_NB_ENTRIES))
+    {
+        return NODE_ADDR_NULL;
+    }
+    parent_address = nodemgmt_cred_id_index[hole_position].parent_address;
+    
+    /* Move back the next entries of the probe sequence that can't be reached anymore */
+    position = hole_position;
+    while (TRUE)
+    {
+        position = (position + 1) & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1);
+        if (nodemgmt_cred_id_index[position].child_address == NODE_ADDR_NULL)
+        {
+            break;
+        }
+        
+        /* Entry can fill the hole if its hash position isn't between the hole and itself */
+        uint16_t hash_position = nodemgmt_cred_id_index[position].credential_id_start & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1);
+        if (((position - hash_position) & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1)) >= ((position - hole_position) & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1)))
+        {
+            nodemgmt_cred_id_index[hole_position] = nodemgmt_cred_id_index[position];
+            hole_position = position;
+        }
+    }
+    nodemgmt_cred_id_index[hole_position].child_address = NODE_ADDR_NULL;
+    nodemgmt_cred_id_index_nb_entries--;
+    
+    return parent_address;
+}
+
+/*! \fn     nodemgmt_update_cred_id_index(uint16_t child_address, uint8_t* credential_id)
+ *  \brief  Update the credential ID of an indexed WebAuthn credential
+ *  \param  child_address   Child node address
+ *  \param  credential_id   New credential ID
+ */
+void nodemgmt_update_cred_id_index(uint16_t child_address, uint8_t* credential_id)
+{
+    uint16_t parent_address = nodemgmt_remove_from_cred_id_index(child_address);
+    
+    if (parent_address != NODE_ADDR_NULL)
+    {
+        nodemgmt_add_to_cred_id_index(parent_address, child_address, credential_id);
+    }
+}
+
+/*! \fn     nodemgmt_build_cred_id_index(void)
+ *  \brief  Go through all the current user WebAuthn credentials to build the credential ID index
+ */
+static void nodemgmt_build_cred_id_index(void)
+{
+    uint8_t node_start[offsetof(parent_cred_node_t, nextChildAddress) + MEMBER_SIZE(parent_cred_node_t, nextChildAddress)];
+    uint8_t credential_id[MEMBER_SIZE(child_webauthn_node_t, credential_id)];
+    uint16_t parent_next_addr;
+    uint16_t parent_flags;
+    uint16_t next_parent_addr = nodemgmt_current_handle.firstCredParentNodes[NODEMGMT_WEBAUTHN_CRED_TYPE_ID];
+    uint16_t next_child_addr;
+    uint16_t child_addr;
+    uint32_t nb_nodes = 0;
+    
+    /* Start from scratch */
+    memset(nodemgmt_cred_id_index, 0, sizeof(nodemgmt_cred_id_index));
+    nodemgmt_cred_id_index_incomplete = FALSE;
+    nodemgmt_cred_id_index_nb_entries = 0;
+    nodemgmt_cred_id_index_valid = TRUE;
+    
+    /* Bounded loops in case of corrupted database */
+    while ((next_parent_addr != NODE_ADDR_NULL) && (nb_nodes++ < NODEMGMT_NB_NODE_SLOTS))
+    {
+        /* Read flags, prev/next address and first child address */
+        if (nodemgmt_check_address_validity(next_parent_addr) != RETURN_OK)
+        {
+            nodemgmt_cred_id_index_incomplete = TRUE;
+            return;
+        }
+        dbflash_read_data_from_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_parent_addr), BASE_NODE_SIZE*nodemgmt_node_from_address(next_parent_addr), sizeof(node_start), (void*)node_start);
+        memcpy(&parent_flags, &node_start[offsetof(parent_cred_node_t, flags)], sizeof(parent_flags));
+        memcpy(&parent_next_addr, &node_start[offsetof(parent_cred_node_t, nextParentAddress)], sizeof(parent_next_addr));
+        memcpy(&next_child_addr, &node_start[offsetof(parent_cred_node_t, nextChildAddress)], sizeof(next_child_addr));
+        if ((validBitFromFlags(parent_flags) != NODEMGMT_VBIT_VALID) || (nodemgmt_check_user_perm_from_flags(parent_flags) != RETURN_OK) || (nodeTypeFromFlags(parent_flags) != NODE_TYPE_PARENT))
+        {
+            nodemgmt_cred_id_index_incomplete = TRUE;
+            return;
+        }
+        
+        /* Index all its children */
+        while ((next_child_addr != NODE_ADDR_NULL) && (nb_nodes++ < NODEMGMT_NB_NODE_SLOTS))
+        {
+            child_addr = next_child_addr;
+            if (nodemgmt_read_webauthn_child_index_fields(child_addr, &next_child_addr, credential_id) != RETURN_OK)
+            {
+                nodemgmt_cred_id_index_incomplete = TRUE;
+                break;
+            }
+            nodemgmt_add_to_cred_id_index(next_parent_addr, child_addr, credential_id);
+        }
+        
+        next_parent_addr = parent_next_addr;
+    }
+}
+
+/*! \fn     nodemgmt_invalidate_cred_id_index(void)
+ *  \brief  Invalidate the credential ID index, to be called when the database is externally modified
+ *  \note   Index will be rebuilt on next use
+ */
+void nodemgmt_invalidate_cred_id_index(void)
+{
+    nodemgmt_cred_id_index_valid = FALSE;
+}
+
+/*! \fn     nodemgmt_search_cred_id_index(uint16_t parent_address, uint8_t* credential_id, uint16_t* child_address)
+ *  \brief  Use the credential ID index to find a WebAuthn credential
+ *  \param  parent_address  Parent node address
+ *  \param  credential_id   Credential ID
+ *  \param  child_address   Where to store the child node address, NODE_ADDR_NULL if not found
+ *  \return RETURN_OK if the index answer is final, RETURN_NOK if the children list should be browsed
+ *  \note   Found credentials are confirmed by reading their credential ID from flash
+ */
+RET_TYPE nodemgmt_search_cred_id_index(uint16_t parent_address, uint8_t* credential_id, uint16_t* child_address)
+{
+    uint8_t temp_credential_id[MEMBER_SIZE(child_webauthn_node_t, credential_id)];
+    uint32_t credential_id_start;
+    uint16_t temp_next_child_addr;
+    uint16_t position;
+    
+    /* Database was externally changed */
+    if (nodemgmt_cred_id_index_valid == FALSE)
+    {
+        nodemgmt_build_cred_id_index();
+    }
+    
+    /* Go through the probe sequence */
+    *child_address = NODE_ADDR_NULL;
+    memcpy(&credential_id_start, credential_id, sizeof(credential_id_start));
+    position = credential_id_start & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1);
+    for (uint16_t i = 0; (i < NODEMGMT_CRED_ID_INDEX_NB_ENTRIES) && (nodemgmt_cred_id_index[position].child_address != NODE_ADDR_NULL); i++)
+    {
+        if ((nodemgmt_cred_id_index[position].credential_id_start == credential_id_start) && (nodemgmt_cred_id_index[position].parent_address == parent_address))
+        {
+            /* Confirm the index is in sync with flash contents */
+            if (nodemgmt_read_webauthn_child_index_fields(nodemgmt_cred_id_index[position].child_address, &temp_next_child_addr, temp_credential_id) != RETURN_OK)
+            {
+                nodemgmt_invalidate_cred_id_index();
+                return RETURN_NOK;
+            }
+            if (memcmp(temp_credential_id, credential_id, sizeof(temp_credential_id)) == 0)
+            {
+                *child_address = nodemgmt_cred_id_index[position].child_address;
+                return RETURN_OK;
+            }
+        }
+        position = (position + 1) & (NODEMGMT_CRED_ID_INDEX_NB_ENTRIES-1);
+    }
+    
+    /* Not in the index: only a final answer if all credentials are indexed */
+    return (nodemgmt_cred_id_index_incomplete == FALSE)? RETURN_OK : RETURN_NOK;
+}
+
 /*! \fn     nodemgmt_init_context(uint16_t userIdNum, uint16_t* userSecFlags, uint16_t* userLanguage, uint16_t* userLayout, uint16_t* userBLELayout)
  *  \brief  Initializes the Node Management Handle, scans memory for the next free node
  *  \param  userIdNum       The user id to initialize the handle for
@@ -2223,6 +3130,10 @@ void nodemgmt_init_context(uint16_t userIdNum, uint16_t* userSecFlags, uint16_t*
     // Scan for last parent nodes
     nodemgmt_scan_for_last_parent_nodes();
     
+    // Build service & credential ID indexes
+    nodemgmt_build_service_index();
+    nodemgmt_build_cred_id_index();
+    
     // scan for next free parent and child nodes from the start of the memory
     nodemgmt_scan_node_usage();
     
@@ -2326,6 +3237,8 @@ void nodemgmt_delete_data_parent_and_its_children(uint16_t parent_address, uint1
     
     // Delete parent data block
     dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(parent_address), BASE_NODE_SIZE * nodemgmt_node_from_address(parent_address), BASE_NODE_SIZE, 0xFF);
+    nodemgmt_update_node_usage_bitmap(parent_address, UINT16_MAX);
+    nodemgmt_remove_from_service_index(parent_address, parent_node_pt->data_parent.prevParentAddress);
     
     // Delete the children (evil laugh)
     nodemgmt_delete_children_list(first_child_address, TRUE);
@@ -2357,6 +3270,7 @@ void nodemgmt_delete_children_list(uint16_t first_children_addr, BOOL data_child
         {
             // credential child
             temp_address = child_node_pt->nextChildAddress;
+            nodemgmt_remove_from_cred_id_index(next_child_addr);
         }
         else
         {
@@ -2368,6 +3282,8 @@ void nodemgmt_delete_children_list(uint16_t first_children_addr, BOOL data_child
         // Delete child data block
         dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_child_addr), BASE_NODE_SIZE * nodemgmt_node_from_address(next_child_addr), BASE_NODE_SIZE, 0xFF);
         dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(nodemgmt_get_incremented_address(next_child_addr)), BASE_NODE_SIZE * nodemgmt_node_from_address(nodemgmt_get_incremented_address(next_child_addr)), BASE_NODE_SIZE, 0xFF);
+        nodemgmt_update_node_usage_bitmap(nodemgmt_get_incremented_address(next_child_addr), UINT16_MAX);
+        nodemgmt_update_node_usage_bitmap(next_child_addr, UINT16_MAX);
         
         // Set correct next address
         next_child_addr = temp_address;
@@ -2395,6 +3311,8 @@ void nodemgmt_delete_current_user_from_flash(void)
         
     // Delete user profile memory
     nodemgmt_format_user_profile(nodemgmt_current_handle.currentUserId, 0, 0, 0, 0);
+    nodemgmt_invalidate_service_index();
+    nodemgmt_invalidate_cred_id_index();
     
     // Then browse through all the credentials to delete them
     for (uint16_t i = 0; i < MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstDataParentNodes); i++)
@@ -2424,6 +3342,7 @@ void nodemgmt_delete_current_user_from_flash(void)
             
             // Delete parent data block
             dbflash_write_data_pattern_to_flash(&dbflash_descriptor, nodemgmt_page_from_address(next_parent_addr), BASE_NODE_SIZE * nodemgmt_node_from_address(next_parent_addr), BASE_NODE_SIZE, 0xFF);
+            nodemgmt_update_node_usage_bitmap(next_parent_addr, UINT16_MAX);
             
             // Set correct next address
             next_parent_addr = temp_address;
@@ -2602,11 +3521,12 @@ RET_TYPE nodemgmt_store_data_node(child_data_node_t* node, uint16_t* storedAddre
     return RETURN_OK;
 }
 
-/*! \fn     nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type, uint16_t firstNodeAddress, uint16_t* newFirstNodeAddress, uint16_t* storedAddress, uint16_t* newLastNodeAddress)
+/*! \fn     nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type, uint16_t firstNodeAddress, uint16_t searchStartAddress, uint16_t* newFirstNodeAddress, uint16_t* storedAddress, uint16_t* newLastNodeAddress)
  *  \brief  Writes a generic node to memory (next free via handle) (in alphabetical order)
  *  \param  g                       The node to write to memory (nextFreeParentNode)
  *  \param  node_type               The node type (see enum)
  *  \param  firstNodeAddress        Address of the first node of its kind
+ *  \param  searchStartAddress      Address of a node alphabetically before the one to write to start looking from, NODE_ADDR_NULL to start from the first node
  *  \param  newFirstNodeAddress     If the firstNodeAddress changed, this var will store the new value
  *  \param  storedAddress           Where to store the address at which the node was stored
  *  \param  newLastNodeAddress     If the lastNodeAddress changed, this var will store the new value
@@ -2614,7 +3534,7 @@ RET_TYPE nodemgmt_store_data_node(child_data_node_t* node, uint16_t* storedAddre
  *  \note   Handles necessary doubly linked list management
  *  \note   Not called for child data node
  */
-RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type, uint16_t firstNodeAddress, uint16_t* newFirstNodeAddress, uint16_t* storedAddress, uint16_t* newLastNodeAddress)
+RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type, uint16_t firstNodeAddress, uint16_t searchStartAddress, uint16_t* newFirstNodeAddress, uint16_t* storedAddress, uint16_t* newLastNodeAddress)
 {
     /* Sanity checks */
     _Static_assert(offsetof(parent_cred_node_t, prevParentAddress) == offsetof(parent_data_node_t, prevParentAddress), "Next / Prev fields do not match across parent & child nodes");
@@ -2703,8 +3623,8 @@ RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type,
     }
     else
     {        
-        // set first node address
-        addr = firstNodeAddress;
+        // set first node address, or skip ahead if we know a node that comes before the one to add
+        addr = (searchStartAddress != NODE_ADDR_NULL)? searchStartAddress : firstNodeAddress;
         while(addr != NODE_ADDR_NULL)
         {
             // read node: use read parent node function as all the fields always are in the first 264B
@@ -2828,7 +3748,7 @@ RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type,
  */
 RET_TYPE nodemgmt_create_parent_node(parent_node_t* p, service_type_te type, uint16_t* storedAddress, uint16_t typeId)
 {
-    uint16_t first_parent_addr, last_parent_addr, potential_new_fparent, potential_new_lparent;
+    uint16_t first_parent_addr, last_parent_addr, potential_new_fparent, potential_new_lparent, search_start_addr;
     RET_TYPE temprettype;
     
     // Set the first parent address depending on the type
@@ -2856,14 +3776,17 @@ RET_TYPE nodemgmt_create_parent_node(parent_node_t* p, service_type_te type, uin
     // This is particular to parent nodes...
     p->cred_parent.nextChildAddress = NODE_ADDR_NULL;
     
+    // Use the service index to skip the parent nodes coming before the one to add
+    search_start_addr = nodemgmt_get_service_index_lower_parent((type == SERVICE_CRED_TYPE)? typeId : MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + typeId, p->cred_parent.service);
+    
     // Call nodemgmt_create_generic_node to add a node
     if (type == SERVICE_CRED_TYPE)
     {
-        temprettype = nodemgmt_create_generic_node((generic_node_t*)p, NODE_TYPE_PARENT, first_parent_addr, &potential_new_fparent, storedAddress, &potential_new_lparent);
+        temprettype = nodemgmt_create_generic_node((generic_node_t*)p, NODE_TYPE_PARENT, first_parent_addr, search_start_addr, &potential_new_fparent, storedAddress, &potential_new_lparent);
     }
     else
     {
-        temprettype = nodemgmt_create_generic_node((generic_node_t*)p, NODE_TYPE_PARENT_DATA, first_parent_addr, &potential_new_fparent, storedAddress, &potential_new_lparent);
+        temprettype = nodemgmt_create_generic_node((generic_node_t*)p, NODE_TYPE_PARENT_DATA, first_parent_addr, search_start_addr, &potential_new_fparent, storedAddress, &potential_new_lparent);
     }
     
     // If the return is ok & we changed the first node address
@@ -2879,6 +3802,12 @@ RET_TYPE nodemgmt_create_parent_node(parent_node_t* p, service_type_te type, uin
         }
     }
     
+    // If the return is ok, add the new node to the service index
+    if (temprettype == RETURN_OK)
+    {
+        nodemgmt_add_to_service_index(*storedAddress, (type == SERVICE_CRED_TYPE)? typeId : MEMBER_ARRAY_SIZE(nodemgmtHandle_t, firstCredParentNodes) + typeId, p->cred_parent.service, p->cred_parent.flags, FALSE);
+    }
+    
     // If the return is ok & we changed the last node address
     if ((temprettype == RETURN_OK) && (last_parent_addr != potential_new_lparent) && (potential_new_lparent != NODE_ADDR_NULL))
     {
@@ -2917,7 +3846,7 @@ RET_TYPE nodemgmt_create_child_node(uint16_t pAddr, child_cred_node_t* c, uint16
     childFirstAddress = nodemgmt_current_handle.temp_parent_node.cred_parent.nextChildAddress;
     
     // Call nodemgmt_create_generic_node to add a node
-    temprettype = nodemgmt_create_generic_node((generic_node_t*)c, NODE_TYPE_CHILD, childFirstAddress, &temp_address, storedAddress, &temp_address2);
+    temprettype = nodemgmt_create_generic_node((generic_node_t*)c, NODE_TYPE_CHILD, childFirstAddress, NODE_ADDR_NULL, &temp_address, storedAddress, &temp_address2);
     
     // If the return is ok & we changed the first child address
     if ((temprettype == RETURN_OK) && (childFirstAddress != temp_address))
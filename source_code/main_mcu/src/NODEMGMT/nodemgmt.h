@@ -72,6 +72,13 @@ typedef enum    {NODE_TYPE_PARENT = 0, NODE_TYPE_CHILD = 1, NODE_TYPE_PARENT_DAT
 #define NODEMGMT_CAT_MASK_FINAL                     0x000F
 #define NODEMGMT_CAT_MASK                           0x000F
 #define NODEMGMT_CAT_BITSHIFT                       0
+#define NODEMGMT_NB_NODES_PER_PAGE                  (BYTES_PER_PAGE/BASE_NODE_SIZE)
+#define NODEMGMT_NB_NODE_SLOTS                      ((uint32_t)PAGE_COUNT*NODEMGMT_NB_NODES_PER_PAGE)
+#define NODEMGMT_FIRST_NODE_SLOT                    ((uint32_t)PAGE_PER_SECTOR*NODEMGMT_NB_NODES_PER_PAGE)  // First sector is reserved for the user profiles, multiple of 32
+#define NODEMGMT_SERVICE_INDEX_NB_ENTRIES           128
+#define NODEMGMT_SERVICE_INDEX_PREFIX_LEN           2
+#define NODEMGMT_CRED_ID_INDEX_NB_ENTRIES           128     // Power of 2
+#define NODEMGMT_CRED_ID_INDEX_MAX_LOAD             96      // Entries past which credentials aren't indexed anymore
 
 /* User security settings flags */
 #define USER_SEC_FLG_LOGIN_CONF             0x01
@@ -353,6 +360,22 @@ typedef struct
     uint16_t lastDataParentNodes[7];        // The addresses of the users last data parent nodes (read from flash. eg cache)
 } nodemgmtHandle_t;
 
+// Service index entry
+typedef struct
+{
+    uint16_t address;                                           // Address of the last parent node with that prefix
+    uint16_t list_id;                                           // Credential type ID, or number of credential types + data type ID
+    cust_char_t prefix[NODEMGMT_SERVICE_INDEX_PREFIX_LEN];      // First characters of the service name, 0 padded
+} nodemgmt_service_index_entry_t;
+
+// Credential ID index entry
+typedef struct
+{
+    uint32_t credential_id_start;                               // First bytes of the credential ID, also used as hash
+    uint16_t parent_address;                                    // WebAuthn parent node address
+    uint16_t child_address;                                     // WebAuthn child node address, NODE_ADDR_NULL for empty entries
+} nodemgmt_cred_id_index_entry_t;
+
 /* Inlines */
 
 /*! \fn     nodemgmt_user_id_to_flags(uint16_t *flags, uint8_t uid)
@@ -426,7 +449,7 @@ static inline node_type_te nodeTypeFromFlags(uint16_t flags)
 }
 
 /* Prototypes */
-RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type, uint16_t firstNodeAddress, uint16_t* newFirstNodeAddress, uint16_t* storedAddress, uint16_t* newLastNodeAddress);
+RET_TYPE nodemgmt_create_generic_node(generic_node_t* g, node_type_te node_type, uint16_t firstNodeAddress, uint16_t searchStartAddress, uint16_t* newFirstNodeAddress, uint16_t* storedAddress, uint16_t* newLastNodeAddress);
 void nodemgmt_get_prev_favorite_and_category_index(int16_t category_index, int16_t favorite_index, int16_t* new_cat_index, int16_t* new_fav_index, BOOL navigate_across_categories);
 void nodemgmt_get_next_favorite_and_category_index(int16_t category_index, int16_t favorite_index, int16_t* new_cat_index, int16_t* new_fav_index, BOOL navigate_across_categories);
 RET_TYPE nodemgmt_get_bluetooth_bonding_information_for_mac_addr(uint8_t address_resolv_type, uint8_t* mac_address, nodemgmt_bluetooth_bonding_information_t* bonding_information);
@@ -438,6 +461,7 @@ void nodemgmt_format_user_profile(uint16_t uid, uint16_t secPreferences, uint16_
 void nodemgmt_read_webauthn_child_node(uint16_t address, child_webauthn_node_t* child_node, BOOL update_date_and_increment_preinc_count);
 uint16_t nodemgmt_get_data_parent_next_child_address_ctr_and_prev_gen_flag(uint16_t parent_address, uint8_t* ctr, BOOL* prev_gen_flag);
 void nodemgmt_update_data_parent_ctr_and_first_child_address(uint16_t parent_address, uint8_t* ctr_val, uint16_t first_child_address);
+uint16_t nodemgmt_get_service_index_start_addr(cust_char_t* service, BOOL cred_type, uint16_t typeId, BOOL mult_domain_possible);
 int32_t nodemgmt_get_next_non_null_favorite_before_index(uint16_t favId, uint16_t category_id, BOOL navigate_across_categories);
 int32_t nodemgmt_get_next_non_null_favorite_after_index(uint16_t favId, uint16_t category_id, BOOL navigate_across_categories);
 uint16_t nodemgmt_get_encrypted_data_from_data_node(uint16_t data_child_address, uint8_t* buffer, uint16_t* nb_bytes_written);
@@ -450,6 +474,7 @@ RET_TYPE nodemgmt_store_bluetooth_bonding_information(nodemgmt_bluetooth_bonding
 uint16_t nodemgmt_check_for_logins_with_category_in_parent_node(uint16_t start_child_addr, uint16_t category_flags);
 void nodemgmt_read_favorite(uint16_t categoryId, uint16_t favId, uint16_t* parentAddress, uint16_t* childAddress);
 void nodemgmt_read_favorite_for_current_category(uint16_t favId, uint16_t* parentAddress, uint16_t* childAddress);
+void nodemgmt_write_node_blocks_to_flash_in_page_order(uint16_t nb_nodes, uint16_t* addresses, uint16_t* node_sizes, uint8_t** nodes);
 void nodemgmt_write_child_node_block_to_flash(uint16_t address, child_node_t* child_node, BOOL write_category);
 void nodemgmt_set_favorite(uint16_t categoryId, uint16_t favId, uint16_t parentAddress, uint16_t childAddress);
 void nodemgmt_get_bluetooth_bonding_info_starting_offset(uint16_t uid, uint16_t *page, uint16_t *pageOffset);
@@ -472,7 +497,11 @@ uint16_t nodemgmt_get_prev_child_node_for_cur_category(uint16_t search_start_chi
 uint16_t nodemgmt_get_next_child_node_for_cur_category(uint16_t search_start_child_addr);
 uint16_t nodemgmt_get_last_parent_addr(BOOL data_parent, uint16_t credential_type_id);
 uint16_t nodemgmt_get_starting_parent_addr_for_category(uint16_t credential_type_id);
+void nodemgmt_add_to_cred_id_index(uint16_t parent_address, uint16_t child_address, uint8_t* credential_id);
+RET_TYPE nodemgmt_search_cred_id_index(uint16_t parent_address, uint8_t* credential_id, uint16_t* child_address);
 RET_TYPE nodemgmt_check_user_permission(uint16_t node_addr, node_type_te* node_type);
+void nodemgmt_update_cred_id_index(uint16_t child_address, uint8_t* credential_id);
+uint16_t nodemgmt_get_next_user_node_address(uint16_t address, node_type_te* node_type);
 RET_TYPE nodemgmt_store_data_node(child_data_node_t* node, uint16_t* storedAddress);
 void nodemgmt_delete_children_list(uint16_t first_children_addr, BOOL data_child);
 void nodemgmt_set_data_start_address(uint16_t dataParentAddress, uint16_t typeId);
@@ -498,6 +527,7 @@ void nodemgmt_set_data_change_number(uint32_t changeNumber);
 void nodemgmt_set_cred_change_number(uint32_t changeNumber);
 uint16_t nodemgmt_get_user_nb_known_keyboard_layouts(void);
 uint16_t nodemgmt_get_favorites(uint16_t* addresses_array);
+void nodemgmt_set_favorites(uint16_t* addresses_array);
 uint16_t nodemgmt_get_incremented_address(uint16_t addr);
 void nodemgmt_user_db_changed_actions(BOOL dataChanged);
 void nodemgmt_store_user_language(uint16_t languageId);
@@ -509,6 +539,8 @@ void nodemgmt_delete_current_user_from_flash(void);
 uint16_t nodemgmt_get_current_category_flags(void);
 void nodemgmt_store_user_layout(uint16_t layoutId);
 void nodemgmt_trigger_db_ext_changed_actions(void);
+void nodemgmt_invalidate_service_index(void);
+void nodemgmt_invalidate_cred_id_index(void);
 uint16_t nodemgmt_get_user_sec_preferences(void);
 uint32_t nodemgmt_get_cred_change_number(void);
 uint32_t nodemgmt_get_data_change_number(void);
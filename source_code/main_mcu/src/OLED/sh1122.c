@@ -144,6 +144,12 @@ void sh1122_start_data_sending(sh1122_descriptor_t* oled_descriptor)
 {
     PORT->Group[oled_descriptor->sh1122_cs_pin_group].OUTCLR.reg = oled_descriptor->sh1122_cs_pin_mask;
     PORT->Group[oled_descriptor->sh1122_cd_pin_group].OUTSET.reg = oled_descriptor->sh1122_cd_pin_mask;    
+    
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    /* Display RAM may not match the frame buffer anymore: next flush will be a complete one */
+    oled_descriptor->frame_buffer_dirty_ystart = 0;
+    oled_descriptor->frame_buffer_dirty_yend = SH1122_OLED_HEIGHT;
+    #endif
 }
 
 /*! \fn     sh1122_stop_data_sending(sh1122_descriptor_t* oled_descriptor)
@@ -529,6 +535,35 @@ void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor)
 {
     sh1122_check_for_flush_and_terminate(oled_descriptor);
     memset((void*)oled_descriptor->frame_buffer, 0x00, sizeof(oled_descriptor->frame_buffer));
+    sh1122_mark_frame_buffer_rows_dirty(oled_descriptor, 0, SH1122_OLED_HEIGHT);
+}
+
+/*! \fn     sh1122_mark_frame_buffer_rows_dirty(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend)
+*   \brief  Mark frame buffer rows as modified, so they are sent at the next flush
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ystart              Start Y
+*   \param  yend                End Y (exclusive)
+*   \note   To be called by code directly writing into the frame buffer
+*/
+void sh1122_mark_frame_buffer_rows_dirty(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend)
+{
+    if (yend > SH1122_OLED_HEIGHT)
+    {
+        yend = SH1122_OLED_HEIGHT;
+    }
+    if (ystart >= yend)
+    {
+        return;
+    }
+    
+    if (ystart < oled_descriptor->frame_buffer_dirty_ystart)
+    {
+        oled_descriptor->frame_buffer_dirty_ystart = ystart;
+    }
+    if (yend > oled_descriptor->frame_buffer_dirty_yend)
+    {
+        oled_descriptor->frame_buffer_dirty_yend = yend;
+    }
 }
 
 /*! \fn     sh1122_clear_y_frame_buffer(sh1122_descriptor_t* oled_descriptor)
@@ -546,6 +581,7 @@ void sh1122_clear_y_frame_buffer(sh1122_descriptor_t* oled_descriptor, uint16_t
     
     sh1122_check_for_flush_and_terminate(oled_descriptor);
     memset((void*)&oled_descriptor->frame_buffer[ystart][0], 0x00, (yend-ystart)*SH1122_OLED_WIDTH/2);
+    sh1122_mark_frame_buffer_rows_dirty(oled_descriptor, ystart, yend);
 }
 
 /*! \fn     sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor)
@@ -603,11 +639,18 @@ void sh1122_flush_frame_buffer_window(sh1122_descriptor_t* oled_descriptor, uint
         height = SH1122_OLED_HEIGHT-y;
     }
     
+    /* Sending frame buffer contents doesn't change the rows to be sent at next flush */
+    uint16_t dirty_ystart = oled_descriptor->frame_buffer_dirty_ystart;
+    uint16_t dirty_yend = oled_descriptor->frame_buffer_dirty_yend;
+    
     /* Display! */
     for (uint16_t i = y; i < y+height; i++)
     {
         sh1122_display_horizontal_pixel_line(oled_descriptor, x, i, width, &oled_descriptor->frame_buffer[i][x/2], FALSE);
     }
+    
+    oled_descriptor->frame_buffer_dirty_ystart = dirty_ystart;
+    oled_descriptor->frame_buffer_dirty_yend = dirty_yend;
 }
 
 /*! \fn     sh1122_flush_frame_buffer_y_window(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend)
@@ -628,12 +671,18 @@ void sh1122_flush_frame_buffer_y_window(sh1122_descriptor_t* oled_descriptor, ui
         yend = SH1122_OLED_HEIGHT;
     }
     
+    /* Sending frame buffer contents doesn't change the rows to be sent at next flush */
+    uint16_t dirty_ystart = oled_descriptor->frame_buffer_dirty_ystart;
+    uint16_t dirty_yend = oled_descriptor->frame_buffer_dirty_yend;
+    
     /* Set pixel write window */
     sh1122_set_row_address(oled_descriptor, ystart);
     sh1122_set_column_address(oled_descriptor, 0);
     
     /* Start filling the SSD1322 RAM */
     sh1122_start_data_sending(oled_descriptor);
+    oled_descriptor->frame_buffer_dirty_ystart = dirty_ystart;
+    oled_descriptor->frame_buffer_dirty_yend = dirty_yend;
     
     /* Send buffer! */
     #ifdef OLED_DMA_TRANSFER        
@@ -660,8 +709,19 @@ void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
     
     if (oled_descriptor->loaded_transition == OLED_TRANS_NONE)
     {        
+        /* Only send the rows modified since last flush */
+        uint16_t ystart = oled_descriptor->frame_buffer_dirty_ystart;
+        uint16_t yend = oled_descriptor->frame_buffer_dirty_yend;
+        
+        /* Nothing to send */
+        if (ystart >= yend)
+        {
+            emu_oled_flush();
+            return;
+        }
+        
         /* Set pixel write window */
-        sh1122_set_row_address(oled_descriptor, 0);
+        sh1122_set_row_address(oled_descriptor, ystart);
         sh1122_set_column_address(oled_descriptor, 0);
         
         /* Start filling the SSD1322 RAM */
@@ -669,10 +729,10 @@ void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
         
         /* Send buffer! */
         #ifdef OLED_DMA_TRANSFER        
-            dma_oled_init_transfer(oled_descriptor->sercom_pt, (void*)&oled_descriptor->frame_buffer[0][0], sizeof(oled_descriptor->frame_buffer), oled_descriptor->dma_trigger_id);
+            dma_oled_init_transfer(oled_descriptor->sercom_pt, (void*)&oled_descriptor->frame_buffer[ystart][0], (yend-ystart)*SH1122_OLED_WIDTH/2, oled_descriptor->dma_trigger_id);
             oled_descriptor->frame_buffer_flush_in_progress = TRUE;
         #else
-            for (uint32_t y = 0; y < SH1122_OLED_HEIGHT; y++) 
+            for (uint32_t y = ystart; y < yend; y++) 
             {
                 for (uint32_t x = 0; x < SH1122_OLED_WIDTH/2; x++) {
                     sercom_spi_send_single_byte_without_receive_wait(oled_descriptor->sercom_pt, oled_descriptor->frame_buffer[y][x]);
@@ -817,21 +877,188 @@ void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor)
         }
     }
     
-    /* Reset transition */
+    /* Reset transition, display now matches the frame buffer */
     oled_descriptor->loaded_transition = OLED_TRANS_NONE;
+    oled_descriptor->frame_buffer_dirty_ystart = SH1122_OLED_HEIGHT;
+    oled_descriptor->frame_buffer_dirty_yend = 0;
     emu_oled_flush();
 }
 #endif
 
+/*! \fn     sh1122_reset_glyph_cache(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Forget the glyph headers cached for the previous font
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+static void sh1122_reset_glyph_cache(sh1122_descriptor_t* oled_descriptor)
+{
+    memset(oled_descriptor->glyph_cache_valid, 0x00, sizeof(oled_descriptor->glyph_cache_valid));
+    for (uint16_t i = 0; i < ARRAY_SIZE(oled_descriptor->glyph_lru); i++)
+    {
+        oled_descriptor->glyph_lru[i].printable = FALSE;
+        oled_descriptor->glyph_lru[i].point = 0;
+        oled_descriptor->glyph_lru[i].age = (uint8_t)i;
+    }
+}
+
+/*! \fn     sh1122_get_glyph_from_flash(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, font_glyph_t* glyph)
+*   \brief  Fetch a glyph header from the current font in flash
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Character
+*   \param  glyph               Where to store the glyph header
+*   \return If the current font has a glyph for this character
+*/
+static BOOL sh1122_get_glyph_from_flash(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, font_glyph_t* glyph)
+{
+    custom_fs_address_t gind_table_address = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters);
+    uint16_t glyph_desc_pt_offset = 0;
+    uint16_t gind;
+    
+    for (uint16_t i = 0; i < ARRAY_SIZE(oled_descriptor->current_unicode_inters); i++)
+    {
+        /* Check if char is within this interval */
+        if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
+        {
+            /* Convert character to glyph index */
+            custom_fs_read_from_flash((uint8_t*)&gind, gind_table_address + glyph_desc_pt_offset*sizeof(gind) + (ch - oled_descriptor->current_unicode_inters[i].interval_start)*sizeof(gind), sizeof(gind));
+            
+            /* Check that we know this glyph */
+            if (gind == 0xFFFF)
+            {
+                return FALSE;
+            }
+            
+            /* Read glyph header */
+            custom_fs_read_from_flash((uint8_t*)glyph, gind_table_address + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(font_glyph_t), sizeof(font_glyph_t));
+            return TRUE;
+        }
+        
+        /* Add offset to descriptor */
+        glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
+    }
+    
+    return FALSE;
+}
+
+/*! \fn     sh1122_get_glyph(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, font_glyph_t* glyph)
+*   \brief  Get the glyph header for a given character in the current font
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  ch                  Character
+*   \param  glyph               Where to store the glyph header
+*   \return If a glyph (possibly '?') can be printed for this character
+*   \note   Only characters outside of the cached range may require a flash access
+*/
+static BOOL sh1122_get_glyph(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, font_glyph_t* glyph)
+{
+    BOOL printable = FALSE;
+    
+    /* Check that a font was actually chosen */
+    if (oled_descriptor->currentFontAddress == 0)
+    {
+        return FALSE;
+    }
+    
+    if ((ch >= SH1122_GLYPH_CACHE_FIRST_CHAR) && (ch <= SH1122_GLYPH_CACHE_LAST_CHAR))
+    {
+        /* Cached range, fetch the glyph header on first use */
+        uint16_t cache_index = ch - SH1122_GLYPH_CACHE_FIRST_CHAR;
+        if ((oled_descriptor->glyph_cache_valid[cache_index/32] & (1UL << (cache_index%32))) == 0)
+        {
+            if (sh1122_get_glyph_from_flash(oled_descriptor, ch, &oled_descriptor->glyph_cache[cache_index]) != FALSE)
+            {
+                oled_descriptor->glyph_cache_printable[cache_index/32] |= (1UL << (cache_index%32));
+            }
+            else
+            {
+                oled_descriptor->glyph_cache_printable[cache_index/32] &= ~(1UL << (cache_index%32));
+            }
+            oled_descriptor->glyph_cache_valid[cache_index/32] |= (1UL << (cache_index%32));
+        }
+        if ((oled_descriptor->glyph_cache_printable[cache_index/32] & (1UL << (cache_index%32))) != 0)
+        {
+            *glyph = oled_descriptor->glyph_cache[cache_index];
+            printable = TRUE;
+        }
+    }
+    else
+    {
+        /* Look in the recently used glyphs, otherwise evict the oldest one */
+        uint16_t lru_index = 0;
+        for (uint16_t i = 0; i < ARRAY_SIZE(oled_descriptor->glyph_lru); i++)
+        {
+            if ((oled_descriptor->glyph_lru[i].point == ch) || (oled_descriptor->glyph_lru[i].age == SH1122_GLYPH_LRU_SIZE-1))
+            {
+                lru_index = i;
+                
+                if (oled_descriptor->glyph_lru[i].point == ch)
+                {
+                    break;
+                }
+            }
+        }
+        
+        /* Cache miss */
+        if (oled_descriptor->glyph_lru[lru_index].point != ch)
+        {
+            oled_descriptor->glyph_lru[lru_index].printable = sh1122_get_glyph_from_flash(oled_descriptor, ch, &oled_descriptor->glyph_lru[lru_index].glyph);
+            oled_descriptor->glyph_lru[lru_index].point = ch;
+        }
+        
+        /* Entry becomes the most recently used */
+        for (uint16_t i = 0; i < ARRAY_SIZE(oled_descriptor->glyph_lru); i++)
+        {
+            if (oled_descriptor->glyph_lru[i].age < oled_descriptor->glyph_lru[lru_index].age)
+            {
+                oled_descriptor->glyph_lru[i].age++;
+            }
+        }
+        oled_descriptor->glyph_lru[lru_index].age = 0;
+        
+        if (oled_descriptor->glyph_lru[lru_index].printable != FALSE)
+        {
+            *glyph = oled_descriptor->glyph_lru[lru_index].glyph;
+            printable = TRUE;
+        }
+    }
+    
+    /* If we don't know this character, try again with '?' */
+    if ((printable == FALSE) && (oled_descriptor->question_mark_support_described != FALSE) && (ch != '?'))
+    {
+        return sh1122_get_glyph(oled_descriptor, '?', glyph);
+    }
+    
+    return printable;
+}
+
 /*! \fn     sh1122_set_emergency_font(void)
 *   \brief  Use the flash-stored emergency font (ascii only)
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
 */
 void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor)
 {
+    /* Font already loaded */
+    if (oled_descriptor->currentFontAddress == CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR)
+    {
+        return;
+    }
+    
     oled_descriptor->currentFontAddress = CUSTOM_FS_EMERGENCY_FONT_FILE_ADDR;
     custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
     custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_unicode_inters, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header), sizeof(oled_descriptor->current_unicode_inters));
+    sh1122_reset_glyph_cache(oled_descriptor);
+}
+
+/*! \fn     sh1122_invalidate_font(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Forget the current font and its cached glyphs (to be called when the font files are changed)
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \note   A font needs to be set again before printing text
+*/
+void sh1122_invalidate_font(sh1122_descriptor_t* oled_descriptor)
+{
+    oled_descriptor->currentFontAddress = 0;
+    sh1122_reset_glyph_cache(oled_descriptor);
+    #ifdef OLED_INTERNAL_FRAME_BUFFER
+    sh1122_clear_glyph_raster_cache(oled_descriptor);
+    #endif
 }
 
 /*! \fn     sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor, uint16_t font_id)
@@ -842,13 +1069,22 @@ void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor)
 */
 RET_TYPE sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor, uint16_t font_id)
 {
-    if (custom_fs_get_file_address(font_id, &oled_descriptor->currentFontAddress, CUSTOM_FS_FONTS_TYPE) != RETURN_OK)
+    custom_fs_address_t font_address;
+    
+    if (custom_fs_get_file_address(font_id, &font_address, CUSTOM_FS_FONTS_TYPE) != RETURN_OK)
     {
         oled_descriptor->currentFontAddress = 0;
         return RETURN_NOK;
     }
+    else if (font_address == oled_descriptor->currentFontAddress)
+    {
+        /* Font already loaded */
+        return RETURN_OK;
+    }
     else
     {
+        oled_descriptor->currentFontAddress = font_address;
+        
         /* Read font header */
         custom_fs_read_from_flash((uint8_t*)&oled_descriptor->current_font_header, oled_descriptor->currentFontAddress, sizeof(oled_descriptor->current_font_header));
         
@@ -864,6 +1100,9 @@ RET_TYPE sh1122_refresh_used_font(sh1122_descriptor_t* oled_descriptor, uint16_t
         {
             oled_descriptor->question_mark_support_described = TRUE;
         }
+        
+        /* Glyph headers of the previous font are now stale */
+        sh1122_reset_glyph_cache(oled_descriptor);
 
         return RETURN_OK;
     }    
@@ -993,6 +1232,7 @@ void sh1122_draw_vertical_line(sh1122_descriptor_t* oled_descriptor, int16_t x,
     #ifdef OLED_INTERNAL_FRAME_BUFFER
     if (write_to_buffer != FALSE)
     {
+        sh1122_mark_frame_buffer_rows_dirty(oled_descriptor, ystart, yend+1);
         for (int16_t y=ystart; y<=yend; y++)
         {
             uint8_t pixels = color << 4;
@@ -1076,6 +1316,9 @@ void sh1122_display_horizontal_pixel_line(sh1122_descriptor_t* oled_descriptor,
         /* Previous pixels in case we are shifted */
         uint8_t prev_pixels = 0x00;
         
+        /* This row will need to be sent */
+        sh1122_mark_frame_buffer_rows_dirty(oled_descriptor, y, y+1);
+        
         /* Boolean to mention if pixel to be written is the first one in the buffer */
         BOOL pixel_shift = FALSE;
         
@@ -1267,6 +1510,7 @@ void sh1122_draw_rectangle(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
     #ifdef OLED_INTERNAL_FRAME_BUFFER
     if (write_to_buffer != FALSE)
     {
+        sh1122_mark_frame_buffer_rows_dirty(oled_descriptor, y, y+height);
         for (uint16_t yind = 0; yind < height; yind++)
         {
             uint16_t xind = 0;
@@ -1447,30 +1691,146 @@ void sh1122_draw_full_screen_image_from_bitstream(sh1122_descriptor_t* oled_desc
     bitstream_bitmap_close(bitstream);
 }
 
-/*! \fn     sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_t* bs, BOOL write_to_buffer)
-*   \brief  Draw a picture from a bitstream
+/*! \fn     sh1122_is_image_x_on_screen(sh1122_descriptor_t* oled_descriptor, int16_t* x, uint16_t width)
+*   \brief  Check that an image starting at a given X is on screen, apply screen wrapping to X
 *   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
-*   \param  x                   Starting x
-*   \param  y                   Starting y
-*   \param  bitstream           Pointer to the bitstream
-*   \param  write_to_buffer     Set to true to write to internal buffer
+*   \param  x                   Pointer to starting x, updated in case of wrapping
+*   \param  width               Image width
+*   \return FALSE if the image is off screen
 */
-void sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+static BOOL sh1122_is_image_x_on_screen(sh1122_descriptor_t* oled_descriptor, int16_t* x, uint16_t width)
 {
     /* Check for off screen line on the left */
-    if (((x < 0) && (-x >= bitstream->width) && (oled_descriptor->screen_wrapping_allowed == FALSE)) || (x < -SH1122_OLED_WIDTH))
+    if (((*x < 0) && (-*x >= width) && (oled_descriptor->screen_wrapping_allowed == FALSE)) || (*x < -SH1122_OLED_WIDTH))
     {
-        return;
+        return FALSE;
     }
     
     /* X off screen, remove one OLED width if wrap enabled */
-    if ((x >= oled_descriptor->max_disp_x) && (oled_descriptor->screen_wrapping_allowed != FALSE))
+    if ((*x >= oled_descriptor->max_disp_x) && (oled_descriptor->screen_wrapping_allowed != FALSE))
     {
-        x -= oled_descriptor->max_disp_x;
+        *x -= oled_descriptor->max_disp_x;
     }
     
     /* Check for off screen line on the right */
-    if (x >= oled_descriptor->max_disp_x)
+    if (*x >= oled_descriptor->max_disp_x)
+    {
+        return FALSE;
+    }
+    
+    return TRUE;
+}
+
+#ifdef OLED_INTERNAL_FRAME_BUFFER
+/*! \fn     sh1122_clear_glyph_raster_cache(sh1122_descriptor_t* oled_descriptor)
+*   \brief  Forget all decoded glyph rasters (to be called when the font files are changed)
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*/
+void sh1122_clear_glyph_raster_cache(sh1122_descriptor_t* oled_descriptor)
+{
+    memset((void*)oled_descriptor->glyph_rasters, 0x00, sizeof(oled_descriptor->glyph_rasters));
+    oled_descriptor->glyph_raster_clock = 0;
+}
+
+/*! \fn     sh1122_get_glyph_raster(sh1122_descriptor_t* oled_descriptor, font_glyph_t* glyph, custom_fs_address_t address)
+*   \brief  Get the decoded raster of a glyph of the current font, decode it if needed
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  glyph               Pointer to the glyph header
+*   \param  address             Glyph data address in flash
+*   \return Pointer to the raster cache entry, 0 if the glyph is too big to be cached
+*/
+static glyph_raster_entry_t* sh1122_get_glyph_raster(sh1122_descriptor_t* oled_descriptor, font_glyph_t* glyph, custom_fs_address_t address)
+{
+    glyph_raster_entry_t* entry_pt = &oled_descriptor->glyph_rasters[0];
+    uint16_t line_size = glyph->xrect/2 + 1;
+    bitstream_bitmap_t bs;
+    
+    /* Increment clock */
+    oled_descriptor->glyph_raster_clock++;
+    
+    /* Look for the glyph, otherwise pick the least recently used slot */
+    for (uint16_t i = 0; i < ARRAY_SIZE(oled_descriptor->glyph_rasters); i++)
+    {
+        if (oled_descriptor->glyph_rasters[i].glyph_address == address)
+        {
+            oled_descriptor->glyph_rasters[i].last_use = oled_descriptor->glyph_raster_clock;
+            oled_descriptor->glyph_raster_hits++;
+            return &oled_descriptor->glyph_rasters[i];
+        }
+        if (oled_descriptor->glyph_rasters[i].last_use < entry_pt->last_use)
+        {
+            entry_pt = &oled_descriptor->glyph_rasters[i];
+        }
+    }
+    
+    /* Cache miss: check that the glyph fits */
+    oled_descriptor->glyph_raster_misses++;
+    if (line_size*glyph->yrect > sizeof(entry_pt->raster))
+    {
+        return 0;
+    }
+    
+    /* Decode glyph, the routine may leave the last byte of each line untouched */
+    bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, glyph, address, TRUE);
+    for (uint16_t i = 0; i < glyph->yrect; i++)
+    {
+        entry_pt->raster[i*line_size + line_size - 1] = 0;
+        bitstream_bitmap_array_read(&bs, &entry_pt->raster[i*line_size], glyph->xrect);
+    }
+    bitstream_bitmap_close(&bs);
+    
+    /* Store cache entry */
+    entry_pt->last_use = oled_descriptor->glyph_raster_clock;
+    entry_pt->glyph_address = address;
+    entry_pt->height = glyph->yrect;
+    entry_pt->width = glyph->xrect;
+    return entry_pt;
+}
+
+/*! \fn     sh1122_draw_glyph_raster(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, glyph_raster_entry_t* raster_pt)
+*   \brief  Draw a decoded glyph raster into the frame buffer
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  raster_pt           Pointer to the raster cache entry
+*/
+static void sh1122_draw_glyph_raster(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, glyph_raster_entry_t* raster_pt)
+{
+    uint16_t line_size = raster_pt->width/2 + 1;
+    
+    /* Check for off screen glyph */
+    if (sh1122_is_image_x_on_screen(oled_descriptor, &x, raster_pt->width) == FALSE)
+    {
+        return;
+    }
+    
+    /* Wait for a possible ongoing previous flush */
+    sh1122_check_for_flush_and_terminate(oled_descriptor);
+    
+    /* Lines loop */
+    for (int16_t i = 0; i < raster_pt->height; i++)
+    {
+        /* Check for on screen */
+        if ((y+i >= oled_descriptor->min_disp_y) && (y+i < oled_descriptor->max_disp_y))
+        {
+            sh1122_display_horizontal_pixel_line(oled_descriptor, x, y+i, raster_pt->width, &raster_pt->raster[i*line_size], TRUE);
+        }
+    }
+}
+#endif
+
+/*! \fn     sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_t* bs, BOOL write_to_buffer)
+*   \brief  Draw a picture from a bitstream
+*   \param  oled_descriptor     Pointer to a sh1122 descriptor struct
+*   \param  x                   Starting x
+*   \param  y                   Starting y
+*   \param  bitstream           Pointer to the bitstream
+*   \param  write_to_buffer     Set to true to write to internal buffer
+*/
+void sh1122_draw_image_from_bitstream(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, bitstream_bitmap_t* bitstream, BOOL write_to_buffer)
+{
+    /* Check for off screen image */
+    if (sh1122_is_image_x_on_screen(oled_descriptor, &x, bitstream->width) == FALSE)
     {
         return;
     }
@@ -1792,89 +2152,26 @@ uint16_t sh1122_get_string_width(sh1122_descriptor_t* oled_descriptor, const cus
 */
 uint16_t sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, cust_char_t ch, uint16_t* glyph_height)
 {
-    uint16_t glyph_desc_pt_offset = 0;
-    uint16_t interval_start = 0;
     font_glyph_t glyph;
-    uint16_t gind;
     
     /* Set default value */
     *glyph_height = 0;
     
-    /* Check that a font was actually chosen */
-    if (oled_descriptor->currentFontAddress != 0)
+    /* Get glyph header from cache */
+    if (sh1122_get_glyph(oled_descriptor, ch, &glyph) == FALSE)
     {
-        /* Check that support for this char is described */
-        BOOL char_support_described = FALSE;
-        for (uint16_t i=0; i < sizeof(oled_descriptor->current_unicode_inters)/sizeof(oled_descriptor->current_unicode_inters[0]); i++)
-        {
-            /* Check if char is within this interval */
-            if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
-            {
-                interval_start = oled_descriptor->current_unicode_inters[i].interval_start;
-                char_support_described = TRUE;
-                break;
-            }
-            
-            /* Add offset to descriptor */
-            glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
-        }
-        
-        /* Support not described, check if we could switch with ? */
-        if (char_support_described == FALSE)
-        {
-            if (oled_descriptor->question_mark_support_described != FALSE)
-            {
-                interval_start = oled_descriptor->current_unicode_inters[0].interval_start;
-                glyph_desc_pt_offset = 0;
-                ch = '?';
-            } 
-            else
-            {
-                return 0;
-            }
-        }
-        
-        /* Convert character to glyph index */
-        custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-
-        /* Check that we know this glyph */
-        if(gind == 0xFFFF)
-        {
-            // If we don't know this character, try again with '?'
-            if (oled_descriptor->question_mark_support_described == FALSE)
-            {
-                return 0;
-            }
-            else
-            {
-                ch = '?';
-            }            
-            custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-            
-            // If we still don't know it, return 0
-            if (gind == 0xFFFF)
-            {
-                return 0;
-            }
-        }
-
-        // Read the beginning of the glyph
-        custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
-
-        if (glyph.glyph_data_offset == 0xFFFFFFFF)
-        {
-            // If there's no glyph data, it is the space!
-            return glyph.xrect + 1;
-        }
-        else
-        {
-            *glyph_height = glyph.yrect + glyph.yoffset;
-            return glyph.xrect + glyph.xoffset + 1;
-        }
+        return 0;
+    }
+    
+    if (glyph.glyph_data_offset == 0xFFFFFFFF)
+    {
+        // If there's no glyph data, it is the space!
+        return glyph.xrect + 1;
     }
     else
     {
-        return 0;
+        *glyph_height = glyph.yrect + glyph.yoffset;
+        return glyph.xrect + glyph.xoffset + 1;
     }
 }
 
@@ -1889,76 +2186,15 @@ uint16_t sh1122_get_glyph_width(sh1122_descriptor_t* oled_descriptor, cust_char_
  */
 uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int16_t y, cust_char_t ch, BOOL write_to_buffer)
 {
-    uint16_t glyph_desc_pt_offset = 0;  // Offset to the pointer of the glyph descriptor
-    uint16_t interval_start = 0;        // Unicode code of the first char of the current unicode support interval
     bitstream_bitmap_t bs;              // Character bitstream
     uint8_t glyph_width;                // Glyph width
     font_glyph_t glyph;                 // Glyph header
-    uint16_t gind;                      // Glyph index
 
-    /* Check for selected font */
-    if (oled_descriptor->currentFontAddress == 0)
+    /* Get glyph header from cache */
+    if (sh1122_get_glyph(oled_descriptor, ch, &glyph) == FALSE)
     {
         return 0;
     }
-    
-    /* Check that support for this char is described */
-    BOOL char_support_described = FALSE;
-    for (uint16_t i=0; i < sizeof(oled_descriptor->current_unicode_inters)/sizeof(oled_descriptor->current_unicode_inters[0]); i++)
-    {
-        /* Check if char is within this interval */
-        if ((oled_descriptor->current_unicode_inters[i].interval_start != 0xFFFF) && (oled_descriptor->current_unicode_inters[i].interval_start <= ch) && (oled_descriptor->current_unicode_inters[i].interval_end >= ch))
-        {
-            interval_start = oled_descriptor->current_unicode_inters[i].interval_start;
-            char_support_described = TRUE;
-            break;
-        }
-        
-        /* Add offset to descriptor */
-        glyph_desc_pt_offset += oled_descriptor->current_unicode_inters[i].interval_end - oled_descriptor->current_unicode_inters[i].interval_start + 1;
-    }
-    
-    /* Support not described, check if we could switch with ? */
-    if (char_support_described == FALSE)
-    {
-        if (oled_descriptor->question_mark_support_described != FALSE)
-        {
-            interval_start = oled_descriptor->current_unicode_inters[0].interval_start;
-            glyph_desc_pt_offset = 0;
-            ch = '?';
-        }
-        else
-        {
-            return 0;
-        }
-    }
-    
-    /* Convert character to glyph index */
-    custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-
-    /* Check that we know this glyph */
-    if(gind == 0xFFFF)
-    {
-        // If we don't know this character, try again with '?'
-        if (oled_descriptor->question_mark_support_described == FALSE)
-        {
-            return 0;
-        }
-        else
-        {
-            ch = '?';
-        }
-        custom_fs_read_from_flash((uint8_t*)&gind, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + glyph_desc_pt_offset*sizeof(gind) + (ch - interval_start)*sizeof(gind), sizeof(gind));
-        
-        // If we still don't know it, return 0
-        if (gind == 0xFFFF)
-        {
-            return 0;
-        }
-    }
-    
-    /* Read glyph data */
-    custom_fs_read_from_flash((uint8_t*)&glyph, oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + gind*sizeof(glyph), sizeof(glyph));
 
     if (glyph.glyph_data_offset == 0xFFFFFFFF)
     {
@@ -1974,11 +2210,26 @@ uint16_t sh1122_glyph_draw(sh1122_descriptor_t* oled_descriptor, int16_t x, int1
         y += glyph.yoffset;
         
         /* Compute glyph data address */
-        custom_fs_address_t gaddr = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(gind) + (oled_descriptor->current_font_header.chr_count)*sizeof(glyph) + glyph.glyph_data_offset;
+        custom_fs_address_t gaddr = oled_descriptor->currentFontAddress + sizeof(oled_descriptor->current_font_header) + sizeof(oled_descriptor->current_unicode_inters) + (oled_descriptor->current_font_header.described_chr_count)*sizeof(uint16_t) + (oled_descriptor->current_font_header.chr_count)*sizeof(glyph) + glyph.glyph_data_offset;
         
-        // Initialize bitstream & draw the character
-        bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, &glyph, gaddr, TRUE);
-        sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bs, write_to_buffer);
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        /* Glyphs drawn to the frame buffer are decoded once, then copied from RAM */
+        glyph_raster_entry_t* raster_pt = 0;
+        if (write_to_buffer != FALSE)
+        {
+            raster_pt = sh1122_get_glyph_raster(oled_descriptor, &glyph, gaddr);
+        }
+        if (raster_pt != 0)
+        {
+            sh1122_draw_glyph_raster(oled_descriptor, x, y, raster_pt);
+        }
+        else
+        #endif
+        {
+            // Initialize bitstream & draw the character
+            bitstream_glyph_bitmap_init(&bs, &oled_descriptor->current_font_header, &glyph, gaddr, TRUE);
+            sh1122_draw_image_from_bitstream(oled_descriptor, x, y, &bs, write_to_buffer);
+        }
     }
     
     return (uint8_t)(glyph_width + glyph.xoffset) + 1;
@@ -66,6 +66,14 @@
 /* Transition defines */
 #define SH1122_TRANSITION_PIXEL     0x03
 
+/* Glyph cache defines */
+#define SH1122_GLYPH_CACHE_FIRST_CHAR   0x20
+#define SH1122_GLYPH_CACHE_LAST_CHAR    0xFF
+#define SH1122_GLYPH_CACHE_NB_CHARS     (SH1122_GLYPH_CACHE_LAST_CHAR - SH1122_GLYPH_CACHE_FIRST_CHAR + 1)
+#define SH1122_GLYPH_LRU_SIZE           8
+#define SH1122_GLYPH_RASTER_NB_SLOTS    12
+#define SH1122_GLYPH_RASTER_MAX_SIZE    128
+
 /* Enums */
 typedef enum {OLED_TRANS_NONE, OLED_LEFT_RIGHT_TRANS, OLED_RIGHT_LEFT_TRANS, OLED_TOP_BOT_TRANS, OLED_BOT_TOP_TRANS, OLED_IN_OUT_TRANS, OLED_OUT_IN_TRANS} oled_transition_te;
 typedef enum {OLED_SCROLL_NONE = 0, OLED_SCROLL_UP = 1, OLED_SCROLL_DOWN = 2, OLED_SCROLL_FLIP = 3} oled_scroll_te;
@@ -86,6 +94,23 @@ typedef struct
     uint8_t pixels;
 } gddram_px_t;
 
+typedef struct
+{
+    font_glyph_t glyph;     // Glyph header
+    cust_char_t point;      // Unicode point
+    BOOL printable;         // If the font has a glyph for this point
+    uint8_t age;            // 0 for the most recently used entry
+} glyph_lru_entry_t;
+
+typedef struct
+{
+    custom_fs_address_t glyph_address;                  // Glyph data address in flash, 0 for a free slot
+    uint32_t last_use;                                  // Raster cache clock value at last use
+    uint8_t width;                                      // Glyph width
+    uint8_t height;                                     // Glyph height
+    uint8_t raster[SH1122_GLYPH_RASTER_MAX_SIZE];       // Decoded 4bpp lines, (width/2)+1 bytes each
+} glyph_raster_entry_t;
+
 typedef struct
 {
     Sercom* sercom_pt;
@@ -99,6 +124,10 @@ typedef struct
     font_header_t current_font_header;                  // Current font header
     unicode_interval_desc_t current_unicode_inters[15]; // Current unicode interval descriptors
     BOOL question_mark_support_described;               // If this font describes '?' support
+    font_glyph_t glyph_cache[SH1122_GLYPH_CACHE_NB_CHARS];                  // Glyph headers for the printable ASCII / Latin-1 range, filled on first use
+    uint32_t glyph_cache_valid[(SH1122_GLYPH_CACHE_NB_CHARS+31)/32];        // Bitmask of the glyph headers fetched from the current font
+    uint32_t glyph_cache_printable[(SH1122_GLYPH_CACHE_NB_CHARS+31)/32];    // Bitmask of the fetched glyphs present in the font
+    glyph_lru_entry_t glyph_lru[SH1122_GLYPH_LRU_SIZE];                     // Recently used glyph headers outside of the cached range
     BOOL screen_wrapping_allowed;                       // If we are allowing screen wrapping
     BOOL carriage_return_allowed;                       // If we are allowing \r
     BOOL line_feed_allowed;                             // If we are allowing \n
@@ -119,6 +148,12 @@ typedef struct
     #ifdef OLED_INTERNAL_FRAME_BUFFER
     uint8_t frame_buffer[SH1122_OLED_HEIGHT][SH1122_OLED_WIDTH/(8/SH1122_OLED_BPP)];
     BOOL frame_buffer_flush_in_progress;
+    uint16_t frame_buffer_dirty_ystart;                                 // First frame buffer row modified since last flush
+    uint16_t frame_buffer_dirty_yend;                                   // Last frame buffer row modified since last flush (exclusive)
+    glyph_raster_entry_t glyph_rasters[SH1122_GLYPH_RASTER_NB_SLOTS];   // Decoded rasters of recently drawn glyphs
+    uint32_t glyph_raster_clock;                                        // Raster cache clock, incremented at each lookup
+    uint32_t glyph_raster_hits;                                         // Number of glyphs drawn from the raster cache
+    uint32_t glyph_raster_misses;                                       // Number of glyphs decoded from flash
     #endif
 } sh1122_descriptor_t;
 
@@ -174,6 +209,7 @@ void sh1122_allow_partial_text_x_draw(sh1122_descriptor_t* oled_descriptor);
 void sh1122_clear_current_screen(sh1122_descriptor_t* oled_descriptor);
 void sh1122_reset_lim_display_y(sh1122_descriptor_t* oled_descriptor);
 void sh1122_set_emergency_font(sh1122_descriptor_t* oled_descriptor);
+void sh1122_invalidate_font(sh1122_descriptor_t* oled_descriptor);
 void sh1122_start_data_sending(sh1122_descriptor_t* oled_descriptor);
 BOOL sh1122_is_screen_inverted(sh1122_descriptor_t* oled_descriptor);
 void sh1122_prevent_line_feed(sh1122_descriptor_t* oled_descriptor);
@@ -188,9 +224,11 @@ void sh1122_oled_on(sh1122_descriptor_t* oled_descriptor);
 /* Depending on enabled features */
 #ifdef OLED_INTERNAL_FRAME_BUFFER
 void sh1122_flush_frame_buffer_window(sh1122_descriptor_t* oled_descriptor, uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+void sh1122_mark_frame_buffer_rows_dirty(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend);
 void sh1122_flush_frame_buffer_y_window(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend);
 void sh1122_clear_y_frame_buffer(sh1122_descriptor_t* oled_descriptor, uint16_t ystart, uint16_t yend);
 void sh1122_check_for_flush_and_terminate(sh1122_descriptor_t* oled_descriptor);
+void sh1122_clear_glyph_raster_cache(sh1122_descriptor_t* oled_descriptor);
 void sh1122_flush_frame_buffer(sh1122_descriptor_t* oled_descriptor);
 void sh1122_clear_frame_buffer(sh1122_descriptor_t* oled_descriptor);
 #endif
@@ -31,6 +31,7 @@
 #include "logic_user.h"
 #include "inputs.h"
 #include "main.h"
+#include "dma.h"
 
 #ifdef EMULATOR_BUILD
 #include "emulator.h"
@@ -654,15 +655,19 @@ void SysTick_Handler(void)
     /* Disable systick */
     SysTick->CTRL = 0;
     timer_systick_expired = TRUE;
+    
+    /* Start the next queued transfer to aux MCU */
+    dma_aux_mcu_start_queued_tx_transfer();
 }
 #endif
 
-/*!	\fn		timer_wait_for_aux_tx_flood_protection(void)
-*	\brief	Wait for the MCU systick timeout
+/*!	\fn		timer_has_aux_tx_flood_protection_expired(void)
+*	\brief	Know if the MCU systick timeout expired
+*   \return TRUE or FALSE
 */
-void timer_wait_for_aux_tx_flood_protection(void)
+BOOL timer_has_aux_tx_flood_protection_expired(void)
 {
-    while(timer_systick_expired == FALSE);
+    return timer_systick_expired;
 }
 
 /*!	\fn		timer_arm_mcu_systick_for_aux_tx_flood_protection(void)
@@ -725,6 +730,11 @@ uint32_t timer_get_systick(void)
 */
 timer_flag_te timer_has_timer_expired(timer_id_te uid, BOOL clear)
 {
+    #ifdef EMULATOR_BUILD
+    /* Headless emulator: time goes by when the firmware polls it */
+    emu_virtual_time_poll();
+    #endif
+    
     // Compare & write is done in one cycle
     if (context_timers[uid].flag == TIMER_EXPIRED)
     {
@@ -748,6 +758,10 @@ timer_flag_te timer_has_timer_expired(timer_id_te uid, BOOL clear)
 */
 timer_flag_te timer_has_allocated_timer_expired(uint16_t uid, BOOL clear)
 {
+    #ifdef EMULATOR_BUILD
+    emu_virtual_time_poll();
+    #endif
+    
     // Check for valid uid
     if (uid >= NUMBER_OF_ALLOCATABLE_TIMERS)
     {
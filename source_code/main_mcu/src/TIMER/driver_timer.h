@@ -70,10 +70,10 @@ typedef enum {TIMER_EXPIRED = 0, TIMER_RUNNING = 1} timer_flag_te;
     
 /* Macros */
 #ifdef EMULATOR_BUILD
-#include <unistd.h>
-#define DELAYUS(us)                 usleep(us)
-#define DELAYMS(ms)                 usleep((ms)*1000)
-#define DELAYMS_8M(ms)              usleep((ms)*1000)
+#include "emulator.h"
+#define DELAYUS(us)                 emu_delay_us(us)
+#define DELAYMS(ms)                 emu_delay_us((ms)*1000)
+#define DELAYMS_8M(ms)              emu_delay_us((ms)*1000)
 #else
 #define CYCLES_IN_DLYTICKS_FUNC     8
 #define US_TO_DLYTICKS(us)          (uint32_t)((CPU_SPEED_HF / 1000000UL) * us / CYCLES_IN_DLYTICKS_FUNC)
@@ -109,7 +109,7 @@ void timer_start_timer(timer_id_te uid, uint32_t val);
 uint64_t driver_timer_get_rtc_timestamp_uint64t(void);
 uint32_t driver_timer_get_rtc_timestamp_uint32t(void);
 void timer_arm_inactivity_timer(uint16_t nb_minutes);
-void timer_wait_for_aux_tx_flood_protection(void);
+BOOL timer_has_aux_tx_flood_protection_expired(void);
 uint16_t timer_get_and_start_timer(uint32_t val);
 void timer_deallocate_timer(uint16_t timer_id);
 uint32_t timer_get_timer_val(timer_id_te uid);
@@ -597,6 +597,7 @@ void debug_battery_recondition(void)
                     }
                 }
             }
+            sh1122_mark_frame_buffer_rows_dirty(&plat_oled_descriptor, 0, SH1122_OLED_HEIGHT);
             sh1122_flush_frame_buffer(&plat_oled_descriptor);
         #else
             for (uint16_t i = GUI_ANIMATION_FFRAME_ID; i < GUI_ANIMATION_NBFRAMES; i++)
@@ -1136,6 +1137,12 @@ void debug_debug_screen(void)
             acc_int_nb_interrupts = 0;
         }
          
+        /* Line 1: glyph raster cache */
+        #ifdef OLED_INTERNAL_FRAME_BUFFER
+        uint32_t nb_glyph_draws = plat_oled_descriptor.glyph_raster_hits + plat_oled_descriptor.glyph_raster_misses;
+        sh1122_printf_xy(&plat_oled_descriptor, 0, 0, OLED_ALIGN_LEFT, TRUE, "Glyph cache: %u hits, %u misses (%u%%)", plat_oled_descriptor.glyph_raster_hits, plat_oled_descriptor.glyph_raster_misses, (nb_glyph_draws == 0)? 0 : (uint32_t)(((uint64_t)plat_oled_descriptor.glyph_raster_hits*100)/nb_glyph_draws));
+        #endif
+        
         /* Line 2: date */
         uint32_t timestamp;
         int32_t fine_adjust_val;
@@ -28,6 +28,8 @@
 
 /* Defines */
 #define AUX_MCU_MESSAGE_REPLY_TIMEOUT_MS    1500
+#define AUX_MCU_TX_QUEUE_DEPTH              3
+#define AUX_MCU_RX_QUEUE_DEPTH              2
 
 /* Fonts defines */
 #define FONT_UBUNTU_MONO_BOLD_30_ID 0
@@ -641,9 +641,10 @@ void main_standby_sleep(void)
             /* Set boolean */
             comms_disabled_on_entry = FALSE;
             
-            /* Send a go to sleep message to aux MCU, wait for ack, leave no comms high (automatically set when receiving the sleep received event) */
+            /* Send a go to sleep message to aux MCU, wait for ack, leave no comms high (the DMA interrupt only sets it when our RX ring is full) */
             comms_aux_mcu_send_simple_command_message(MAIN_MCU_COMMAND_SLEEP);
             while(comms_aux_mcu_active_wait(&temp_rx_message, AUX_MCU_MSG_TYPE_AUX_MCU_EVENT, FALSE, AUX_MCU_EVENT_SLEEP_RECEIVED) != RETURN_OK);
+            platform_io_set_no_comms();
             
             /* Wait for end of message we were possibly sending */
             comms_aux_mcu_wait_for_message_sent();
@@ -914,8 +915,8 @@ int main(void)
                 #endif
             }
             
-            /* TX buffer re requested problem */
-            if (comms_aux_mcu_get_and_clear_second_tx_buffer_rerequested() != FALSE)
+            /* TX buffer requested while all of them are reserved problem */
+            if (comms_aux_mcu_get_and_clear_tx_slots_exhausted() != FALSE)
             {
                 gui_prompts_display_information_on_screen_and_wait(CONTACT_SUPPORT_007_TEXT_ID, DISP_MSG_WARNING, FALSE);
                 gui_dispatcher_get_back_to_current_screen();
@@ -1170,7 +1170,6 @@ typedef struct
 
 #if defined(EMULATOR_BUILD)
     #undef FLASH_DMA_FETCHES
-    #undef OLED_DMA_TRANSFER
 #endif
 
 #endif /* PLATFORM_DEFINES_H_ */